@@ -0,0 +1,45 @@
+/**
+ * @file format.h
+ * @brief printf style format engine shared by the kernel and libc.
+ *
+ * The engine is compiled into both the kernel and libc, which only wrap it with their own
+ * entry points and output callbacks. It depends on nothing but strlen and gcvt, which both
+ * of them provide.
+ */
+
+#ifndef _COMMON_FORMAT_H
+#define _COMMON_FORMAT_H
+
+#include <stddef.h>
+#include <stdarg.h>
+
+/**
+ * Callback receiving the chunks of formatted output. Each chunk is NULL terminated.
+ * 
+ * @param chunk The formatted characters.
+ * @param length The number of characters in the chunk.
+ * @param context The context passed to the format engine.
+ */
+typedef void (*__format_flush_t)(const char* chunk, size_t length, void* context);
+
+/**
+ * Format engine behind all formatting functions. The output is collected in the given
+ * buffer and passed to the flush callback in chunks whenever the buffer is full and once
+ * at the end. Without a callback the output is truncated to fit into the buffer instead.
+ * 
+ * Supports the flags '-', '0', '+' and ' ', field width and precision (also as '*'), the
+ * length modifiers hh, h, l, ll and z and the conversions %c, %s, %d, %i, %u, %o, %x, %X,
+ * %b, %p and %f. Hexadecimal and binary numbers are prefixed with 0x/0b, floating point
+ * numbers are printed with two decimal places by default.
+ * 
+ * @param buffer The buffer to format into, at least 2 characters if flushing.
+ * @param size The size of the buffer.
+ * @param flush The callback receiving the chunks or NULL.
+ * @param context The context passed to the callback.
+ * @param format The format string.
+ * @param args The arguments to format.
+ * @return The total number of formatted characters.
+ */
+int __vformat(char* buffer, size_t size, __format_flush_t flush, void* context, const char* format, va_list args);
+
+#endif // _COMMON_FORMAT_H
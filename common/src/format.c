@@ -0,0 +1,373 @@
+#include <format.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Provided by the kernel and libc alike
+size_t strlen(const char* str);
+char *gcvt(double n, int precision, char *buf);
+
+#define FORMAT_FLAG_LEFT  0b00001
+#define FORMAT_FLAG_ZERO  0b00010
+#define FORMAT_FLAG_PLUS  0b00100
+#define FORMAT_FLAG_SPACE 0b01000
+
+#define FORMAT_LENGTH_DEFAULT 0
+#define FORMAT_LENGTH_CHAR    1
+#define FORMAT_LENGTH_SHORT   2
+#define FORMAT_LENGTH_LONG    3
+#define FORMAT_LENGTH_LLONG   4
+#define FORMAT_LENGTH_SIZE    5
+
+/*
+ * Output state of the format engine. Characters are collected in the caller's
+ * buffer, which is handed to the flush callback whenever it is full. Without a
+ * callback the output is truncated, but the total length is still counted.
+ */
+typedef struct format_output {
+    char* buffer;
+    size_t size;
+    size_t position;
+    __format_flush_t flush;
+    void* context;
+    size_t total;
+} format_output_t;
+
+static inline void format_putchar(format_output_t* output, char ch) {
+    if(output->position + 1 >= output->size) {
+        if(!output->flush) {
+            output->total++;
+            return;
+        }
+
+        output->buffer[output->position] = '\0';
+        output->flush(output->buffer, output->position, output->context);
+        output->position = 0;
+    }
+
+    output->buffer[output->position++] = ch;
+    output->total++;
+}
+
+static void format_write(format_output_t* output, const char* str, size_t length) {
+    for(size_t index = 0; index < length; index++) {
+        format_putchar(output, str[index]);
+    }
+}
+
+static void format_pad(format_output_t* output, char ch, size_t count) {
+    for(size_t index = 0; index < count; index++) {
+        format_putchar(output, ch);
+    }
+}
+
+/*
+ * Divides a 64-bit value in place and returns the remainder. Uses two 32-bit
+ * divisions, so no 64-bit division helpers of the compiler runtime are needed.
+ */
+static uint32_t format_divmod(uint64_t* value, uint32_t base) {
+    uint32_t high = (uint32_t) (*value >> 32);
+    uint32_t low = (uint32_t) *value;
+
+    if(high == 0) {
+        *value = low / base;
+        return low % base;
+    }
+
+    uint32_t quotient_high = high / base;
+    uint32_t remainder = high % base;
+    uint32_t quotient_low;
+
+    __asm__("divl %4" : "=a" (quotient_low), "=d" (remainder) : "a" (low), "d" (remainder), "rm" (base));
+
+    *value = ((uint64_t) quotient_high << 32) | quotient_low;
+
+    return remainder;
+}
+
+static void format_field(format_output_t* output, const char* str, size_t length, int flags, int width) {
+    size_t padding = width > 0 && (size_t) width > length ? (size_t) width - length : 0;
+
+    if(!(flags & FORMAT_FLAG_LEFT)) {
+        format_pad(output, ' ', padding);
+    }
+
+    format_write(output, str, length);
+
+    if(flags & FORMAT_FLAG_LEFT) {
+        format_pad(output, ' ', padding);
+    }
+}
+
+static void format_number(format_output_t* output, uint64_t value, bool negative, uint32_t base, bool uppercase,
+        const char* prefix, int flags, int width, int precision) {
+    const char* chars = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    char digits[64];
+    size_t count = 0;
+
+    while(value != 0) {
+        digits[count++] = chars[format_divmod(&value, base)];
+    }
+
+    // An explicit precision of zero prints nothing for the value zero
+    if(count == 0 && precision != 0) {
+        digits[count++] = '0';
+    }
+
+    char sign = negative ? '-' : (flags & FORMAT_FLAG_PLUS) ? '+' : (flags & FORMAT_FLAG_SPACE) ? ' ' : '\0';
+    size_t prefix_length = strlen(prefix);
+    size_t zeros = precision > 0 && (size_t) precision > count ? (size_t) precision - count : 0;
+    size_t length = (sign ? 1 : 0) + prefix_length + zeros + count;
+    size_t padding = width > 0 && (size_t) width > length ? (size_t) width - length : 0;
+
+    // The zero flag is ignored if a precision is given
+    bool zero_padding = (flags & FORMAT_FLAG_ZERO) && !(flags & FORMAT_FLAG_LEFT) && precision < 0;
+
+    if(!(flags & FORMAT_FLAG_LEFT) && !zero_padding) {
+        format_pad(output, ' ', padding);
+    }
+
+    if(sign) {
+        format_putchar(output, sign);
+    }
+
+    format_write(output, prefix, prefix_length);
+
+    if(zero_padding) {
+        format_pad(output, '0', padding);
+    }
+
+    format_pad(output, '0', zeros);
+
+    while(count > 0) {
+        format_putchar(output, digits[--count]);
+    }
+
+    if(flags & FORMAT_FLAG_LEFT) {
+        format_pad(output, ' ', padding);
+    }
+}
+
+int __vformat(char* buffer, size_t size, __format_flush_t flush, void* context, const char* format, va_list args) {
+    format_output_t output = { buffer, size, 0, flush, context, 0 };
+
+    while(*format != '\0') {
+        if(*format != '%') {
+            // Copy the literal text up to the next conversion at once
+            const char* literal = format;
+
+            while(*format != '\0' && *format != '%') {
+                format++;
+            }
+
+            format_write(&output, literal, format - literal);
+            continue;
+        }
+
+        format++;
+
+        // Flags
+
+        int flags = 0;
+
+        for(;; format++) {
+            if(*format == '-') {
+                flags |= FORMAT_FLAG_LEFT;
+            } else if(*format == '0') {
+                flags |= FORMAT_FLAG_ZERO;
+            } else if(*format == '+') {
+                flags |= FORMAT_FLAG_PLUS;
+            } else if(*format == ' ') {
+                flags |= FORMAT_FLAG_SPACE;
+            } else if(*format != '#') {
+                break;
+            }
+        }
+
+        // Field width
+
+        int width = 0;
+
+        if(*format == '*') {
+            width = va_arg(args, int);
+            format++;
+
+            if(width < 0) {
+                flags |= FORMAT_FLAG_LEFT;
+                width = -width;
+            }
+        } else {
+            while(*format >= '0' && *format <= '9') {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        // Precision, negative if omitted
+
+        int precision = -1;
+
+        if(*format == '.') {
+            format++;
+            precision = 0;
+
+            if(*format == '*') {
+                precision = va_arg(args, int);
+                format++;
+            } else {
+                while(*format >= '0' && *format <= '9') {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        // Length modifier
+
+        int length = FORMAT_LENGTH_DEFAULT;
+
+        if(*format == 'h') {
+            length = FORMAT_LENGTH_SHORT;
+
+            if(*++format == 'h') {
+                length = FORMAT_LENGTH_CHAR;
+                format++;
+            }
+        } else if(*format == 'l') {
+            length = FORMAT_LENGTH_LONG;
+
+            if(*++format == 'l') {
+                length = FORMAT_LENGTH_LLONG;
+                format++;
+            }
+        } else if(*format == 'z') {
+            length = FORMAT_LENGTH_SIZE;
+            format++;
+        }
+
+        // Conversion
+
+        switch(*format) {
+            case '%': {
+                format_putchar(&output, '%');
+                break;
+            }
+            case 'c': {
+                char ch = (char) va_arg(args, int);
+                format_field(&output, &ch, 1, flags, width);
+                break;
+            }
+            case 's': {
+                const char* str = va_arg(args, const char*);
+
+                if(str == NULL) {
+                    str = "(null)";
+                }
+
+                size_t str_length = 0;
+
+                while(str[str_length] != '\0' && (precision < 0 || str_length < (size_t) precision)) {
+                    str_length++;
+                }
+
+                format_field(&output, str, str_length, flags, width);
+                break;
+            }
+            case 'd':
+            case 'i': {
+                int64_t value;
+
+                switch(length) {
+                    case FORMAT_LENGTH_CHAR: value = (signed char) va_arg(args, int); break;
+                    case FORMAT_LENGTH_SHORT: value = (short) va_arg(args, int); break;
+                    case FORMAT_LENGTH_LONG: value = va_arg(args, long); break;
+                    case FORMAT_LENGTH_LLONG: value = va_arg(args, long long); break;
+                    case FORMAT_LENGTH_SIZE: value = (int32_t) va_arg(args, size_t); break;
+                    default: value = va_arg(args, int); break;
+                }
+
+                bool negative = value < 0;
+                uint64_t magnitude = negative ? -(uint64_t) value : (uint64_t) value;
+
+                format_number(&output, magnitude, negative, 10, false, "", flags, width, precision);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'b': {
+                uint64_t value;
+
+                switch(length) {
+                    case FORMAT_LENGTH_CHAR: value = (unsigned char) va_arg(args, unsigned int); break;
+                    case FORMAT_LENGTH_SHORT: value = (unsigned short) va_arg(args, unsigned int); break;
+                    case FORMAT_LENGTH_LONG: value = va_arg(args, unsigned long); break;
+                    case FORMAT_LENGTH_LLONG: value = va_arg(args, unsigned long long); break;
+                    case FORMAT_LENGTH_SIZE: value = va_arg(args, size_t); break;
+                    default: value = va_arg(args, unsigned int); break;
+                }
+
+                // Hexadecimal and binary numbers are always prefixed
+                if(*format == 'u') {
+                    format_number(&output, value, false, 10, false, "", flags, width, precision);
+                } else if(*format == 'o') {
+                    format_number(&output, value, false, 8, false, "", flags, width, precision);
+                } else if(*format == 'b') {
+                    format_number(&output, value, false, 2, false, "0b", flags, width, precision);
+                } else {
+                    format_number(&output, value, false, 16, *format == 'X', *format == 'X' ? "0X" : "0x", flags, width, precision);
+                }
+
+                break;
+            }
+            case 'p': {
+                uintptr_t value = (uintptr_t) va_arg(args, void*);
+                format_number(&output, value, false, 16, false, "", flags, width, precision);
+                break;
+            }
+            case 'f': {
+                double value = va_arg(args, double);
+                char num_str[48];
+                char* str = num_str;
+
+                // Prints two decimal places by default
+                if(precision < 0) {
+                    precision = 2;
+                } else if(precision > 16) {
+                    precision = 16;
+                }
+
+                if(value < 0) {
+                    *str++ = '-';
+                    value = -value;
+                } else if(flags & FORMAT_FLAG_PLUS) {
+                    *str++ = '+';
+                }
+
+                gcvt(value, precision, str);
+
+                format_field(&output, num_str, strlen(num_str), flags, width);
+                break;
+            }
+            default: {
+                // Unknown conversions are dropped, a trailing % ends the format
+                if(*format == '\0') {
+                    format--;
+                }
+
+                break;
+            }
+        }
+
+        format++;
+    }
+
+    if(output.flush) {
+        if(output.position > 0) {
+            output.buffer[output.position] = '\0';
+            output.flush(output.buffer, output.position, output.context);
+        }
+    } else if(output.size > 0) {
+        output.buffer[output.position] = '\0';
+    }
+
+    return output.total;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file cpu.h
+ * @brief CPU identification and feature detection.
+ *
+ * The CPU is identified once at boot using the CPUID instruction. The detected features are
+ * normalized into a single feature mask, so that other subsystems can select optimized code
+ * paths for the running processor without executing CPUID themselves.
+ */
+
+#ifndef _KERNEL_ARCH_I386_CPU_H
+#define _KERNEL_ARCH_I386_CPU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define CPU_EFLAGS_ID (1 << 21)
+
+// CPUID leaf 0x01, register EDX
+
+#define CPU_CPUID_EDX_FPU (1 << 0)
+#define CPU_CPUID_EDX_PSE (1 << 3)
+#define CPU_CPUID_EDX_TSC (1 << 4)
+#define CPU_CPUID_EDX_PAE (1 << 6)
+#define CPU_CPUID_EDX_APIC (1 << 9)
+#define CPU_CPUID_EDX_SEP (1 << 11)
+#define CPU_CPUID_EDX_PGE (1 << 13)
+#define CPU_CPUID_EDX_CMOV (1 << 15)
+#define CPU_CPUID_EDX_MMX (1 << 23)
+#define CPU_CPUID_EDX_FXSR (1 << 24)
+#define CPU_CPUID_EDX_SSE (1 << 25)
+#define CPU_CPUID_EDX_SSE2 (1 << 26)
+
+// CPUID leaf 0x01, register ECX
+
+#define CPU_CPUID_ECX_SSE3 (1 << 0)
+
+// CPUID leaf 0x07, register EBX
+
+#define CPU_CPUID_EXT_EBX_ERMS (1 << 9)
+
+// Normalized feature mask
+
+#define CPU_FEATURE_FPU (1 << 0)
+#define CPU_FEATURE_PSE (1 << 1)
+#define CPU_FEATURE_TSC (1 << 2)
+#define CPU_FEATURE_PAE (1 << 3)
+#define CPU_FEATURE_APIC (1 << 4)
+#define CPU_FEATURE_SEP (1 << 5)
+#define CPU_FEATURE_PGE (1 << 6)
+#define CPU_FEATURE_CMOV (1 << 7)
+#define CPU_FEATURE_MMX (1 << 8)
+#define CPU_FEATURE_FXSR (1 << 9)
+#define CPU_FEATURE_SSE (1 << 10)
+#define CPU_FEATURE_SSE2 (1 << 11)
+#define CPU_FEATURE_SSE3 (1 << 12)
+#define CPU_FEATURE_ERMS (1 << 13)
+
+typedef struct cpu_info cpu_info_t;
+
+struct cpu_info {
+    char vendor[13];
+    char brand[49];
+    uint32_t family;
+    uint32_t model;
+    uint32_t stepping;
+    uint32_t features;
+};
+
+/**
+ * Identifies the CPU and detects its features. Must be called once at boot
+ * before any code path is selected based on the CPU features.
+ */
+void cpu_init(void);
+
+/**
+ * Gets the identification of the running CPU.
+ *
+ * @return The CPU information.
+ */
+const cpu_info_t* cpu_get_info(void);
+
+/**
+ * Checks if the running CPU supports all of the given features.
+ *
+ * @param features The features to check (CPU_FEATURE_* mask).
+ * @return True if all features are supported, false otherwise.
+ */
+bool cpu_has_feature(uint32_t features);
+
+#endif // _KERNEL_ARCH_I386_CPU_H
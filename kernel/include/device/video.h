@@ -10,8 +10,16 @@
 #define _KERNEL_DEVICE_VIDEO_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
+/*
+ * Text mode cell as expected by tm.blit: the character in the low byte and the
+ * attribute (foreground color in the low, background color in the high nibble)
+ * in the high byte.
+ */
+#define VIDEO_TM_CELL(ch, fgcolor, bgcolor) ((uint16_t) ((uint8_t) (ch) | ((((bgcolor) & 0x0F) << 4 | ((fgcolor) & 0x0F)) << 8)))
+
 typedef struct video_driver video_driver_t;
 
 struct video_driver {
@@ -25,6 +33,7 @@ struct video_driver {
             int32_t (*fill)(uint32_t color);
             int32_t (*write)(uint32_t cell, uint8_t ch, uint8_t fgcolor, uint8_t bgcolor);
             int32_t (*strwrite)(uint32_t offset, const char* str, uint8_t fgcolor, uint8_t bgcolor);
+            int32_t (*blit)(uint32_t cell, const uint16_t* cells, size_t count);
             int32_t (*scroll)(uint8_t fgcolor, uint8_t bgcolor);
             int32_t (*move_cursor)(uint32_t cell);
             int32_t (*enable_cursor)(uint8_t start, uint8_t end);
@@ -39,6 +48,11 @@ struct video_driver {
             int32_t (*draw_rect)(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t color);
             int32_t (*draw_char)(uint32_t x, uint32_t y, char c, uint32_t color);
             int32_t (*draw_string)(uint32_t x, uint32_t y, const char* str, uint32_t color);
+
+            // Optional operations, NULL if not supported by the driver
+            int32_t (*blit)(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint32_t* pixels);
+            int32_t (*copy_rect)(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width, uint32_t height);
+            int32_t (*flush)();
         } gfx;
     };
 };
@@ -6,6 +6,14 @@
  * volume interface for all volumes and enables easy access to volumes by defining volume operations
  * for different kind of volumes. Moreover, the volume manager is responsible for scanning storage
  * devices for volumes and registering them.
+ *
+ * Reads and writes of all volumes go through a block cache. Volumes are split into cache blocks of
+ * VOLUME_CACHE_BLOCK_SIZE bytes, which are looked up by volume and block number in a hash table and
+ * evicted in least recently used order once the memory budget of the cache is exhausted. Writes only
+ * update the cached blocks and mark them dirty. Dirty blocks are written back when they are evicted,
+ * when too many of them have accumulated or when the volume is synced, with adjacent dirty blocks
+ * written in a single transfer. Prefetching loads blocks into the cache ahead of time without copying
+ * them anywhere.
  */
 
 #ifndef _KERNEL_DEVICE_VOLUME_H
@@ -18,6 +26,16 @@
 #include <util/uuid.h>
 #include <util/shortid.h>
 
+#define VOLUME_CACHE_BLOCK_SIZE 4096
+#define VOLUME_CACHE_BUCKETS 1024
+#define VOLUME_CACHE_DEFAULT_BUDGET (2 * 1024 * 1024)
+
+// Maximum number of missing blocks fetched from or dirty blocks written to the device at once
+#define VOLUME_CACHE_MAX_RUN 32
+
+// Dirty blocks are written back once they exceed this fraction of the budget
+#define VOLUME_CACHE_DIRTY_RATIO 4
+
 typedef struct volume volume_t;
 typedef struct volume_operations volume_operations_t;
 
@@ -25,6 +43,18 @@ struct volume_operations {
     size_t (*total_size)(volume_t* volume);
     size_t (*read)(volume_t* volume, size_t offset, size_t size, char* buffer);
     size_t (*write)(volume_t* volume, size_t offset, size_t size, char* buffer);
+    size_t (*prefetch)(volume_t* volume, size_t offset, size_t size);
+    int32_t (*sync)(volume_t* volume);
+};
+
+typedef struct volume_cache_stats volume_cache_stats_t;
+
+struct volume_cache_stats {
+    size_t hits;
+    size_t misses;
+    size_t blocks;
+    size_t dirty;
+    size_t budget;
 };
 
 struct volume {
@@ -79,4 +109,19 @@ const volume_t* volume_find_by_id(const char* id);
  */
 const volume_t* volume_find_by_name(const char* name);
 
+/**
+ * Sets the memory budget of the block cache. Blocks are evicted immediately if the
+ * cache exceeds the new budget. A budget of 0 disables the cache.
+ * 
+ * @param budget The budget in bytes.
+ */
+void volume_cache_set_budget(size_t budget);
+
+/**
+ * Gets the statistics of the block cache.
+ * 
+ * @param stats The statistics.
+ */
+void volume_cache_get_stats(volume_cache_stats_t* stats);
+
 #endif // _KERNEL_DEVICE_VOLUME_H
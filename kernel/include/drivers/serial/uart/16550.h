@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include <util/spsc_ring.h>
 
 #define UART_16550_COM1 0x3F8
 #define UART_16550_COM2 0x2F8
@@ -31,6 +33,43 @@
 #define UART_16550_MSR(port) (port + 0x06) // Modem Status Register
 #define UART_16550_SCR(port) (port + 0x07) // Scratch Register
 
+#define UART_16550_IER_RECEIVED_DATA 0x01 // Received data available interrupt
+#define UART_16550_IER_TRANSMITTER_EMPTY 0x02 // Transmitter holding register empty interrupt
+
+#define UART_16550_IIR_NO_INTERRUPT 0x01
+#define UART_16550_IIR_ID_MASK 0x0E
+#define UART_16550_IIR_MODEM_STATUS 0x00
+#define UART_16550_IIR_TRANSMITTER_EMPTY 0x02
+#define UART_16550_IIR_RECEIVED_DATA 0x04
+#define UART_16550_IIR_LINE_STATUS 0x06
+#define UART_16550_IIR_CHARACTER_TIMEOUT 0x0C
+
+#define UART_16550_LSR_DATA_READY 0x01
+#define UART_16550_LSR_TRANSMITTER_EMPTY 0x20
+#define UART_16550_LSR_TRANSMITTER_IDLE 0x40
+
+#define UART_16550_FIFO_SIZE 16
+#define UART_16550_BUFFER_SIZE 4096
+#define UART_16550_MAX_PORTS 4
+
+typedef struct uart_16550_port uart_16550_port_t;
+
+/*
+ * Software state of an initialized port. Written bytes are queued in the transmit
+ * ring and moved into the hardware FIFO, one FIFO load at a time, by the transmitter
+ * empty interrupt. Received bytes are moved from the hardware FIFO into the receive
+ * ring by the received data and character timeout interrupts. Writers only produce
+ * into the transmit ring and readers only consume from the receive ring, so both
+ * work without disabling interrupts.
+ */
+struct uart_16550_port {
+    uint16_t port;
+    spsc_ring_t* transmit;
+    spsc_ring_t* receive;
+    bool transmitting;
+    uint8_t interrupts;
+};
+
 /**
  * Initializes a 16550 UART serial port.
  * 
@@ -41,7 +80,8 @@
 int32_t uart_16550_init(uint16_t port, uint32_t baud_rate);
 
 /**
- * Writes data to a 16550 UART serial port.
+ * Writes data to a 16550 UART serial port. The data is queued and transmitted
+ * in the background, the call only waits for the transmitter if the queue is full.
  * 
  * @param port The I/O port of the UART serial port.
  * @param data A pointer to the data to write.
@@ -50,12 +90,20 @@ int32_t uart_16550_init(uint16_t port, uint32_t baud_rate);
 void uart_16550_write(uint16_t port, const void* data, size_t size);
 
 /**
- * Reads data from a 16550 UART serial port.
+ * Reads the data received by a 16550 UART serial port so far. Does not block.
  * 
  * @param port The I/O port of the UART serial port.
  * @param buffer A pointer to the buffer to read into.
- * @param size The number of bytes to read.
+ * @param size The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t uart_16550_read(uint16_t port, void* buffer, size_t size);
+
+/**
+ * Waits until all queued data of a 16550 UART serial port has been transmitted.
+ * 
+ * @param port The I/O port of the UART serial port.
  */
-void uart_16550_read(uint16_t port, void* buffer, size_t size);
+void uart_16550_flush(uint16_t port);
 
 #endif // _KERNEL_DRIVERS_SERIAL_UART_16550_H
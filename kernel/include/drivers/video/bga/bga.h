@@ -0,0 +1,180 @@
+/**
+ * @file bga.h
+ * @brief Driver for the Bochs Graphics Adapter (Bochs VBE extensions).
+ *
+ * The adapter is provided by Bochs and QEMU (-vga std). It exposes a linear framebuffer
+ * through PCI BAR 0 and is configured through the VBE DISPI registers. The driver only
+ * supports 32 bits per pixel. All drawing operations render into a back buffer in
+ * system memory, the changed regions are copied to the framebuffer on flush.
+ */
+
+#ifndef _KERNEL_DRIVERS_VIDEO_BGA_BGA_H
+#define _KERNEL_DRIVERS_VIDEO_BGA_BGA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <system/ports.h>
+
+#define BGA_PCI_VENDOR_ID 0x1234
+#define BGA_PCI_DEVICE_ID 0x1111
+
+#define BGA_DISPI_INDEX_PORT 0x01CE
+#define BGA_DISPI_DATA_PORT 0x01CF
+
+#define BGA_DISPI_INDEX_ID 0x00
+#define BGA_DISPI_INDEX_XRES 0x01
+#define BGA_DISPI_INDEX_YRES 0x02
+#define BGA_DISPI_INDEX_BPP 0x03
+#define BGA_DISPI_INDEX_ENABLE 0x04
+#define BGA_DISPI_INDEX_BANK 0x05
+#define BGA_DISPI_INDEX_VIRT_WIDTH 0x06
+#define BGA_DISPI_INDEX_VIRT_HEIGHT 0x07
+#define BGA_DISPI_INDEX_X_OFFSET 0x08
+#define BGA_DISPI_INDEX_Y_OFFSET 0x09
+
+// 32 bits per pixel are supported since version 0xB0C2
+#define BGA_DISPI_ID_MIN 0xB0C2
+#define BGA_DISPI_ID_MAX 0xB0CF
+
+#define BGA_DISPI_DISABLED 0x00
+#define BGA_DISPI_ENABLED 0x01
+#define BGA_DISPI_LFB_ENABLED 0x40
+#define BGA_DISPI_NOCLEAR 0x80
+
+#define BGA_BPP 32
+
+#define BGA_MAX_DIRTY_RECTS 16
+
+// Colors are 0x00RRGGBB
+#define BGA_COLOR(red, green, blue) ((uint32_t) (((red) & 0xFF) << 16 | ((green) & 0xFF) << 8 | ((blue) & 0xFF)))
+
+typedef struct bga_rect bga_rect_t;
+
+struct bga_rect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * Initializes the Bochs Graphics Adapter, switches it to the given resolution and
+ * registers it as video device. Requires the PCI bus to be scanned before.
+ *
+ * @param width The horizontal resolution.
+ * @param height The vertical resolution.
+ * @return 0 if successful, -1 if the adapter is not present or the mode is not supported.
+ */
+int32_t bga_init(uint32_t width, uint32_t height);
+
+/**
+ * Marks a region of the back buffer as changed, so that it is copied to the
+ * framebuffer on the next flush. Overlapping regions are merged.
+ *
+ * @param x The x-coordinate of the region.
+ * @param y The y-coordinate of the region.
+ * @param width The width of the region.
+ * @param height The height of the region.
+ */
+void bga_mark_dirty(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+/**
+ * Copies the changed regions of the back buffer to the framebuffer.
+ *
+ * @return 0 if successful.
+ */
+int32_t bga_gfx_flush();
+
+/**
+ * Set a pixel in the back buffer.
+ *
+ * @param x The x-coordinate of the pixel.
+ * @param y The y-coordinate of the pixel.
+ * @param color The color of the pixel.
+ * @return 0 if successful, -1 if the pixel is out of bounds.
+ */
+int32_t bga_gfx_set_pixel(uint32_t x, uint32_t y, uint32_t color);
+
+/**
+ * Fill the back buffer with a color.
+ *
+ * @param color The color.
+ * @return 0 if successful.
+ */
+int32_t bga_gfx_fill(uint32_t color);
+
+/**
+ * Draw a filled rectangle in the back buffer.
+ *
+ * @param x The x-coordinate of the top-left corner of the rectangle.
+ * @param y The y-coordinate of the top-left corner of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param color The color of the rectangle.
+ * @return 0 if successful, -1 if the rectangle is out of bounds.
+ */
+int32_t bga_gfx_draw_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t color);
+
+/**
+ * Copy a rectangle of pixels into the back buffer.
+ *
+ * @param x The x-coordinate of the top-left corner of the destination.
+ * @param y The y-coordinate of the top-left corner of the destination.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param pixels The pixels, row by row without padding.
+ * @return 0 if successful, -1 if the rectangle is out of bounds.
+ */
+int32_t bga_gfx_blit(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint32_t* pixels);
+
+/**
+ * Move a rectangle within the back buffer. Source and destination may overlap.
+ *
+ * @param src_x The x-coordinate of the top-left corner of the source.
+ * @param src_y The y-coordinate of the top-left corner of the source.
+ * @param dst_x The x-coordinate of the top-left corner of the destination.
+ * @param dst_y The y-coordinate of the top-left corner of the destination.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @return 0 if successful, -1 if a rectangle is out of bounds.
+ */
+int32_t bga_gfx_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width, uint32_t height);
+
+/**
+ * Draw a character in the back buffer.
+ *
+ * @param x The x-coordinate of the character.
+ * @param y The y-coordinate of the character.
+ * @param c The character to draw.
+ * @param color The color of the character.
+ * @return 0 if successful, -1 if not supported.
+ */
+int32_t bga_gfx_draw_char(uint32_t x, uint32_t y, char c, uint32_t color);
+
+/**
+ * Draw a string in the back buffer.
+ *
+ * @param x The x-coordinate of the string.
+ * @param y The y-coordinate of the string.
+ * @param str The string to draw.
+ * @param color The color of the string.
+ * @return 0 if successful, -1 if not supported.
+ */
+int32_t bga_gfx_draw_string(uint32_t x, uint32_t y, const char* str, uint32_t color);
+
+/**
+ * Get the horizontal resolution.
+ *
+ * @return The width in pixels.
+ */
+size_t bga_gfx_total_width();
+
+/**
+ * Get the vertical resolution.
+ *
+ * @return The height in pixels.
+ */
+size_t bga_gfx_total_height();
+
+#endif // _KERNEL_DRIVERS_VIDEO_BGA_BGA_H
@@ -64,6 +64,43 @@ int32_t vga_gfx_set_pixel(uint32_t x, uint32_t y, uint32_t color);
  */
 int32_t vga_gfx_draw_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t color);
 
+/**
+ * Fill a horizontal span of pixels in the VGA graphics mode buffer. In planar
+ * mode, whole bytes (8 pixels) are written at once in write mode 2, only the
+ * partial bytes at the edges are masked through the bit mask register.
+ * 
+ * @param x The x-coordinate of the first pixel.
+ * @param y The y-coordinate of the span.
+ * @param width The number of pixels.
+ * @param color The color of the span.
+ * @return 0 if successful, -1 if the span is out of bounds.
+ */
+int32_t vga_gfx_fill_span(uint32_t x, uint32_t y, uint32_t width, uint32_t color);
+
+/**
+ * Move a rectangle within the VGA graphics mode buffer. Source and destination
+ * may overlap. In planar mode, byte aligned rectangles are copied through the
+ * latches in write mode 1, copying 8 pixels of all planes per byte.
+ * 
+ * @param src_x The x-coordinate of the top-left corner of the source.
+ * @param src_y The y-coordinate of the top-left corner of the source.
+ * @param dst_x The x-coordinate of the top-left corner of the destination.
+ * @param dst_y The y-coordinate of the top-left corner of the destination.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @return 0 if successful, -1 if a rectangle is out of bounds.
+ */
+int32_t vga_gfx_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width, uint32_t height);
+
+/**
+ * Get the color of a pixel in the VGA graphics mode buffer.
+ * 
+ * @param x The x-coordinate of the pixel.
+ * @param y The y-coordinate of the pixel.
+ * @return The color of the pixel.
+ */
+uint32_t vga_gfx_get_pixel(uint32_t x, uint32_t y);
+
 /**
  * Draw a character in the VGA graphics mode buffer.
  * 
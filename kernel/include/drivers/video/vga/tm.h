@@ -23,6 +23,14 @@
 #define VGA_TM_LIGHT_BROWN		0x0E
 #define VGA_TM_WHITE			0x0F
 
+// The text mode buffer is a 32 KiB window (0xB8000 - 0xBFFFF) of which only one screen is displayed
+#define VGA_TM_VIDEO_MEMORY_CELLS (0x8000 / sizeof(uint16_t))
+
+// The character generator is stored in plane 2 with 32 bytes reserved per glyph
+#define VGA_TM_FONT_GLYPHS 256
+#define VGA_TM_FONT_HEIGHT 16
+#define VGA_TM_FONT_STRIDE 32
+
 #define VGA_TM_CURSOR_MIN_SCANLINE 0x00
 #define VGA_TM_CURSOR_MAX_SCANLINE 0x0F
 
@@ -84,13 +92,36 @@ int32_t vga_tm_write(size_t cell, uint8_t ch, uint8_t fgcolor, uint8_t bgcolor);
 int32_t vga_tm_strwrite(size_t offset, const char* str, uint8_t fgcolor, uint8_t bgcolor);
 
 /**
- * Scroll the VGA text mode buffer up by one line.
+ * Copy a span of prepared cells (see VIDEO_TM_CELL) to the VGA text mode buffer.
+ * 
+ * @param cell The cell index of the first cell to write.
+ * @param cells The cells to write.
+ * @param count The number of cells to write.
+ * @return 0 if successful, -1 if the span is out of bounds.
+ */
+int32_t vga_tm_blit(size_t cell, const uint16_t* cells, size_t count);
+
+/**
+ * Scroll the VGA text mode buffer up by one line. Instead of copying the screen,
+ * the displayed part of the text mode buffer is moved forward by one row as long
+ * as the buffer has room for it. Only then the screen is copied back to the
+ * start of the buffer.
  * 
  * @param fgcolor The foreground color.
  * @param bgcolor The background color.
  */
 void vga_tm_scroll(uint8_t fgcolor, uint8_t bgcolor);
 
+/**
+ * Read the 8x16 font of the character generator, as loaded by the BIOS, from
+ * plane 2. Each glyph is stored as VGA_TM_FONT_HEIGHT bytes, one per row, with
+ * the most significant bit being the leftmost pixel.
+ * 
+ * @param buffer The buffer to read into, VGA_TM_FONT_GLYPHS * VGA_TM_FONT_HEIGHT bytes.
+ * @return 0 if successful, -1 if not in text mode.
+ */
+int32_t vga_tm_read_font(uint8_t* buffer);
+
 /**
  * Get the total number of rows in the VGA text mode buffer.
  * 
@@ -174,4 +174,20 @@ int32_t vga_set_plane_mask(uint8_t mask);
  */
 int32_t vga_set_bit_mask(uint8_t mask);
 
+/**
+ * Sets the set/reset color of the VGA controller, used by write mode 3.
+ * 
+ * @param color The color to set.
+ * @return 0 if the color was set successfully, -1 otherwise.
+ */
+int32_t vga_set_set_reset(uint8_t color);
+
+/**
+ * Selects the plane that is read by the CPU in read mode 0.
+ * 
+ * @param plane The plane to read.
+ * @return 0 if the plane was selected successfully, -1 otherwise.
+ */
+int32_t vga_set_read_plane(uint8_t plane);
+
 #endif // _KERNEL_DRIVERS_VIDEO_VGA_VGA_H
@@ -29,6 +29,87 @@
 #define EXT2_S_IFDIR 0x4000     // Directory
 #define EXT2_S_IFLNK 0xA000     // Symbolic link
 
+/**
+ * Inode number of the first non-reserved inode on revision 0 file systems.
+ */
+#define EXT2_GOOD_OLD_FIRST_INO 11
+
+/**
+ * Feature flags this driver can write to. File systems with any other incompatible or
+ * read-only compatible feature are mounted read-only.
+ */
+#define EXT2_FEATURE_INCOMPAT_FILETYPE      0x0002  // Directory entries record the file type
+#define EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER 0x0001  // Superblock backups in some groups only
+#define EXT2_FEATURE_RO_COMPAT_LARGE_FILE   0x0002  // Files may exceed 2 GiB
+
+/**
+ * Compatible feature flag of hashed directory indexes (htree). Indexed directories are
+ * marked with EXT2_INDEX_FL in i_flags.
+ */
+#define EXT2_FEATURE_COMPAT_DIR_INDEX       0x0020
+
+/**
+ * Inode flags relevant to this driver.
+ */
+#define EXT2_INDEX_FL 0x00001000        // Directory has a hashed index
+
+/**
+ * Superblock flags telling whether directory hashes treat names as signed or unsigned chars.
+ */
+#define EXT2_FLAGS_SIGNED_HASH   0x0001
+#define EXT2_FLAGS_UNSIGNED_HASH 0x0002
+
+/**
+ * Directory hash versions (ext2_dx_root_info_t::hash_version). The unsigned variants are not
+ * stored on disk but derived from EXT2_FLAGS_UNSIGNED_HASH.
+ */
+#define EXT2_HASH_LEGACY            0
+#define EXT2_HASH_HALF_MD4          1
+#define EXT2_HASH_TEA               2
+#define EXT2_HASH_LEGACY_UNSIGNED   3
+#define EXT2_HASH_HALF_MD4_UNSIGNED 4
+#define EXT2_HASH_TEA_UNSIGNED      5
+
+/**
+ * Maximum number of index levels below the root of a directory index.
+ */
+#define EXT2_HTREE_MAX_LEVELS 2
+
+/**
+ * File type values of directory entries (ext2_dir_entry_t::file_type).
+ */
+#define EXT2_FT_UNKNOWN  0
+#define EXT2_FT_REG_FILE 1
+#define EXT2_FT_DIR      2
+#define EXT2_FT_SYMLINK  7
+
+/**
+ * Maximum length of a file name in a directory entry.
+ */
+#define EXT2_NAME_LEN 255
+
+/**
+ * Size of a directory entry with a name of the given length, padded to four bytes.
+ */
+#define EXT2_DIR_REC_LEN(name_len) ((sizeof(ext2_dir_entry_t) + (name_len) + 3) & ~3)
+
+/**
+ * Number of blocks reserved at once for a file growing at its end. The reservation is kept in
+ * memory only, a block is marked in the bitmap once it is assigned to the file.
+ */
+#define EXT2_PREALLOC_BLOCKS 8
+
+/**
+ * Number of hash buckets of the per-mount inode cache.
+ */
+#define EXT2_INODE_CACHE_BUCKETS 64
+
+/**
+ * Maximum number of unreferenced inodes kept in the inode cache. Referenced inodes
+ * are never evicted and do not count against this limit.
+ */
+#define EXT2_INODE_CACHE_SIZE 128
+
 struct ext2_superblock {
     uint32_t s_inodes_count;        // Total number of inodes
     uint32_t s_blocks_count;        // Total number of blocks
@@ -64,8 +145,27 @@ struct ext2_superblock {
     uint32_t s_feature_compat;      // Compatible feature set
     uint32_t s_feature_incompat;    // Incompatible feature set
     uint32_t s_feature_ro_compat;   // Read-only compatible feature set
+    uint8_t  s_uuid[16];            // Volume id
+    char     s_volume_name[16];     // Volume name
+    char     s_last_mounted[64];    // Path the volume was last mounted at
+    uint32_t s_algo_bitmap;         // Compression algorithms
+    uint8_t  s_prealloc_blocks;     // Blocks to preallocate for files
+    uint8_t  s_prealloc_dir_blocks; // Blocks to preallocate for directories
+    uint16_t s_padding1;            // Padding
+    uint8_t  s_journal_uuid[16];    // Journal superblock id (ext3)
+    uint32_t s_journal_inum;        // Journal inode (ext3)
+    uint32_t s_journal_dev;         // Journal device (ext3)
+    uint32_t s_last_orphan;         // Head of the orphan inode list (ext3)
+    uint32_t s_hash_seed[4];        // Seed of the directory hash
+    uint8_t  s_def_hash_version;    // Default directory hash version
+    uint8_t  s_reserved_char_pad;   // Padding
+    uint16_t s_reserved_word_pad;   // Padding
+    uint32_t s_default_mount_opts;  // Default mount options
+    uint32_t s_first_meta_bg;       // First metablock group
+    uint8_t  s_reserved_ext4[88];   // ext3/ext4 fields not used by this driver
+    uint32_t s_flags;               // Miscellaneous flags (EXT2_FLAGS_*)
 
-    uint8_t  s_reserved[920];       // Padding to a full 1024-byte superblock
+    uint8_t  s_reserved[668];       // Padding to a full 1024-byte superblock
 } __attribute__((packed));
 
 typedef struct ext2_superblock ext2_superblock_t;
@@ -116,6 +216,39 @@ struct ext2_dir_entry {
 
 typedef struct ext2_dir_entry ext2_dir_entry_t;
 
+/**
+ * Header of a directory index, stored in the first block of an indexed directory right after
+ * the "." and ".." entries. The ".." entry spans the rest of the block, so drivers unaware of
+ * the index see it as unused space.
+ */
+struct ext2_dx_root_info {
+    uint32_t reserved_zero;         // Always 0
+    uint8_t  hash_version;          // Hash version (EXT2_HASH_*)
+    uint8_t  info_length;           // Length of this header (8)
+    uint8_t  indirect_levels;       // Number of index levels below the root
+    uint8_t  unused_flags;          // Unused
+} __attribute__((packed));
+
+typedef struct ext2_dx_root_info ext2_dx_root_info_t;
+
+/**
+ * Entry of an index block, mapping hashes from this one on to a logical directory block. The
+ * hash of the first entry is replaced by ext2_dx_countlimit_t and is implicitly 0.
+ */
+struct ext2_dx_entry {
+    uint32_t hash;                  // Lowest hash of the block
+    uint32_t block;                 // Logical block number within the directory
+} __attribute__((packed));
+
+typedef struct ext2_dx_entry ext2_dx_entry_t;
+
+struct ext2_dx_countlimit {
+    uint16_t limit;                 // Maximum number of entries in the index block
+    uint16_t count;                 // Number of entries in use
+} __attribute__((packed));
+
+typedef struct ext2_dx_countlimit ext2_dx_countlimit_t;
+
 /**
  * Probe for an ext2 file system.
  *
@@ -9,6 +9,14 @@
 #define INITFS_HEADER_MAGIC 0xDEAD
 #define INITFS_FILE_HEADER_MAGIC 0xBEEF
 
+/**
+ * The root directory has inode 0, the files are numbered by their index from 1 on, so every
+ * node of the file system has a distinct inode.
+ */
+#define INITFS_ROOT_INODE 0
+#define INITFS_FILE_INODE(index) ((index) + 1)
+#define INITFS_FILE_INDEX(inode) ((inode) - 1)
+
 struct initfs_header {
     uint16_t magic;
     uint32_t n_files;
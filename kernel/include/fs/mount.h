@@ -75,4 +75,11 @@ const vfs_filesystem_t* mnt_get_mountpoint(char* path);
  */
 const vfs_filesystem_t* mnt_get_drive(char drive);
 
+/**
+ * Write back all pending changes of all mounted file systems.
+ * 
+ * @return 0 on success or -1 if any file system failed to sync.
+ */
+int32_t mnt_sync(void);
+
 #endif // _KERNEL_FS_MOUNT_H
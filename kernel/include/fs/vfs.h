@@ -21,6 +21,30 @@
 #define VFS_DIRECTORY   0x02
 #define VFS_SYMLINK     0x03
 
+/**
+ * Path lookups go through a dentry cache, which maps a directory entry, identified by the file
+ * system and inode of its directory and its name, to the node found for it. Names that do not
+ * exist are cached as negative entries. Up to VFS_DCACHE_SIZE entries are kept, the least
+ * recently used one is replaced first. The cache owns the nodes of its entries.
+ */
+#define VFS_DCACHE_BUCKETS 256
+#define VFS_DCACHE_SIZE 256
+
+/**
+ * Nodes are reference counted and unique per file system and inode, so all users of a file
+ * share one node and whatever its file system loaded on open. Live nodes are looked up in a
+ * hash table, their names are interned in a second one.
+ */
+#define VFS_NODE_BUCKETS 256
+#define VFS_NAME_BUCKETS 256
+
+/**
+ * Directories are read in batches of variable length entries. The record length of an entry is
+ * aligned to 4 bytes and covers its NUL terminated name. Each entry carries the position to
+ * continue reading after it, which is opaque to all but the file system that produced it.
+ */
+#define VFS_DIRENT_LEN(name_len) ((sizeof(vfs_dirent_t) + (name_len) + 1 + 3) & ~3)
+
 typedef struct vfs_node vfs_node_t;
 typedef struct vfs_dirent vfs_dirent_t;
 
@@ -38,25 +62,31 @@ struct vfs_node_operations {
 
     int32_t (*read)(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
     int32_t (*write)(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
-    vfs_node_t* (*create)(vfs_node_t* node, char* name, uint32_t permissions);
+    int32_t (*readahead)(vfs_node_t* node, uint32_t offset, size_t size);
+    int32_t (*truncate)(vfs_node_t* node, uint32_t length);
+    int32_t (*create)(vfs_node_t* node, char* name, uint32_t permissions);
     int32_t (*unlink)(vfs_node_t* node, char* name);
 
     // Directory specific operations
 
     int32_t (*mkdir)(vfs_node_t* node, char* name, uint32_t permissions);
     int32_t (*rmdir)(vfs_node_t* node, char* name);
-    vfs_dirent_t* (*readdir)(vfs_node_t* node, uint32_t index);
+    int32_t (*readdir)(vfs_node_t* node, uint32_t* position, void* buffer, size_t size);
     vfs_node_t* (*finddir)(vfs_node_t* node, char* name);
 } __attribute__((packed));
 
 struct vfs_node {
-    char name[256];
+    const char* name;           // Interned name, shared by nodes of the same name
+    uint32_t references;        // Number of holders, the node is freed with the last one
+    uint32_t open_count;        // Number of opens, the file system state is loaded by the first
+    vfs_node_t* hash_next;      // Next node in the bucket of the node table
     uint32_t permissions;
     uint32_t type;
     uint32_t uid;
     uint32_t gid;
     uint32_t length;
     uint32_t inode;
+    uint32_t parent_inode;
     void* inode_data;
     struct vfs_node *link;
     vfs_node_operations_t* operations;
@@ -64,13 +94,18 @@ struct vfs_node {
 } __attribute__((packed));
 
 struct vfs_dirent {
-    char name[256];
     uint32_t inode;
+    uint32_t next;              // Position of the entry following this one
+    uint16_t rec_len;           // Length of this record, the next record starts right after it
+    uint8_t name_len;
+    uint8_t type;               // VFS_FILE, VFS_DIRECTORY, VFS_SYMLINK or 0 if unknown
+    char name[];
 } __attribute__((packed));
 
 struct vfs_filesystem_operations {
     int32_t (*mount)(vfs_filesystem_t* filesystem);
     int32_t (*unmount)(vfs_filesystem_t* filesystem);
+    int32_t (*sync)(vfs_filesystem_t* filesystem);
 } __attribute__((packed));
 
 struct vfs_filesystem {
@@ -80,6 +115,32 @@ struct vfs_filesystem {
     vfs_filesystem_operations_t* operations;
 } __attribute__((packed));
 
+/**
+ * Allocate a node for a file system driver. All fields but the name, inode and file system are
+ * zero. The node starts with one reference held by the caller.
+ * 
+ * @param filesystem The file system of the node.
+ * @param inode The inode of the node.
+ * @param name The name of the node.
+ * @return The node.
+ */
+vfs_node_t* vfs_node_create(vfs_filesystem_t* filesystem, uint32_t inode, const char* name);
+
+/**
+ * Take a reference to a node.
+ * 
+ * @param node The node.
+ * @return The node.
+ */
+vfs_node_t* vfs_node_get(vfs_node_t* node);
+
+/**
+ * Release a reference to a node. The node is freed with its last reference.
+ * 
+ * @param node The node or NULL.
+ */
+void vfs_node_put(vfs_node_t* node);
+
 /**
  * Check if a path is an absolute path.
  * 
@@ -105,7 +166,8 @@ bool vfs_is_file(vfs_node_t* node);
 bool vfs_is_dir(vfs_node_t* node);
 
 /**
- * Open a node. This allows the underlying file system to load data into memory.
+ * Open a node. This allows the underlying file system to load data into memory. Only the first
+ * of several opens of a node reaches the file system.
  * 
  * @param node The node to open.
  * @return 0 on success or -1 on error.
@@ -113,7 +175,8 @@ bool vfs_is_dir(vfs_node_t* node);
 int32_t vfs_open(vfs_node_t* node);
 
 /**
- * Close a node. This allows the underlying file system to unload data from memory.
+ * Close a node. This allows the underlying file system to unload data from memory once the
+ * last open of the node is closed.
  * 
  * @param node The node to close.
  * @return 0 on success or -1 on error.
@@ -151,6 +214,34 @@ int32_t vfs_read(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
  */
 int32_t vfs_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
 
+/**
+ * Hint that a range of a file is going to be read soon. File systems may use this to load the
+ * range into the block cache ahead of time.
+ * 
+ * @param node The file to read ahead.
+ * @param offset The offset of the range.
+ * @param size The size of the range in bytes.
+ * @return 0 on success or -1 if not supported.
+ */
+int32_t vfs_readahead(vfs_node_t* node, uint32_t offset, size_t size);
+
+/**
+ * Truncate a file to the given length. Blocks beyond the new length are released.
+ * 
+ * @param node The file to truncate.
+ * @param length The new length of the file.
+ * @return 0 on success or -1 on error.
+ */
+int32_t vfs_truncate(vfs_node_t* node, uint32_t length);
+
+/**
+ * Write all modified data and metadata of a file system back to its volume.
+ * 
+ * @param filesystem The file system to sync.
+ * @return 0 on success or -1 on error.
+ */
+int32_t vfs_sync(vfs_filesystem_t* filesystem);
+
 /**
  * Create a file.
  * 
@@ -190,30 +281,56 @@ int32_t vfs_mkdir(vfs_node_t* node, char* name, uint32_t permissions);
 int32_t vfs_rmdir(vfs_node_t* node, char* name);
 
 /**
- * Read a directory entry.
+ * Read as many directory entries as fit into a buffer, starting at a position. The position
+ * starts at 0 and is advanced past the entries read.
  * 
  * @param node The directory to read from.
- * @param index The index of the entry to read.
- * @return The directory entry or NULL on error.
+ * @param position The position to read from, updated on return.
+ * @param buffer The buffer to fill with vfs_dirent_t records.
+ * @param size The size of the buffer.
+ * @return The number of bytes filled, 0 at the end of the directory or -1 on error or if the
+ *         next entry does not fit into the buffer.
+ */
+int32_t vfs_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size);
+
+/**
+ * Append a directory entry to a readdir buffer. Used by file systems to fill the buffer.
+ * 
+ * @param buffer The free part of the buffer.
+ * @param size The size of the free part of the buffer.
+ * @param name The name of the entry, not necessarily NUL terminated.
+ * @param name_len The length of the name.
+ * @param inode The inode of the entry.
+ * @param type The type of the entry or 0 if unknown.
+ * @param next The position following the entry.
+ * @return The record length of the entry or 0 if it does not fit.
  */
-vfs_dirent_t* vfs_readdir(vfs_node_t* node, uint32_t index);
+size_t vfs_dirent_fill(void* buffer, size_t size, const char* name, uint8_t name_len, uint32_t inode, uint8_t type, uint32_t next);
 
 /**
  * Find a file in a directory.
  * 
  * @param node The directory to search.
  * @param name The name of the entry to find.
- * @return The file or NULL if not found.
+ * @return The file with a reference for the caller or NULL if not found.
  */
 vfs_node_t* vfs_finddir(vfs_node_t* node, char* name);
 
 /**
- * Find a file by path relative to a node.
+ * Find a file by path relative to a node. The directories on the way are resolved through the
+ * dentry cache.
  * 
  * @param node The node to search from.
  * @param path The path to search for.
- * @return The file or NULL if not found.
+ * @return The file with a reference for the caller or NULL if not found.
  */
 vfs_node_t* vfs_findpath(vfs_node_t* node, char* path);
 
+/**
+ * Drop all dentry cache entries of a file system. Must be called before it is unmounted.
+ * 
+ * @param filesystem The file system.
+ */
+void vfs_dcache_purge(vfs_filesystem_t* filesystem);
+
 #endif // _KERNEL_FS_VFS_H
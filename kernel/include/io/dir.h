@@ -19,7 +19,7 @@ typedef struct dir_descriptor dir_descriptor_t;
 
 struct dir_descriptor {
     vfs_node_t* node;
-    uint32_t index;
+    uint32_t position;          // Read position, see vfs_readdir
 };
 
 typedef struct dir_dirent dir_dirent_t;
@@ -27,6 +27,7 @@ typedef struct dir_dirent dir_dirent_t;
 struct dir_dirent {
     char name[256];
     uint32_t inode;
+    uint8_t type;
 };
 
 /**
@@ -46,11 +47,23 @@ int32_t dir_open(char* path);
 int32_t dir_close(int32_t dd);
 
 /**
- * Read a directory entry.
+ * Read the next directory entry.
  * 
  * @param dd The directory descriptor to read from.
- * @return The directory entry or NULL if there are no more entries.
+ * @param dirent The entry to fill.
+ * @return 0 on success or -1 if there are no more entries or on error.
  */
-const dir_dirent_t* dir_read(int32_t dd);
+int32_t dir_read(int32_t dd, dir_dirent_t* dirent);
+
+/**
+ * Read as many of the next directory entries as fit into a buffer.
+ * 
+ * @param dd The directory descriptor to read from.
+ * @param buffer The buffer to fill with vfs_dirent_t records.
+ * @param size The size of the buffer.
+ * @return The number of bytes filled, 0 if there are no more entries or -1 on error or if the
+ *         buffer is too small for the next entry.
+ */
+int32_t dir_getdents(int32_t dd, void* buffer, size_t size);
 
 #endif // _KERNEL_IO_DIR_H
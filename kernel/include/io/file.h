@@ -20,6 +20,13 @@
 #define FILE_TRUNC     0b00001000
 #define FILE_APPEND    0x00010000
 
+// Permissions of files created through FILE_CREAT
+#define FILE_CREATE_PERMISSIONS 0644
+
+// Bounds of the readahead window of sequentially read files
+#define FILE_READAHEAD_MIN  (16 * 1024)
+#define FILE_READAHEAD_MAX  (128 * 1024)
+
 #define FILE_SEEK_CUR       0
 #define FILE_SEEK_BEGIN     1
 #define FILE_SEEK_END       2
@@ -31,6 +38,9 @@ struct file_descriptor {
     uint32_t size;
     uint32_t offset;
     uint32_t flags;
+    uint32_t readahead_next;    // Offset a sequential read continues at
+    uint32_t readahead_end;     // End of the range read ahead so far
+    uint32_t readahead_window;  // Current window size, 0 after random access
 };
 
 typedef struct file_stat file_stat_t;
@@ -0,0 +1,92 @@
+/**
+ * @file font.h
+ * @brief Bitmap fonts and glyph cache for graphics mode rendering.
+ *
+ * Fonts are monochrome bitmaps with one byte per glyph row, so glyphs are at most
+ * 8 pixels wide. Rendering a glyph bit by bit is slow, therefore glyphs are expanded
+ * into 32 bit pixels for a given color pair once and kept in a glyph cache. Drawing a
+ * cached glyph is a copy of its pixel rows.
+ */
+
+#ifndef _KERNEL_IO_FONT_H
+#define _KERNEL_IO_FONT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define FONT_GLYPHS 256
+
+// Number of cached glyphs as power of two
+#define FONT_GLYPH_CACHE_BITS 9
+#define FONT_GLYPH_CACHE_SIZE (1 << FONT_GLYPH_CACHE_BITS)
+
+typedef struct font font_t;
+typedef struct font_glyph_cache font_glyph_cache_t;
+typedef struct font_glyph_cache_entry font_glyph_cache_entry_t;
+
+struct font {
+    uint32_t width;
+    uint32_t height;
+    uint8_t* bitmap;
+};
+
+struct font_glyph_cache_entry {
+    bool valid;
+    uint8_t ch;
+    uint32_t fgcolor;
+    uint32_t bgcolor;
+};
+
+struct font_glyph_cache {
+    const font_t* font;
+    font_glyph_cache_entry_t* entries;
+    uint32_t* pixels;
+};
+
+/**
+ * Creates a font from a bitmap of FONT_GLYPHS glyphs. The bitmap is copied.
+ *
+ * @param width The glyph width in pixels, at most 8.
+ * @param height The glyph height in pixels.
+ * @param bitmap The glyph rows, the most significant bit is the leftmost pixel.
+ * @return The font or NULL if the size is not supported.
+ */
+font_t* font_create(uint32_t width, uint32_t height, const uint8_t* bitmap);
+
+/**
+ * Sets the font used by graphics mode terminals.
+ *
+ * @param font The font.
+ */
+void font_set_default(const font_t* font);
+
+/**
+ * Gets the font used by graphics mode terminals.
+ *
+ * @return The font or NULL if none has been set.
+ */
+const font_t* font_get_default();
+
+/**
+ * Creates an empty glyph cache for a font.
+ *
+ * @param font The font.
+ * @return The glyph cache.
+ */
+font_glyph_cache_t* font_glyph_cache_create(const font_t* font);
+
+/**
+ * Gets a glyph expanded into 32 bit pixels, row by row without padding. The
+ * glyph is expanded on a cache miss. The pixels are only valid until the next
+ * call for the same cache.
+ *
+ * @param cache The glyph cache.
+ * @param ch The character.
+ * @param fgcolor The pixel value of set bits.
+ * @param bgcolor The pixel value of cleared bits.
+ * @return The pixels of the glyph.
+ */
+const uint32_t* font_glyph_cache_get(font_glyph_cache_t* cache, uint8_t ch, uint32_t fgcolor, uint32_t bgcolor);
+
+#endif // _KERNEL_IO_FONT_H
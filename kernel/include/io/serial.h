@@ -0,0 +1,39 @@
+/**
+ * @file serial.h
+ * @brief Streams on top of serial ports.
+ *
+ * Serial streams write to and read from a 16550 UART. Output newlines are translated
+ * to carriage return and newline, as expected by serial terminals. Input is translated
+ * the other way round, so a serial stream can serve as console in place of a TTY. Escape
+ * sequences are passed through and handled by the terminal on the host.
+ */
+
+#ifndef _KERNEL_IO_SERIAL_H
+#define _KERNEL_IO_SERIAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <io/stream.h>
+
+// The size of a serial terminal is unknown, assume the VT100 default
+#define SERIAL_TERMINAL_ROWS 24
+#define SERIAL_TERMINAL_COLUMNS 80
+
+/**
+ * Creates a stream on a serial port. The port must be initialized already.
+ * 
+ * @param port The I/O port of the UART serial port.
+ * @return The stream.
+ */
+stream_t* serial_create_stream(uint16_t port);
+
+/**
+ * Checks if a stream is a serial stream.
+ * 
+ * @param stream The stream.
+ * @return True if the stream was created by serial_create_stream, false otherwise.
+ */
+bool serial_is_stream(const stream_t* stream);
+
+#endif // _KERNEL_IO_SERIAL_H
@@ -5,13 +5,17 @@
 #include <stdint.h>
 #include <stdarg.h>
 
+#define STREAM_PRINTF_CHUNK_SIZE 256
+
 typedef struct stream stream_t;
 
 struct stream {
     void (*putchar)(stream_t* stream, char ch);
-    char (*getchar)(stream_t* stream);
+    int (*getchar)(stream_t* stream);
     void (*puts)(stream_t* stream, const char* str);
     char* (*gets)(stream_t* stream);
+    size_t (*write)(stream_t* stream, const char* buffer, size_t size);
+    size_t (*read)(stream_t* stream, char* buffer, size_t size);
     void* data;
 };
 
@@ -27,9 +31,9 @@ void stream_putchar(stream_t* stream, char ch);
  * Reads a character from the stream.
  * 
  * @param stream The stream.
- * @return The character read.
+ * @return The character read as an unsigned byte or -1 if none is available.
  */
-char stream_getchar(stream_t* stream);
+int stream_getchar(stream_t* stream);
 
 /**
  * Prints a string to the stream.
@@ -48,8 +52,31 @@ void stream_puts(stream_t* stream, const char* str);
 char* stream_gets(stream_t* stream);
 
 /**
- * Naive printf implementation that writes to a stream. This function does not
- * support all the features of the standard printf function.
+ * Writes a buffer to the stream. The buffer may contain any bytes including NULL
+ * characters. Falls back to putchar if the stream does not implement write.
+ * 
+ * @param stream The stream.
+ * @param buffer The buffer to write.
+ * @param size The number of bytes to write.
+ * @return The number of bytes written.
+ */
+size_t stream_write(stream_t* stream, const char* buffer, size_t size);
+
+/**
+ * Reads the available bytes from the stream into a buffer without blocking.
+ * Falls back to getchar if the stream does not implement read.
+ * 
+ * @param stream The stream.
+ * @param buffer The buffer to read into.
+ * @param size The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t stream_read(stream_t* stream, char* buffer, size_t size);
+
+/**
+ * Printf implementation that writes to a stream. The output is formatted in
+ * chunks, which are written to the stream as a whole. See strfmt for the
+ * supported conversions.
  * 
  * @param stream The stream.
  * @param format The format string.
@@ -59,8 +86,9 @@ char* stream_gets(stream_t* stream);
 int stream_printf(stream_t* stream, const char *format, ...);
 
 /**
- * Naive vprintf implementation that writes to a stream. This function does not
- * support all the features of the standard vprintf function.
+ * Vprintf implementation that writes to a stream. The output is formatted in
+ * chunks, which are written to the stream as a whole. See strfmt for the
+ * supported conversions.
  * 
  * @param stream The stream.
  * @param format The format string.
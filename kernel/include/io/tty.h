@@ -6,9 +6,12 @@
 #include <stdarg.h>
 #include <device/device.h>
 #include <io/stream.h>
-#include <util/circular_buffer.h>
+#include <io/font.h>
+#include <util/spsc_ring.h>
 
 #define TTY_BUFFER_SIZE 1024
+#define TTY_LINE_SIZE 256
+#define TTY_SCROLLBACK_ROWS 200
 
 #define TTY_BLACK			0x00
 #define TTY_BLUE            0x01
@@ -27,6 +30,11 @@
 #define TTY_LIGHT_BROWN		0x0E
 #define TTY_WHITE			0x0F
 
+// Line discipline modes
+#define TTY_MODE_RAW 0x00
+#define TTY_MODE_CANONICAL 0x01 // Reads return whole lines, edited in the kernel
+#define TTY_MODE_ECHO 0x02 // Input is echoed as it is read
+
 typedef struct tty_keymap_entry tty_keymap_entry_t;
 typedef struct tty_keyboard_layout tty_keyboard_layout_t;
 
@@ -59,8 +67,7 @@ struct tty {
     size_t cursor_y;
     uint8_t fgcolor;
     uint8_t bgcolor;
-    circular_buffer_t* input;
-    circular_buffer_t* output;
+    spsc_ring_t* input; // Filled by the keyboard interrupt, drained by readers
     video_device_t* video;
     keyboard_device_t* keyboard;
     tty_keyboard_layout_t* layout;
@@ -70,6 +77,50 @@ struct tty {
     uint32_t ansi_params[TTY_ANSI_MAX_PARAMS];
     size_t ansi_param_count;
     uint32_t ansi_current;
+
+    /*
+     * Rendering is deferred: characters are rendered into the shadow cell buffer
+     * and only the dirty rows [dirty_start, dirty_end) are copied to the video
+     * device on flush. Scrolls of the shadow buffer are replayed on the device
+     * on flush, so the device can scroll the rows it already holds itself.
+     */
+    uint16_t* cells;
+    size_t dirty_start;
+    size_t dirty_end;
+    size_t scroll_pending;
+    size_t hw_cursor;
+
+    /*
+     * Rows scrolled off the screen are kept in a ring of TTY_SCROLLBACK_ROWS
+     * rows of cells. While the view is scrolled back (scrollback_offset rows
+     * above the live screen), output is rendered into the shadow buffer only.
+     */
+    uint16_t* scrollback;
+    size_t scrollback_head;
+    size_t scrollback_count;
+    size_t scrollback_offset;
+
+    /*
+     * Graphics mode backend, used if the video device does not support text mode.
+     * Cells are drawn from the glyph cache and the cursor is drawn as underline.
+     */
+    const font_t* font;
+    font_glyph_cache_t* glyphs;
+    bool cursor_enabled;
+
+    // Optional stream that receives a copy of everything written, e.g. a serial port
+    stream_t* mirror;
+
+    /*
+     * Line discipline. In canonical mode input is collected into the line buffer,
+     * with backspace handled, until a newline completes it. The completed line is
+     * then handed out to readers, possibly over several reads.
+     */
+    uint32_t mode;
+    char line[TTY_LINE_SIZE];
+    size_t line_length;
+    size_t line_offset;
+    bool line_ready;
 };
 
 extern tty_keyboard_layout_t tty_keyboard_layout_de_DE;
@@ -89,7 +140,8 @@ void tty_set_stdterm(tty_t* tty);
 const tty_t* tty_get_stdterm();
 
 /**
- * Creates a new TTY.
+ * Creates a new TTY. If the video device does not support text mode, the TTY
+ * renders into the graphics mode of the device using the default font.
  * 
  * @param video The video device to use.
  * @param keyboard The keyboard device to use.
@@ -123,7 +175,8 @@ stream_t* tty_get_in_stream(tty_t* tty);
 stream_t* tty_get_err_stream(tty_t* tty);
 
 /**
- * Flushes the TTY.
+ * Flushes the TTY by copying the dirty rows of the shadow buffer to the video
+ * device and moving the hardware cursor to the current cursor position.
  * 
  * @param tty The TTY.
  */
@@ -144,15 +197,38 @@ void tty_clear(tty_t* tty0);
  */
 void tty_putchar(tty_t* tty0, char c);
 
+/**
+ * Writes a buffer to the TTY. The buffer is rendered as a whole and may contain
+ * NULL characters.
+ * 
+ * @param tty The TTY.
+ * @param buffer The buffer to write.
+ * @param size The number of bytes to write.
+ * @return The number of bytes written.
+ */
+size_t tty_write(tty_t* tty, const char* buffer, size_t size);
+
+/**
+ * Reads input of the TTY into a buffer. Blocks until input is available. In canonical
+ * mode it blocks until a whole line or the requested number of bytes has been entered,
+ * otherwise it returns the input available as soon as there is any.
+ * 
+ * @param tty The TTY.
+ * @param buffer The buffer to read into.
+ * @param size The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t tty_read(tty_t* tty, char* buffer, size_t size);
+
 /**
  * Reads a character from the TTY. In contrast to the other functions of the TTY,
  * this function is implemented in raw mode and not in canonical mode, meaning
  * it does not block and echoing is disabled.
  * 
  * @param tty The TTY.
- * @return The character read.
+ * @return The character read as an unsigned byte or -1 if none is available.
  */
-char tty_getchar(tty_t* tty0);
+int tty_getchar(tty_t* tty0);
 
 /**
  * Writes a string to the TTY.
@@ -193,6 +269,30 @@ void tty_set_bgcolor(tty_t* tty0, uint8_t bgcolor);
  */
 void tty_disable_cursor(tty_t* tty0);
 
+/**
+ * Sets the line discipline mode of the TTY.
+ * 
+ * @param tty The TTY.
+ * @param mode The mode (TTY_MODE_* mask).
+ */
+void tty_set_mode(tty_t* tty, uint32_t mode);
+
+/**
+ * Checks if a stream is backed by a TTY.
+ * 
+ * @param stream The stream.
+ * @return True if the stream was created by one of the tty_get_*_stream functions, false otherwise.
+ */
+bool tty_is_stream(const stream_t* stream);
+
+/**
+ * Mirrors the output of the TTY to a stream.
+ * 
+ * @param tty The TTY.
+ * @param stream The stream to mirror to or NULL to stop mirroring.
+ */
+void tty_set_mirror(tty_t* tty, stream_t* stream);
+
 /**
  * Enables the cursor of the TTY.
  * 
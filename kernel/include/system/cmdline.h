@@ -0,0 +1,37 @@
+#ifndef _KERNEL_SYSTEM_CMDLINE_H
+#define _KERNEL_SYSTEM_CMDLINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CMDLINE_MAX_LENGTH 256
+
+/**
+ * Saves the kernel command line passed by the bootloader. The command line
+ * consists of space separated options of the form key=value or key.
+ * 
+ * @param cmdline The command line, may be NULL.
+ */
+void cmdline_init(const char* cmdline);
+
+/**
+ * Gets the value of a command line option.
+ * 
+ * @param key The option.
+ * @param buffer The buffer to copy the value into.
+ * @param size The size of the buffer.
+ * @return 0 if the option is set, -1 otherwise.
+ */
+int32_t cmdline_get(const char* key, char* buffer, size_t size);
+
+/**
+ * Checks if a command line option is set to the given value.
+ * 
+ * @param key The option.
+ * @param value The value.
+ * @return True if the option is set to the value, false otherwise.
+ */
+bool cmdline_equals(const char* key, const char* value);
+
+#endif // _KERNEL_SYSTEM_CMDLINE_H
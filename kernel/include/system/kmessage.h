@@ -10,6 +10,7 @@
 #define _KERNEL_SYSTEM_KMESSAGE_H
 
 #include <util/linked_list.h>
+#include <io/stream.h>
 
 #define KMESSAGE_LEVEL_PANIC "DEBUG"
 #define KMESSAGE_LEVEL_INFO "INFO"
@@ -37,6 +38,14 @@ void kmessage_init();
  */
 void kmessage(const char* level, const char* message);
 
+/**
+ * Mirrors the kernel log to a stream, e.g. a serial port. The messages logged so far
+ * are written immediately, later messages as they are logged.
+ * 
+ * @param stream The stream to mirror to or NULL to stop mirroring.
+ */
+void kmessage_set_mirror(stream_t* stream);
+
 /**
  * Get the messages from the kernel log.
  * 
@@ -10,6 +10,9 @@
 #define SYSCALL_GET_OSINFO 0x04
 #define SYSCALL_GET_MEMINFO 0x05
 #define SYSCALL_GET_TERMINFO 0x06
+#define SYSCALL_SEEK 0x07
+#define SYSCALL_SET_TERMMODE 0x08
+#define SYSCALL_GET_CACHEINFO 0x09
 #define SYSCALL_ALLOC_HEAP 0x0A
 #define SYSCALL_EXIT 0x0B
 #define SYSCALL_OPENDIR 0x0C
@@ -26,6 +29,9 @@
 #define SYSCALL_MEMMAP 0x17
 #define SYSCALL_GET_KHEAPINFO 0x18
 #define SYSCALL_SPAWN 0x19
+#define SYSCALL_GET_CPUINFO 0x1A
+#define SYSCALL_SYNC 0x1B
+#define SYSCALL_GETDENTS 0x1C
 
 /**
  * Initializes the syscall handler.
@@ -13,6 +13,15 @@
  */
 char *itoa(int32_t n, char *buf, uint32_t base);
 
+/**
+ * Converts a string to an integer. Leading whitespace and a sign are accepted,
+ * conversion stops at the first character that is not a decimal digit.
+ * 
+ * @param str The string to convert.
+ * @return The integer value of the string.
+ */
+int32_t atoi(const char *str);
+
 /**
  * Converts a double to a string.
  * 
@@ -0,0 +1,257 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring buffer.
+ *
+ * The ring is meant for queues between an interrupt handler and the code consuming
+ * its data, e.g. a keyboard or UART interrupt and a reading syscall. Only the producer
+ * writes the head and only the consumer writes the tail, so neither side needs to
+ * disable interrupts as long as there is exactly one of each.
+ *
+ * The capacity is a power of two and head and tail run freely, so the index of an
+ * element is a mask of its position and the fill level is the difference of head and
+ * tail. Unlike circular_buffer_t, the ring never overwrites elements when full.
+ */
+
+#ifndef _KERNEL_UTIL_SPSC_RING_H
+#define _KERNEL_UTIL_SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <util/string.h>
+#include <memory/kheap.h>
+
+/*
+ * x86 neither reorders stores with other stores nor loads with other loads, so
+ * keeping the compiler from reordering the element accesses around the index
+ * updates is sufficient to publish elements.
+ */
+#define SPSC_RING_BARRIER() __asm__ volatile("" ::: "memory")
+
+typedef struct spsc_ring spsc_ring_t;
+
+struct spsc_ring {
+    uint8_t* buffer;
+    size_t element_size;
+    size_t mask;
+    volatile size_t head;
+    volatile size_t tail;
+};
+
+/**
+ * Creates a ring buffer.
+ *
+ * @param capacity The minimum number of elements, rounded up to a power of two.
+ * @param element_size The size of an element in bytes.
+ * @return The ring buffer or NULL if out of memory.
+ */
+static inline spsc_ring_t* spsc_ring_create(size_t capacity, size_t element_size) {
+    size_t size = 1;
+
+    while(size < capacity) {
+        size <<= 1;
+    }
+
+    spsc_ring_t* ring = (spsc_ring_t*) kmalloc(sizeof(spsc_ring_t));
+
+    if(!ring) {
+        return NULL;
+    }
+
+    ring->buffer = (uint8_t*) kmalloc(size * element_size);
+
+    if(!ring->buffer) {
+        kfree(ring);
+        return NULL;
+    }
+
+    ring->element_size = element_size;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return ring;
+}
+
+static inline void spsc_ring_destroy(spsc_ring_t* ring) {
+    kfree(ring->buffer);
+    kfree(ring);
+}
+
+static inline size_t spsc_ring_capacity(const spsc_ring_t* ring) {
+    return ring->mask + 1;
+}
+
+static inline size_t spsc_ring_size(const spsc_ring_t* ring) {
+    return ring->head - ring->tail;
+}
+
+static inline bool spsc_ring_empty(const spsc_ring_t* ring) {
+    return ring->head == ring->tail;
+}
+
+static inline bool spsc_ring_full(const spsc_ring_t* ring) {
+    return spsc_ring_size(ring) == spsc_ring_capacity(ring);
+}
+
+/**
+ * Enqueues an element. Must only be called by the producer.
+ *
+ * @param ring The ring buffer.
+ * @param element The element to copy into the ring.
+ * @return True if the element was enqueued, false if the ring is full.
+ */
+static inline bool spsc_ring_enqueue(spsc_ring_t* ring, const void* element) {
+    size_t head = ring->head;
+
+    if(head - ring->tail == ring->mask + 1) {
+        return false;
+    }
+
+    memcpy(ring->buffer + (head & ring->mask) * ring->element_size, element, ring->element_size);
+
+    SPSC_RING_BARRIER();
+    ring->head = head + 1;
+
+    return true;
+}
+
+/**
+ * Dequeues an element. Must only be called by the consumer.
+ *
+ * @param ring The ring buffer.
+ * @param element The buffer to copy the element into or NULL to drop it.
+ * @return True if an element was dequeued, false if the ring is empty.
+ */
+static inline bool spsc_ring_dequeue(spsc_ring_t* ring, void* element) {
+    size_t tail = ring->tail;
+
+    if(tail == ring->head) {
+        return false;
+    }
+
+    SPSC_RING_BARRIER();
+
+    if(element) {
+        memcpy(element, ring->buffer + (tail & ring->mask) * ring->element_size, ring->element_size);
+    }
+
+    SPSC_RING_BARRIER();
+    ring->tail = tail + 1;
+
+    return true;
+}
+
+/**
+ * Enqueues as many of the given elements as fit. The elements become visible to the
+ * consumer at once. Must only be called by the producer.
+ *
+ * @param ring The ring buffer.
+ * @param elements The elements to copy into the ring.
+ * @param count The number of elements.
+ * @return The number of elements enqueued.
+ */
+static inline size_t spsc_ring_enqueue_bulk(spsc_ring_t* ring, const void* elements, size_t count) {
+    size_t head = ring->head;
+    size_t available = ring->mask + 1 - (head - ring->tail);
+
+    if(count > available) {
+        count = available;
+    }
+
+    if(count == 0) {
+        return 0;
+    }
+
+    // The elements are copied in at most two runs, up to the end of the buffer and from its start
+    size_t index = head & ring->mask;
+    size_t first = ring->mask + 1 - index;
+
+    if(first > count) {
+        first = count;
+    }
+
+    memcpy(ring->buffer + index * ring->element_size, elements, first * ring->element_size);
+    memcpy(ring->buffer, (const uint8_t*) elements + first * ring->element_size, (count - first) * ring->element_size);
+
+    SPSC_RING_BARRIER();
+    ring->head = head + count;
+
+    return count;
+}
+
+/**
+ * Dequeues up to the given number of elements. Must only be called by the consumer.
+ *
+ * @param ring The ring buffer.
+ * @param elements The buffer to copy the elements into.
+ * @param count The maximum number of elements.
+ * @return The number of elements dequeued.
+ */
+static inline size_t spsc_ring_dequeue_bulk(spsc_ring_t* ring, void* elements, size_t count) {
+    size_t tail = ring->tail;
+    size_t available = ring->head - tail;
+
+    if(count > available) {
+        count = available;
+    }
+
+    if(count == 0) {
+        return 0;
+    }
+
+    SPSC_RING_BARRIER();
+
+    size_t index = tail & ring->mask;
+    size_t first = ring->mask + 1 - index;
+
+    if(first > count) {
+        first = count;
+    }
+
+    memcpy(elements, ring->buffer + index * ring->element_size, first * ring->element_size);
+    memcpy((uint8_t*) elements + first * ring->element_size, ring->buffer, (count - first) * ring->element_size);
+
+    SPSC_RING_BARRIER();
+    ring->tail = tail + count;
+
+    return count;
+}
+
+/*
+ * Fast paths for byte rings, which avoid the copy of a runtime sized element.
+ * They must only be used on rings created with an element size of one.
+ */
+
+static inline bool spsc_ring_put_byte(spsc_ring_t* ring, uint8_t byte) {
+    size_t head = ring->head;
+
+    if(head - ring->tail == ring->mask + 1) {
+        return false;
+    }
+
+    ring->buffer[head & ring->mask] = byte;
+
+    SPSC_RING_BARRIER();
+    ring->head = head + 1;
+
+    return true;
+}
+
+static inline bool spsc_ring_get_byte(spsc_ring_t* ring, uint8_t* byte) {
+    size_t tail = ring->tail;
+
+    if(tail == ring->head) {
+        return false;
+    }
+
+    SPSC_RING_BARRIER();
+    *byte = ring->buffer[tail & ring->mask];
+
+    SPSC_RING_BARRIER();
+    ring->tail = tail + 1;
+
+    return true;
+}
+
+#endif // _KERNEL_UTIL_SPSC_RING_H
@@ -3,6 +3,14 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdarg.h>
+
+/**
+ * Selects the fastest variants of the memory primitives (memcpy, memset,
+ * copy_page and zero_page) for the running CPU. Must be called after the
+ * CPU features have been detected by cpu_init.
+ */
+void string_init(void);
 
 /**
  * Determines the length of a string.
@@ -71,6 +79,17 @@ void *memset(void *dest, uint8_t ch, size_t n);
  */
 void *memsetw(void *dest, uint16_t value, size_t n);
 
+/**
+ * Copies the given value into each of the first n double words
+ * of the object pointed to by dest. The destination must be dword aligned.
+ * 
+ * @param dest The destination to copy the value to.
+ * @param value The value to copy.
+ * @param n The number of double words to copy.
+ * @return A pointer to the destination.
+ */
+void *memsetl(void *dest, uint32_t value, size_t n);
+
 /**
  * Copies n characters from the object pointed to by src into
  * the object pointed to by dest.
@@ -82,6 +101,34 @@ void *memsetw(void *dest, uint16_t value, size_t n);
  */
 void *memcpy(void *dest, const void *src, size_t n);
 
+/**
+ * Copies n characters from the object pointed to by src into the object
+ * pointed to by dest. In contrast to memcpy, the objects may overlap.
+ * 
+ * @param dest The destination to copy the characters to.
+ * @param src The source to copy the characters from.
+ * @param n The number of characters to copy.
+ * @return A pointer to the destination.
+ */
+void *memmove(void *dest, const void *src, size_t n);
+
+/**
+ * Copies a whole 4 KiB page frame. Both addresses must be page aligned.
+ * 
+ * @param dest The destination page to copy to.
+ * @param src The source page to copy from.
+ * @return A pointer to the destination.
+ */
+void *copy_page(void *dest, const void *src);
+
+/**
+ * Zeroes a whole 4 KiB page frame. The address must be page aligned.
+ * 
+ * @param dest The page to zero.
+ * @return A pointer to the page.
+ */
+void *zero_page(void *dest);
+
 /**
  * Compares the first n bytes of the objects pointed to by s1 and s2.
  * 
@@ -135,14 +182,40 @@ int strncmp(const char *str1, const char *str2, size_t n);
 char *strncpy(char *dest, const char *src, size_t n);
 
 /**
- * Naive string format implementation that writes to a string buffer. This function
- * does not support all the features of the standard strfmt function.
+ * String format implementation that writes to a string buffer. Supports the flags
+ * '-', '0', '+' and ' ', field width and precision (also as '*'), the length
+ * modifiers hh, h, l, ll and z and the conversions %c, %s, %d, %i, %u, %o, %x, %X,
+ * %b, %p and %f. Hexadecimal and binary numbers are prefixed with 0x/0b, floating
+ * point numbers are printed with two decimal places by default.
  * 
  * @param str The string buffer to write to.
  * @param format The format string.
  * @param ... The arguments to format.
- * @return The number of characters written or EOF on error.
+ * @return The number of characters written.
  */
 int strfmt(char * str, const char * format, ... );
 
+/**
+ * Bounded variant of strfmt. At most size - 1 characters are written, followed
+ * by a NULL terminator.
+ * 
+ * @param str The string buffer to write to.
+ * @param size The size of the string buffer.
+ * @param format The format string.
+ * @param ... The arguments to format.
+ * @return The number of characters the complete output has, which may exceed the buffer.
+ */
+int strnfmt(char* str, size_t size, const char* format, ...);
+
+/**
+ * Bounded variant of strfmt taking a variable argument list.
+ * 
+ * @param str The string buffer to write to.
+ * @param size The size of the string buffer.
+ * @param format The format string.
+ * @param args The arguments to format.
+ * @return The number of characters the complete output has, which may exceed the buffer.
+ */
+int vstrnfmt(char* str, size_t size, const char* format, va_list args);
+
 #endif // _KERNEL_UTIL_STRING_H
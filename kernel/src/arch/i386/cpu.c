@@ -0,0 +1,185 @@
+#include <arch/i386/cpu.h>
+#include <memory/kheap.h>
+#include <system/kpanic.h>
+#include <system/kmessage.h>
+#include <util/string.h>
+
+static cpu_info_t cpu_info;
+
+static const struct {
+    uint32_t feature;
+    const char* name;
+} cpu_feature_names[] = {
+    { CPU_FEATURE_FPU, "fpu" },
+    { CPU_FEATURE_PSE, "pse" },
+    { CPU_FEATURE_TSC, "tsc" },
+    { CPU_FEATURE_PAE, "pae" },
+    { CPU_FEATURE_APIC, "apic" },
+    { CPU_FEATURE_SEP, "sep" },
+    { CPU_FEATURE_PGE, "pge" },
+    { CPU_FEATURE_CMOV, "cmov" },
+    { CPU_FEATURE_MMX, "mmx" },
+    { CPU_FEATURE_FXSR, "fxsr" },
+    { CPU_FEATURE_SSE, "sse" },
+    { CPU_FEATURE_SSE2, "sse2" },
+    { CPU_FEATURE_SSE3, "sse3" },
+    { CPU_FEATURE_ERMS, "erms" },
+};
+
+static bool cpu_has_cpuid();
+static void cpu_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t* eax, uint32_t* ebx, uint32_t* ecx, uint32_t* edx);
+static void cpu_log_info();
+
+void cpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    memset(&cpu_info, 0, sizeof(cpu_info_t));
+
+    if(!cpu_has_cpuid()) {
+        kmessage(KMESSAGE_LEVEL_WARN, "cpu: CPUID is not supported, using generic code paths");
+        return;
+    }
+
+    // Leaf 0x00: Highest standard leaf and vendor identification
+
+    cpu_cpuid(0x00, 0, &eax, &ebx, &ecx, &edx);
+
+    uint32_t max_leaf = eax;
+
+    memcpy(cpu_info.vendor + 0, &ebx, 4);
+    memcpy(cpu_info.vendor + 4, &edx, 4);
+    memcpy(cpu_info.vendor + 8, &ecx, 4);
+    cpu_info.vendor[12] = '\0';
+
+    // Leaf 0x01: Processor signature and standard features
+
+    if(max_leaf >= 0x01) {
+        cpu_cpuid(0x01, 0, &eax, &ebx, &ecx, &edx);
+
+        uint32_t base_family = (eax >> 8) & 0x0F;
+        uint32_t base_model = (eax >> 4) & 0x0F;
+
+        cpu_info.stepping = eax & 0x0F;
+        cpu_info.family = base_family;
+        cpu_info.model = base_model;
+
+        if(base_family == 0x0F) {
+            cpu_info.family += (eax >> 20) & 0xFF;
+        }
+
+        if(base_family == 0x06 || base_family == 0x0F) {
+            cpu_info.model += ((eax >> 16) & 0x0F) << 4;
+        }
+
+        if(edx & CPU_CPUID_EDX_FPU) cpu_info.features |= CPU_FEATURE_FPU;
+        if(edx & CPU_CPUID_EDX_PSE) cpu_info.features |= CPU_FEATURE_PSE;
+        if(edx & CPU_CPUID_EDX_TSC) cpu_info.features |= CPU_FEATURE_TSC;
+        if(edx & CPU_CPUID_EDX_PAE) cpu_info.features |= CPU_FEATURE_PAE;
+        if(edx & CPU_CPUID_EDX_APIC) cpu_info.features |= CPU_FEATURE_APIC;
+        if(edx & CPU_CPUID_EDX_PGE) cpu_info.features |= CPU_FEATURE_PGE;
+        if(edx & CPU_CPUID_EDX_CMOV) cpu_info.features |= CPU_FEATURE_CMOV;
+        if(edx & CPU_CPUID_EDX_MMX) cpu_info.features |= CPU_FEATURE_MMX;
+        if(edx & CPU_CPUID_EDX_FXSR) cpu_info.features |= CPU_FEATURE_FXSR;
+        if(edx & CPU_CPUID_EDX_SSE) cpu_info.features |= CPU_FEATURE_SSE;
+        if(edx & CPU_CPUID_EDX_SSE2) cpu_info.features |= CPU_FEATURE_SSE2;
+        if(ecx & CPU_CPUID_ECX_SSE3) cpu_info.features |= CPU_FEATURE_SSE3;
+
+        /*
+         * Early Pentium Pro models report SEP although SYSENTER/SYSEXIT are
+         * not working correctly on them (family 6, model < 3, stepping < 3).
+         */
+        if((edx & CPU_CPUID_EDX_SEP) && !(cpu_info.family == 6 && cpu_info.model < 3 && cpu_info.stepping < 3)) {
+            cpu_info.features |= CPU_FEATURE_SEP;
+        }
+    }
+
+    // Leaf 0x07: Structured extended features
+
+    if(max_leaf >= 0x07) {
+        cpu_cpuid(0x07, 0, &eax, &ebx, &ecx, &edx);
+
+        if(ebx & CPU_CPUID_EXT_EBX_ERMS) cpu_info.features |= CPU_FEATURE_ERMS;
+    }
+
+    // Leaves 0x80000002 - 0x80000004: Processor brand string
+
+    cpu_cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx);
+
+    if(eax >= 0x80000004) {
+        uint32_t* brand = (uint32_t*) cpu_info.brand;
+
+        for(uint32_t leaf = 0x80000002; leaf <= 0x80000004; leaf++) {
+            cpu_cpuid(leaf, 0, &brand[0], &brand[1], &brand[2], &brand[3]);
+            brand += 4;
+        }
+
+        cpu_info.brand[48] = '\0';
+    }
+
+    cpu_log_info();
+}
+
+const cpu_info_t* cpu_get_info(void) {
+    return &cpu_info;
+}
+
+bool cpu_has_feature(uint32_t features) {
+    return (cpu_info.features & features) == features;
+}
+
+static bool cpu_has_cpuid() {
+    uint32_t original, toggled;
+
+    // CPUID is supported if the ID flag in EFLAGS can be toggled
+    __asm__ volatile(
+        "pushfl\n"
+        "pop %0\n"
+        "mov %0, %1\n"
+        "xor %2, %1\n"
+        "push %1\n"
+        "popfl\n"
+        "pushfl\n"
+        "pop %1\n"
+        "push %0\n"
+        "popfl\n"
+        : "=&r" (original), "=&r" (toggled)
+        : "i" (CPU_EFLAGS_ID)
+        : "cc");
+
+    return ((original ^ toggled) & CPU_EFLAGS_ID) != 0;
+}
+
+static void cpu_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t* eax, uint32_t* ebx, uint32_t* ecx, uint32_t* edx) {
+    __asm__ volatile("cpuid"
+        : "=a" (*eax), "=b" (*ebx), "=c" (*ecx), "=d" (*edx)
+        : "a" (leaf), "c" (subleaf));
+}
+
+static void cpu_log_info() {
+    char* kernel_message = kmalloc(128);
+
+    if(!kernel_message) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    strfmt(kernel_message, "cpu: %s Family %d Model %d Stepping %d", cpu_info.vendor, cpu_info.family, cpu_info.model, cpu_info.stepping);
+
+    kmessage(KMESSAGE_LEVEL_INFO, kernel_message);
+
+    char* features_message = kmalloc(128);
+
+    if(!features_message) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    strcpy(features_message, "cpu: Features:");
+
+    for(size_t index = 0; index < sizeof(cpu_feature_names) / sizeof(cpu_feature_names[0]); index++) {
+        if(cpu_info.features & cpu_feature_names[index].feature) {
+            strcat(features_message, " ");
+            strcat(features_message, cpu_feature_names[index].name);
+        }
+    }
+
+    kmessage(KMESSAGE_LEVEL_INFO, features_message);
+}
@@ -9,6 +9,8 @@ isr_stage1:
 	; Save the current processor state
 
 	pusha
+
+    cld                     ; Kernel string operations expect a cleared direction flag
     
     mov ax, ds
     push eax
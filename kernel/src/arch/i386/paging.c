@@ -47,7 +47,7 @@ void paging_map_page(page_directory_t *const page_directory, void *const virtual
             KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
         }
 
-        memset(table, 0, sizeof(page_table_t));
+        zero_page(table);
 
         uint32_t table_physical_address = (uint32_t) paging_virtual_to_physical_address(page_directory, table);
 
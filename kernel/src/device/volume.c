@@ -4,8 +4,29 @@
 #include <fs/mbr.h>
 #include <system/kpanic.h>
 
+typedef struct volume_cache_entry volume_cache_entry_t;
+
+struct volume_cache_entry {
+    volume_t* volume;
+    size_t block;
+    bool dirty;
+    volume_cache_entry_t* hash_next;
+    volume_cache_entry_t* lru_prev;
+    volume_cache_entry_t* lru_next;
+    char data[VOLUME_CACHE_BLOCK_SIZE];
+};
+
 static linked_list_t* volumes;
 
+static volume_cache_entry_t* volume_cache_buckets[VOLUME_CACHE_BUCKETS];
+static volume_cache_entry_t* volume_cache_lru_head = NULL;
+static volume_cache_entry_t* volume_cache_lru_tail = NULL;
+static size_t volume_cache_blocks = 0;
+static size_t volume_cache_dirty = 0;
+static size_t volume_cache_budget = VOLUME_CACHE_DEFAULT_BUDGET;
+static size_t volume_cache_hits = 0;
+static size_t volume_cache_misses = 0;
+
 static bool volume_id_exists(const char* id);
 static bool volume_unregister_device_compare(void* node_data, void* compare_data);
 static bool volume_find_by_id_compare(void* node_data, void* compare_data);
@@ -13,6 +34,17 @@ static bool volume_find_by_name_compare(void* node_data, void* compare_data);
 static size_t volume_total_size(volume_t* volume);
 static size_t volume_read(volume_t* volume, size_t offset, size_t size, char* buffer);
 static size_t volume_write(volume_t* volume, size_t offset, size_t size, char* buffer);
+static size_t volume_prefetch(volume_t* volume, size_t offset, size_t size);
+static int32_t volume_sync(volume_t* volume);
+static size_t volume_cache_hash(volume_t* volume, size_t block);
+static volume_cache_entry_t* volume_cache_find(volume_t* volume, size_t block);
+static volume_cache_entry_t* volume_cache_insert(volume_t* volume, size_t block);
+static void volume_cache_remove(volume_cache_entry_t* entry);
+static void volume_cache_touch(volume_cache_entry_t* entry);
+static void volume_cache_invalidate(volume_t* volume);
+static void volume_cache_copy(size_t block, const char* data, size_t offset, size_t size, char* buffer);
+static int32_t volume_cache_write_run(volume_cache_entry_t* entry);
+static int32_t volume_cache_flush(volume_t* volume);
 
 void volume_init() {
     volumes = linked_list_create();
@@ -57,6 +89,8 @@ size_t volume_register_device(storage_device_t* device) {
         volume->operations->total_size = volume_total_size;
         volume->operations->read = volume_read;
         volume->operations->write = volume_write;
+        volume->operations->prefetch = volume_prefetch;
+        volume->operations->sync = volume_sync;
 
         linked_list_node_t* new_node = linked_list_create_node(volume);
 
@@ -116,6 +150,8 @@ size_t volume_register_device(storage_device_t* device) {
         volume->operations->total_size = volume_total_size;
         volume->operations->read = volume_read;
         volume->operations->write = volume_write;
+        volume->operations->prefetch = volume_prefetch;
+        volume->operations->sync = volume_sync;
 
         linked_list_node_t* new_node = linked_list_create_node(volume);
 
@@ -149,6 +185,9 @@ void volume_unregister_device(storage_device_t* device) {
 
     volume_t* volume = (volume_t*) node->data;
 
+    volume_cache_flush(volume);
+    volume_cache_invalidate(volume);
+
     kfree(volume->name);
     kfree(volume);
     kfree(node);
@@ -196,6 +235,9 @@ static size_t volume_total_size(volume_t* volume) {
     return volume->size;
 }
 
+/**
+ * Reads a range through the block cache. Without a buffer, the range is only loaded into the cache.
+ */
 static size_t volume_read(volume_t* volume, size_t offset, size_t size, char* buffer) {
     if(offset > volume->size) {
         return 0;
@@ -205,7 +247,89 @@ static size_t volume_read(volume_t* volume, size_t offset, size_t size, char* bu
         size = volume->size - offset;
     }
 
-    return volume->device->driver->read(volume->offset + offset, size, buffer);
+    if(size == 0 || volume_cache_budget < VOLUME_CACHE_BLOCK_SIZE) {
+        return volume->device->driver->read(volume->offset + offset, size, buffer);
+    }
+
+    size_t block = offset / VOLUME_CACHE_BLOCK_SIZE;
+    size_t last_block = (offset + size - 1) / VOLUME_CACHE_BLOCK_SIZE;
+
+    while(block <= last_block) {
+        volume_cache_entry_t* entry = volume_cache_find(volume, block);
+
+        if(entry) {
+            // Blocks that are already cached are skipped when prefetching
+            if(buffer) {
+                volume_cache_hits++;
+                volume_cache_touch(entry);
+                volume_cache_copy(block, entry->data, offset, size, buffer);
+            }
+
+            block++;
+            continue;
+        }
+
+        // Consecutive missing blocks are fetched with a single device read
+        size_t run = 1;
+
+        while(block + run <= last_block && run < VOLUME_CACHE_MAX_RUN && !volume_cache_find(volume, block + run)) {
+            run++;
+        }
+
+        volume_cache_misses += run;
+
+        size_t run_offset = block * VOLUME_CACHE_BLOCK_SIZE;
+        size_t run_size = run * VOLUME_CACHE_BLOCK_SIZE;
+
+        // The last block of the volume may be partial
+        if(run_offset + run_size > volume->size) {
+            run_size = volume->size - run_offset;
+        }
+
+        char* data = (char*) kmalloc(run * VOLUME_CACHE_BLOCK_SIZE);
+
+        if(!data) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+        }
+
+        if(volume->device->driver->read(volume->offset + run_offset, run_size, data) != run_size) {
+            kfree(data);
+            return run_offset > offset ? run_offset - offset : 0;
+        }
+
+        memset(data + run_size, 0, run * VOLUME_CACHE_BLOCK_SIZE - run_size);
+
+        for(size_t index = 0; index < run; index++) {
+            const char* block_data = data + index * VOLUME_CACHE_BLOCK_SIZE;
+
+            entry = volume_cache_insert(volume, block + index);
+
+            if(entry) {
+                memcpy(entry->data, block_data, VOLUME_CACHE_BLOCK_SIZE);
+            }
+
+            if(buffer) {
+                volume_cache_copy(block + index, block_data, offset, size, buffer);
+            }
+        }
+
+        kfree(data);
+
+        block += run;
+    }
+
+    return size;
+}
+
+/**
+ * Loads the blocks of a range into the cache by reading it without a destination buffer.
+ */
+static size_t volume_prefetch(volume_t* volume, size_t offset, size_t size) {
+    if(size == 0 || offset >= volume->size || volume_cache_budget < VOLUME_CACHE_BLOCK_SIZE) {
+        return 0;
+    }
+
+    return volume_read(volume, offset, size, NULL);
 }
 
 static size_t volume_write(volume_t* volume, size_t offset, size_t size, char* buffer) {
@@ -217,5 +341,312 @@ static size_t volume_write(volume_t* volume, size_t offset, size_t size, char* b
         size = volume->size - offset;
     }
 
-    return volume->device->driver->write(volume->offset + offset, size, buffer);
+    if(size == 0 || volume_cache_budget < VOLUME_CACHE_BLOCK_SIZE) {
+        return volume->device->driver->write(volume->offset + offset, size, buffer);
+    }
+
+    size_t first_block = offset / VOLUME_CACHE_BLOCK_SIZE;
+    size_t last_block = (offset + size - 1) / VOLUME_CACHE_BLOCK_SIZE;
+
+    for(size_t block = first_block; block <= last_block; block++) {
+        size_t block_offset = block * VOLUME_CACHE_BLOCK_SIZE;
+        size_t block_size = volume->size - block_offset < VOLUME_CACHE_BLOCK_SIZE ? volume->size - block_offset : VOLUME_CACHE_BLOCK_SIZE;
+        size_t start = offset > block_offset ? offset : block_offset;
+        size_t end = offset + size < block_offset + block_size ? offset + size : block_offset + block_size;
+
+        volume_cache_entry_t* entry = volume_cache_find(volume, block);
+
+        if(!entry) {
+            if(end - start == block_size) {
+                // The block is overwritten completely and does not need to be read first
+                entry = volume_cache_insert(volume, block);
+
+                if(entry) {
+                    memset(entry->data + block_size, 0, VOLUME_CACHE_BLOCK_SIZE - block_size);
+                }
+            } else if(volume_read(volume, block_offset, block_size, NULL) == block_size) {
+                entry = volume_cache_find(volume, block);
+            }
+        }
+
+        if(!entry) {
+            // Write the part through if the block can not be cached
+            if(volume->device->driver->write(volume->offset + start, end - start, buffer + (start - offset)) != end - start) {
+                return start - offset;
+            }
+
+            continue;
+        }
+
+        memcpy(entry->data + (start - block_offset), buffer + (start - offset), end - start);
+        volume_cache_touch(entry);
+
+        if(!entry->dirty) {
+            entry->dirty = true;
+            volume_cache_dirty++;
+        }
+    }
+
+    // Write back in large batches once enough dirty blocks have accumulated
+    if(volume_cache_dirty * VOLUME_CACHE_BLOCK_SIZE * VOLUME_CACHE_DIRTY_RATIO > volume_cache_budget) {
+        volume_cache_flush(NULL);
+    }
+
+    return size;
+}
+
+static int32_t volume_sync(volume_t* volume) {
+    return volume_cache_flush(volume);
+}
+
+void volume_cache_set_budget(size_t budget) {
+    volume_cache_budget = budget;
+
+    while(volume_cache_lru_tail && volume_cache_blocks * VOLUME_CACHE_BLOCK_SIZE > volume_cache_budget) {
+        volume_cache_entry_t* entry = volume_cache_lru_tail;
+
+        if(entry->dirty) {
+            volume_cache_write_run(entry);
+        }
+
+        volume_cache_remove(entry);
+        kfree(entry);
+    }
+}
+
+void volume_cache_get_stats(volume_cache_stats_t* stats) {
+    stats->hits = volume_cache_hits;
+    stats->misses = volume_cache_misses;
+    stats->blocks = volume_cache_blocks;
+    stats->dirty = volume_cache_dirty;
+    stats->budget = volume_cache_budget;
+}
+
+static size_t volume_cache_hash(volume_t* volume, size_t block) {
+    return ((((uintptr_t) volume) >> 4) ^ (block * 2654435761u)) & (VOLUME_CACHE_BUCKETS - 1);
+}
+
+static volume_cache_entry_t* volume_cache_find(volume_t* volume, size_t block) {
+    volume_cache_entry_t* entry = volume_cache_buckets[volume_cache_hash(volume, block)];
+
+    while(entry && (entry->volume != volume || entry->block != block)) {
+        entry = entry->hash_next;
+    }
+
+    return entry;
+}
+
+static volume_cache_entry_t* volume_cache_insert(volume_t* volume, size_t block) {
+    volume_cache_entry_t* entry = NULL;
+
+    // Reuse the least recently used block once the budget is exhausted
+    if((volume_cache_blocks + 1) * VOLUME_CACHE_BLOCK_SIZE > volume_cache_budget) {
+        entry = volume_cache_lru_tail;
+
+        if(!entry) {
+            return NULL;
+        }
+
+        if(entry->dirty) {
+            volume_cache_write_run(entry);
+        }
+
+        volume_cache_remove(entry);
+    } else {
+        entry = (volume_cache_entry_t*) kmalloc(sizeof(volume_cache_entry_t));
+
+        if(!entry) {
+            return NULL;
+        }
+    }
+
+    size_t bucket = volume_cache_hash(volume, block);
+
+    entry->volume = volume;
+    entry->block = block;
+    entry->dirty = false;
+    entry->hash_next = volume_cache_buckets[bucket];
+    volume_cache_buckets[bucket] = entry;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = volume_cache_lru_head;
+
+    if(volume_cache_lru_head) {
+        volume_cache_lru_head->lru_prev = entry;
+    } else {
+        volume_cache_lru_tail = entry;
+    }
+
+    volume_cache_lru_head = entry;
+    volume_cache_blocks++;
+
+    return entry;
+}
+
+static void volume_cache_remove(volume_cache_entry_t* entry) {
+    volume_cache_entry_t** link = &volume_cache_buckets[volume_cache_hash(entry->volume, entry->block)];
+
+    while(*link != entry) {
+        link = &(*link)->hash_next;
+    }
+
+    *link = entry->hash_next;
+
+    if(entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        volume_cache_lru_head = entry->lru_next;
+    }
+
+    if(entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        volume_cache_lru_tail = entry->lru_prev;
+    }
+
+    volume_cache_blocks--;
+}
+
+static void volume_cache_touch(volume_cache_entry_t* entry) {
+    if(entry == volume_cache_lru_head) {
+        return;
+    }
+
+    // Unlink the entry and move it to the front of the LRU list
+    entry->lru_prev->lru_next = entry->lru_next;
+
+    if(entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        volume_cache_lru_tail = entry->lru_prev;
+    }
+
+    entry->lru_prev = NULL;
+    entry->lru_next = volume_cache_lru_head;
+    volume_cache_lru_head->lru_prev = entry;
+    volume_cache_lru_head = entry;
+}
+
+static void volume_cache_invalidate(volume_t* volume) {
+    volume_cache_entry_t* entry = volume_cache_lru_head;
+
+    while(entry) {
+        volume_cache_entry_t* next = entry->lru_next;
+
+        if(entry->volume == volume) {
+            if(entry->dirty) {
+                entry->dirty = false;
+                volume_cache_dirty--;
+            }
+
+            volume_cache_remove(entry);
+            kfree(entry);
+        }
+
+        entry = next;
+    }
+}
+
+static void volume_cache_copy(size_t block, const char* data, size_t offset, size_t size, char* buffer) {
+    // Copies the part of the block that overlaps the requested range
+    size_t block_offset = block * VOLUME_CACHE_BLOCK_SIZE;
+    size_t start = offset > block_offset ? offset : block_offset;
+    size_t end = offset + size < block_offset + VOLUME_CACHE_BLOCK_SIZE ? offset + size : block_offset + VOLUME_CACHE_BLOCK_SIZE;
+
+    memcpy(buffer + (start - offset), data + (start - block_offset), end - start);
+}
+
+/**
+ * Writes a dirty block together with the dirty blocks directly following it in a single
+ * transfer. The blocks are marked clean even if the write fails, as there is no way to
+ * recover the data later on.
+ */
+static int32_t volume_cache_write_run(volume_cache_entry_t* entry) {
+    volume_t* volume = entry->volume;
+    volume_cache_entry_t* run[VOLUME_CACHE_MAX_RUN];
+    size_t count = 1;
+
+    run[0] = entry;
+
+    while(count < VOLUME_CACHE_MAX_RUN) {
+        volume_cache_entry_t* next = volume_cache_find(volume, entry->block + count);
+
+        if(!next || !next->dirty) {
+            break;
+        }
+
+        run[count++] = next;
+    }
+
+    size_t run_offset = run[0]->block * VOLUME_CACHE_BLOCK_SIZE;
+    size_t run_size = count * VOLUME_CACHE_BLOCK_SIZE;
+
+    // The last block of the volume may be partial
+    if(run_offset + run_size > volume->size) {
+        run_size = volume->size - run_offset;
+    }
+
+    char* data = run[0]->data;
+
+    if(count > 1) {
+        data = (char*) kmalloc(count * VOLUME_CACHE_BLOCK_SIZE);
+
+        if(!data) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+        }
+
+        for(size_t index = 0; index < count; index++) {
+            memcpy(data + index * VOLUME_CACHE_BLOCK_SIZE, run[index]->data, VOLUME_CACHE_BLOCK_SIZE);
+        }
+    }
+
+    size_t written = volume->device->driver->write(volume->offset + run_offset, run_size, data);
+
+    if(count > 1) {
+        kfree(data);
+    }
+
+    for(size_t index = 0; index < count; index++) {
+        run[index]->dirty = false;
+    }
+
+    volume_cache_dirty -= count;
+
+    return written == run_size ? 0 : -1;
+}
+
+/**
+ * Writes back all dirty blocks of a volume, or of all volumes if NULL. Each pass writes the
+ * runs starting at dirty blocks whose predecessor is clean, runs longer than
+ * VOLUME_CACHE_MAX_RUN are continued by the next pass.
+ */
+static int32_t volume_cache_flush(volume_t* volume) {
+    int32_t result = 0;
+    bool written;
+
+    do {
+        written = false;
+
+        for(volume_cache_entry_t* entry = volume_cache_lru_head; entry; entry = entry->lru_next) {
+            if(!entry->dirty || (volume && entry->volume != volume)) {
+                continue;
+            }
+
+            if(entry->block > 0) {
+                volume_cache_entry_t* previous = volume_cache_find(entry->volume, entry->block - 1);
+
+                if(previous && previous->dirty) {
+                    continue;
+                }
+            }
+
+            if(volume_cache_write_run(entry) != 0) {
+                result = -1;
+            }
+
+            written = true;
+        }
+    } while(written);
+
+    return result;
 }
@@ -1,15 +1,25 @@
 #include <drivers/serial/uart/16550.h>
+#include <arch/i386/isr.h>
 #include <system/ports.h>
-#include <stdbool.h>
+#include <system/kpanic.h>
+
+static uart_16550_port_t uart_16550_ports[UART_16550_MAX_PORTS];
+static size_t uart_16550_port_count = 0;
 
 static bool uart_16550_probe(uint16_t port);
-static char* uart_16550_get_device_name(uint16_t port);
+static uart_16550_port_t* uart_16550_find_port(uint16_t port);
+static void uart_16550_interrupt_handler(isr_cpu_state_t *state);
+
+static uint32_t uart_16550_lock(void);
+static void uart_16550_unlock(uint32_t flags);
 
 static int8_t uart_16550_flushable(uint16_t port);
 static void uart_16550_write_byte(uint16_t port, uint8_t data);
+static void uart_16550_transmit(uart_16550_port_t* uart);
+static void uart_16550_drain(uart_16550_port_t* uart);
 
 static int8_t uart_16550_available(uint16_t port);
-static uint8_t uart_16550_read_byte(uint16_t port);
+static void uart_16550_receive(uart_16550_port_t* uart);
 
 int32_t uart_16550_init(uint16_t port, uint32_t baud_rate) {
     if (!uart_16550_probe(port)) {
@@ -23,9 +33,41 @@ int32_t uart_16550_init(uint16_t port, uint32_t baud_rate) {
     outb(UART_16550_DLM(port), UART_16550_BAUD_RATE_MSB(baud_rate)); // Set divisor's most significant byte for baud rate
 
     outb(UART_16550_LCR(port), 0x03); // 8 bits, no parity, one stop bit
-    outb(UART_16550_IIR(port), 0xC7); // Enable FIFO, clear them, with 14-byte threshold
+    outb(UART_16550_FCR(port), 0xC7); // Enable FIFO, clear them, with 14-byte threshold
     outb(UART_16550_MCR(port), 0x0B); // IRQs enabled, RTS/DSR set
 
+    uart_16550_port_t* uart = uart_16550_find_port(port);
+
+    if(!uart) {
+        if(uart_16550_port_count == UART_16550_MAX_PORTS) {
+            return -1;
+        }
+
+        uart = &uart_16550_ports[uart_16550_port_count];
+
+        uart->port = port;
+        uart->transmit = spsc_ring_create(UART_16550_BUFFER_SIZE, sizeof(uint8_t));
+        uart->receive = spsc_ring_create(UART_16550_BUFFER_SIZE, sizeof(uint8_t));
+
+        if(!uart->transmit || !uart->receive) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+        }
+
+        uart_16550_port_count++;
+    }
+
+    uart->transmitting = false;
+    uart->interrupts = UART_16550_IER_RECEIVED_DATA;
+
+    // COM1 and COM3 share IRQ 4, COM2 and COM4 share IRQ 3
+    if(port == UART_16550_COM1 || port == UART_16550_COM3) {
+        isr_register_listener(COM1_INTERRUPT, uart_16550_interrupt_handler);
+    } else {
+        isr_register_listener(COM2_INTERRUPT, uart_16550_interrupt_handler);
+    }
+
+    outb(UART_16550_IER(port), uart->interrupts);
+
     return 0;
 }
 
@@ -42,8 +84,75 @@ static bool uart_16550_probe(uint16_t port) {
     return true;
 }
 
+static uart_16550_port_t* uart_16550_find_port(uint16_t port) {
+    for(size_t index = 0; index < uart_16550_port_count; index++) {
+        if(uart_16550_ports[index].port == port) {
+            return &uart_16550_ports[index];
+        }
+    }
+
+    return NULL;
+}
+
+static void uart_16550_interrupt_handler(isr_cpu_state_t *state) {
+    (void) state;
+
+    // The IRQ line is shared, so every initialized port is asked for pending interrupts
+    for(size_t index = 0; index < uart_16550_port_count; index++) {
+        uart_16550_port_t* uart = &uart_16550_ports[index];
+        uint8_t identification;
+
+        while(!((identification = inb(UART_16550_IIR(uart->port))) & UART_16550_IIR_NO_INTERRUPT)) {
+            switch(identification & UART_16550_IIR_ID_MASK) {
+                case UART_16550_IIR_RECEIVED_DATA:
+                case UART_16550_IIR_CHARACTER_TIMEOUT:
+                    uart_16550_receive(uart);
+                    break;
+                case UART_16550_IIR_TRANSMITTER_EMPTY:
+                    uart_16550_transmit(uart);
+                    break;
+                case UART_16550_IIR_LINE_STATUS:
+                    inb(UART_16550_LSR(uart->port));
+                    break;
+                default:
+                    inb(UART_16550_MSR(uart->port));
+                    break;
+            }
+        }
+    }
+}
+
+/*
+ * Besides the interrupt handler, writers consume from the transmit ring to start
+ * the transmitter or to make room, and readers produce into the receive ring to pick
+ * up bytes early. A port also has several writers, e.g. the kernel log, which may be
+ * written from interrupt context, and the terminal mirror. They all disable interrupts
+ * while touching a ring, so each ring still has a single producer and consumer at a
+ * time. The previous interrupt flag is restored on unlock, which keeps the driver
+ * usable before interrupts are enabled at boot.
+ */
+
+static uint32_t uart_16550_lock(void) {
+    uint32_t flags;
+
+    __asm__ volatile("pushfl\n"
+                     "pop %0\n"
+                     "cli"
+                     : "=r" (flags)
+                     :
+                     : "memory");
+
+    return flags;
+}
+
+static void uart_16550_unlock(uint32_t flags) {
+    if(flags & 0x200) {
+        __asm__ volatile("sti" ::: "memory");
+    }
+}
+
 static int8_t uart_16550_flushable(uint16_t port) {
-    return inb(UART_16550_LSR(port)) & 0x20;
+    return inb(UART_16550_LSR(port)) & UART_16550_LSR_TRANSMITTER_EMPTY;
 }
 
 static void uart_16550_write_byte(uint16_t port, uint8_t data) {
@@ -51,27 +160,117 @@ static void uart_16550_write_byte(uint16_t port, uint8_t data) {
     outb(port, data);
 }
 
+static void uart_16550_transmit(uart_16550_port_t* uart) {
+    if(spsc_ring_empty(uart->transmit)) {
+        // Nothing left to send, stop the transmitter empty interrupt until the next write
+        uart->transmitting = false;
+        uart->interrupts &= ~UART_16550_IER_TRANSMITTER_EMPTY;
+        outb(UART_16550_IER(uart->port), uart->interrupts);
+        return;
+    }
+
+    // The transmitter holding register being empty means the whole FIFO is free
+    if(uart_16550_flushable(uart->port)) {
+        uint8_t data[UART_16550_FIFO_SIZE];
+        size_t count = spsc_ring_dequeue_bulk(uart->transmit, data, UART_16550_FIFO_SIZE);
+
+        for(size_t index = 0; index < count; index++) {
+            outb(UART_16550_THR(uart->port), data[index]);
+        }
+    }
+
+    // Otherwise the interrupt fires once the bytes still in the FIFO are sent
+    if(!uart->transmitting) {
+        uart->transmitting = true;
+        uart->interrupts |= UART_16550_IER_TRANSMITTER_EMPTY;
+        outb(UART_16550_IER(uart->port), uart->interrupts);
+    }
+}
+
+static void uart_16550_drain(uart_16550_port_t* uart) {
+    // Wait for the FIFO to run empty and refill it, as the interrupt would
+    while (!uart_16550_flushable(uart->port));
+    uart_16550_transmit(uart);
+}
+
 void uart_16550_write(uint16_t port, const void* data, size_t size) {
     const uint8_t* data_ptr = (const uint8_t *) data;
+    uart_16550_port_t* uart = uart_16550_find_port(port);
+
+    if(!uart) {
+        for (size_t index = 0; index < size; index++) {
+            uart_16550_write_byte(port, data_ptr[index]);
+        }
+
+        return;
+    }
+
+    while(size > 0) {
+        uint32_t flags = uart_16550_lock();
+        size_t count = spsc_ring_enqueue_bulk(uart->transmit, data_ptr, size);
+
+        data_ptr += count;
+        size -= count;
 
-    for (size_t index = 0; index < size; index++) {
-        uart_16550_write_byte(port, data_ptr[index]);
+        // Make room if the ring is full, otherwise start the transmitter if it is idle
+        if(size > 0) {
+            uart_16550_drain(uart);
+        } else if(!uart->transmitting) {
+            uart_16550_transmit(uart);
+        }
+
+        uart_16550_unlock(flags);
+    }
+}
+
+void uart_16550_flush(uint16_t port) {
+    uart_16550_port_t* uart = uart_16550_find_port(port);
+
+    if(uart) {
+        uint32_t flags = uart_16550_lock();
+
+        while(!spsc_ring_empty(uart->transmit)) {
+            uart_16550_drain(uart);
+        }
+
+        uart_16550_unlock(flags);
     }
+
+    while(!(inb(UART_16550_LSR(port)) & UART_16550_LSR_TRANSMITTER_IDLE));
 }
 
 static int8_t uart_16550_available(uint16_t port) {
-    return inb(UART_16550_LSR(port)) & 0x01;
+    return inb(UART_16550_LSR(port)) & UART_16550_LSR_DATA_READY;
 }
 
-static uint8_t uart_16550_read_byte(uint16_t port) {
-    while (!uart_16550_available(port));
-    return inb(port);
+static void uart_16550_receive(uart_16550_port_t* uart) {
+    while(uart_16550_available(uart->port)) {
+        uint8_t data = inb(UART_16550_RBR(uart->port));
+
+        // Drop the byte if the reader does not keep up instead of losing older input
+        spsc_ring_put_byte(uart->receive, data);
+    }
 }
 
-void uart_16550_read(uint16_t port, void* buffer, size_t size) {
+size_t uart_16550_read(uint16_t port, void* buffer, size_t size) {
     uint8_t* buffer_ptr = (uint8_t *) buffer;
+    uart_16550_port_t* uart = uart_16550_find_port(port);
+    size_t count = 0;
 
-    for (size_t index = 0; index < size; index++) {
-        buffer_ptr[index] = uart_16550_read_byte(port);
+    if(!uart) {
+        while (count < size && uart_16550_available(port)) {
+            buffer_ptr[count++] = inb(port);
+        }
+
+        return count;
     }
+
+    uint32_t flags = uart_16550_lock();
+
+    // Pick up bytes still below the FIFO trigger level that have not timed out yet
+    uart_16550_receive(uart);
+
+    uart_16550_unlock(flags);
+
+    return spsc_ring_dequeue_bulk(uart->receive, buffer_ptr, size);
 }
@@ -0,0 +1,133 @@
+#include <drivers/video/bga/bga.h>
+#include <io/font.h>
+#include <util/string.h>
+
+extern uint32_t* bga_back_buffer;
+extern uint32_t bga_width;
+extern uint32_t bga_height;
+
+static bool bga_rect_in_bounds(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+int32_t bga_gfx_set_pixel(uint32_t x, uint32_t y, uint32_t color) {
+    if(x >= bga_width || y >= bga_height) {
+        return -1;
+    }
+
+    bga_back_buffer[y * bga_width + x] = color;
+    bga_mark_dirty(x, y, 1, 1);
+
+    return 0;
+}
+
+int32_t bga_gfx_fill(uint32_t color) {
+    // Rows are contiguous, so the whole buffer is filled at once
+    memsetl(bga_back_buffer, color, bga_width * bga_height);
+    bga_mark_dirty(0, 0, bga_width, bga_height);
+
+    return 0;
+}
+
+int32_t bga_gfx_draw_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t color) {
+    if(!bga_rect_in_bounds(x, y, width, height)) {
+        return -1;
+    }
+
+    uint32_t* row = bga_back_buffer + y * bga_width + x;
+
+    for(uint32_t index = 0; index < height; index++) {
+        memsetl(row, color, width);
+        row += bga_width;
+    }
+
+    bga_mark_dirty(x, y, width, height);
+
+    return 0;
+}
+
+int32_t bga_gfx_blit(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint32_t* pixels) {
+    if(!bga_rect_in_bounds(x, y, width, height)) {
+        return -1;
+    }
+
+    uint32_t* row = bga_back_buffer + y * bga_width + x;
+
+    for(uint32_t index = 0; index < height; index++) {
+        memcpy(row, pixels, width * sizeof(uint32_t));
+        row += bga_width;
+        pixels += width;
+    }
+
+    bga_mark_dirty(x, y, width, height);
+
+    return 0;
+}
+
+int32_t bga_gfx_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width, uint32_t height) {
+    if(!bga_rect_in_bounds(src_x, src_y, width, height) || !bga_rect_in_bounds(dst_x, dst_y, width, height)) {
+        return -1;
+    }
+
+    if(height == 0) {
+        return 0;
+    }
+
+    // Copy the rows in the order that does not overwrite rows not yet copied
+    if(dst_y <= src_y) {
+        for(uint32_t index = 0; index < height; index++) {
+            memmove(bga_back_buffer + (dst_y + index) * bga_width + dst_x, bga_back_buffer + (src_y + index) * bga_width + src_x, width * sizeof(uint32_t));
+        }
+    } else {
+        for(uint32_t index = height; index > 0; index--) {
+            memmove(bga_back_buffer + (dst_y + index - 1) * bga_width + dst_x, bga_back_buffer + (src_y + index - 1) * bga_width + src_x, width * sizeof(uint32_t));
+        }
+    }
+
+    bga_mark_dirty(dst_x, dst_y, width, height);
+
+    return 0;
+}
+
+int32_t bga_gfx_draw_char(uint32_t x, uint32_t y, char c, uint32_t color) {
+    const font_t* font = font_get_default();
+
+    if(!font || !bga_rect_in_bounds(x, y, font->width, font->height)) {
+        return -1;
+    }
+
+    const uint8_t* rows = font->bitmap + (uint8_t) c * font->height;
+    uint32_t* row = bga_back_buffer + y * bga_width + x;
+
+    // Only the set bits are drawn, the background is left as it is
+    for(uint32_t index = 0; index < font->height; index++) {
+        for(uint32_t bit = 0; bit < font->width; bit++) {
+            if(rows[index] & (0x80 >> bit)) {
+                row[bit] = color;
+            }
+        }
+
+        row += bga_width;
+    }
+
+    bga_mark_dirty(x, y, font->width, font->height);
+
+    return 0;
+}
+
+int32_t bga_gfx_draw_string(uint32_t x, uint32_t y, const char* str, uint32_t color) {
+    uint32_t index = 0;
+
+    while(str[index] != '\0') {
+        if(bga_gfx_draw_char(x, y, str[index], color) != 0) {
+            return -1;
+        }
+
+        x += 8;
+        index++;
+    }
+
+    return 0;
+}
+
+static bool bga_rect_in_bounds(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    return x <= bga_width && y <= bga_height && width <= bga_width - x && height <= bga_height - y;
+}
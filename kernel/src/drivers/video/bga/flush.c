@@ -0,0 +1,76 @@
+#include <drivers/video/bga/bga.h>
+#include <util/string.h>
+
+extern uint32_t* bga_framebuffer;
+extern uint32_t* bga_back_buffer;
+extern uint32_t bga_width;
+extern uint32_t bga_height;
+
+static bga_rect_t bga_dirty_rects[BGA_MAX_DIRTY_RECTS];
+static size_t bga_dirty_rect_count = 0;
+
+static bool bga_rect_touches(const bga_rect_t* rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+static void bga_rect_union(bga_rect_t* rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+void bga_mark_dirty(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    if(width == 0 || height == 0) {
+        return;
+    }
+
+    // Extend a region that overlaps or borders the new one
+    for(size_t index = 0; index < bga_dirty_rect_count; index++) {
+        if(bga_rect_touches(&bga_dirty_rects[index], x, y, width, height)) {
+            bga_rect_union(&bga_dirty_rects[index], x, y, width, height);
+            return;
+        }
+    }
+
+    // Collapse all regions into their bounding box if there is no room left
+    if(bga_dirty_rect_count == BGA_MAX_DIRTY_RECTS) {
+        for(size_t index = 1; index < bga_dirty_rect_count; index++) {
+            bga_rect_t* rect = &bga_dirty_rects[index];
+            bga_rect_union(&bga_dirty_rects[0], rect->x, rect->y, rect->width, rect->height);
+        }
+
+        bga_rect_union(&bga_dirty_rects[0], x, y, width, height);
+        bga_dirty_rect_count = 1;
+        return;
+    }
+
+    bga_rect_t* rect = &bga_dirty_rects[bga_dirty_rect_count++];
+
+    rect->x = x;
+    rect->y = y;
+    rect->width = width;
+    rect->height = height;
+}
+
+int32_t bga_gfx_flush() {
+    for(size_t index = 0; index < bga_dirty_rect_count; index++) {
+        bga_rect_t* rect = &bga_dirty_rects[index];
+        size_t offset = rect->y * bga_width + rect->x;
+
+        for(uint32_t row = 0; row < rect->height; row++) {
+            memcpy(bga_framebuffer + offset, bga_back_buffer + offset, rect->width * sizeof(uint32_t));
+            offset += bga_width;
+        }
+    }
+
+    bga_dirty_rect_count = 0;
+
+    return 0;
+}
+
+static bool bga_rect_touches(const bga_rect_t* rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    return x <= rect->x + rect->width && rect->x <= x + width && y <= rect->y + rect->height && rect->y <= y + height;
+}
+
+static void bga_rect_union(bga_rect_t* rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    uint32_t right = rect->x + rect->width > x + width ? rect->x + rect->width : x + width;
+    uint32_t bottom = rect->y + rect->height > y + height ? rect->y + rect->height : y + height;
+
+    rect->x = rect->x < x ? rect->x : x;
+    rect->y = rect->y < y ? rect->y : y;
+    rect->width = right - rect->x;
+    rect->height = bottom - rect->y;
+}
@@ -0,0 +1,175 @@
+#include <drivers/video/bga/bga.h>
+#include <drivers/pci/pci.h>
+#include <device/device.h>
+#include <device/video.h>
+#include <memory/kheap.h>
+#include <memory/vmm.h>
+#include <system/kpanic.h>
+#include <system/kmessage.h>
+#include <util/string.h>
+
+uint32_t* bga_framebuffer = NULL;
+uint32_t* bga_back_buffer = NULL;
+uint32_t bga_width = 0;
+uint32_t bga_height = 0;
+
+static pci_device_t* bga_find_pci_device(device_t** parent);
+static void bga_write_register(uint16_t index, uint16_t value);
+static uint16_t bga_read_register(uint16_t index);
+static bool bga_tm_probe(void);
+static bool bga_gfx_probe(void);
+
+int32_t bga_init(uint32_t width, uint32_t height) {
+    device_t* pci_parent = NULL;
+    pci_device_t* pci_device = bga_find_pci_device(&pci_parent);
+
+    if(!pci_device) {
+        return -1;
+    }
+
+    uint16_t id = bga_read_register(BGA_DISPI_INDEX_ID);
+
+    if(id < BGA_DISPI_ID_MIN || id > BGA_DISPI_ID_MAX) {
+        return -1;
+    }
+
+    if(pci_load_bar_info(pci_device, 0) != 0 || pci_device->data.general.bar[0].type != PCI_BAR_MEMORY_SPACE) {
+        return -1;
+    }
+
+    size_t framebuffer_size = width * height * sizeof(uint32_t);
+
+    if(framebuffer_size > pci_device->data.general.bar[0].size) {
+        return -1;
+    }
+
+    // Switch the mode, the registers are only applied while the adapter is disabled
+    bga_write_register(BGA_DISPI_INDEX_ENABLE, BGA_DISPI_DISABLED);
+    bga_write_register(BGA_DISPI_INDEX_XRES, width);
+    bga_write_register(BGA_DISPI_INDEX_YRES, height);
+    bga_write_register(BGA_DISPI_INDEX_BPP, BGA_BPP);
+    bga_write_register(BGA_DISPI_INDEX_VIRT_WIDTH, width);
+    bga_write_register(BGA_DISPI_INDEX_X_OFFSET, 0);
+    bga_write_register(BGA_DISPI_INDEX_Y_OFFSET, 0);
+    bga_write_register(BGA_DISPI_INDEX_ENABLE, BGA_DISPI_ENABLED | BGA_DISPI_LFB_ENABLED);
+
+    if(bga_read_register(BGA_DISPI_INDEX_XRES) != width || bga_read_register(BGA_DISPI_INDEX_YRES) != height) {
+        bga_write_register(BGA_DISPI_INDEX_ENABLE, BGA_DISPI_DISABLED);
+        return -1;
+    }
+
+    uint32_t framebuffer_physical = pci_device->data.general.bar[0].base_address & ~0xF;
+
+    bga_framebuffer = (uint32_t*) vmm_map_memory(NULL, framebuffer_size, (void*) framebuffer_physical, true, true);
+
+    if(!bga_framebuffer) {
+        bga_write_register(BGA_DISPI_INDEX_ENABLE, BGA_DISPI_DISABLED);
+        return -1;
+    }
+
+    // The back buffer is too large for the kernel heap, so it gets its own pages
+    bga_back_buffer = (uint32_t*) vmm_map_memory(NULL, framebuffer_size, NULL, true, true);
+
+    if(!bga_back_buffer) {
+        vmm_unmap_memory(bga_framebuffer, framebuffer_size);
+        bga_framebuffer = NULL;
+        bga_write_register(BGA_DISPI_INDEX_ENABLE, BGA_DISPI_DISABLED);
+        return -1;
+    }
+
+    bga_width = width;
+    bga_height = height;
+
+    video_device_t *device = (video_device_t*) kmalloc(sizeof(video_device_t));
+
+    if(!device) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    device->info.name = (char*) kmalloc(24);
+
+    if(!device->info.name) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    device_generate_id(device->info.id);
+    strcpy(device->info.name, "Bochs Graphics Adapter");
+    device->info.type = DEVICE_TYPE_VIDEO;
+    device->info.bus.type = DEVICE_BUS_TYPE_PCI;
+    device->info.bus.data = pci_device;
+
+    device->driver = (video_driver_t*) kmalloc(sizeof(video_driver_t));
+
+    if(!device->driver) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    device->driver->tm_probe = bga_tm_probe;
+    device->driver->gfx_probe = bga_gfx_probe;
+    device->driver->gfx.set_pixel = bga_gfx_set_pixel;
+    device->driver->gfx.fill = bga_gfx_fill;
+    device->driver->gfx.draw_rect = bga_gfx_draw_rect;
+    device->driver->gfx.draw_char = bga_gfx_draw_char;
+    device->driver->gfx.draw_string = bga_gfx_draw_string;
+    device->driver->gfx.total_width = bga_gfx_total_width;
+    device->driver->gfx.total_height = bga_gfx_total_height;
+    device->driver->gfx.blit = bga_gfx_blit;
+    device->driver->gfx.copy_rect = bga_gfx_copy_rect;
+    device->driver->gfx.flush = bga_gfx_flush;
+
+    bga_gfx_fill(BGA_COLOR(0, 0, 0));
+    bga_gfx_flush();
+
+    device_register(pci_parent, (device_t*) device);
+
+    char* kernel_message = (char*) kmalloc(64);
+
+    if(!kernel_message) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    strfmt(kernel_message, "bga: Linear framebuffer %dx%dx%d at %p", width, height, BGA_BPP, framebuffer_physical);
+
+    kmessage(KMESSAGE_LEVEL_INFO, kernel_message);
+
+    return 0;
+}
+
+static pci_device_t* bga_find_pci_device(device_t** parent) {
+    pci_device_t* result = NULL;
+    const linked_list_t* devices = device_find_all_by_bus_type(DEVICE_BUS_TYPE_PCI);
+
+    linked_list_foreach(devices, node) {
+        device_t* device = (device_t*) node->data;
+        pci_device_t* pci_device = (pci_device_t*) device->bus.data;
+
+        if(pci_device->vendor_id == BGA_PCI_VENDOR_ID && pci_device->device_id == BGA_PCI_DEVICE_ID) {
+            *parent = device;
+            result = pci_device;
+            break;
+        }
+    }
+
+    // The list is created for the caller, only the devices in it are shared
+    linked_list_destroy((linked_list_t*) devices, false);
+
+    return result;
+}
+
+static void bga_write_register(uint16_t index, uint16_t value) {
+    outw(BGA_DISPI_INDEX_PORT, index);
+    outw(BGA_DISPI_DATA_PORT, value);
+}
+
+static uint16_t bga_read_register(uint16_t index) {
+    outw(BGA_DISPI_INDEX_PORT, index);
+    return inw(BGA_DISPI_DATA_PORT);
+}
+
+static bool bga_tm_probe(void) {
+    return false;
+}
+
+static bool bga_gfx_probe(void) {
+    return bga_framebuffer != NULL;
+}
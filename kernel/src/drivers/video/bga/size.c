@@ -0,0 +1,12 @@
+#include <drivers/video/bga/bga.h>
+
+extern uint32_t bga_width;
+extern uint32_t bga_height;
+
+size_t bga_gfx_total_width() {
+    return bga_width;
+}
+
+size_t bga_gfx_total_height() {
+    return bga_height;
+}
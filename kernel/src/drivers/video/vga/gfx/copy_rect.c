@@ -0,0 +1,68 @@
+#include <drivers/video/vga/gfx.h>
+#include <util/string.h>
+
+extern uint8_t *const vga_gfx_video_memory;
+
+extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+
+static void vga_gfx_12h_copy_row_latched(volatile uint8_t* destination, volatile uint8_t* source, size_t count);
+static void vga_gfx_copy_row_pixels(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width);
+
+int32_t vga_gfx_copy_rect(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width, uint32_t height) {
+    const uint32_t WIDTH = vga_current_video_mode->width;
+    const uint32_t HEIGHT = vga_current_video_mode->height;
+
+    if(src_x + width > WIDTH || src_y + height > HEIGHT || dst_x + width > WIDTH || dst_y + height > HEIGHT) {
+        return -1;
+    }
+
+    bool aligned = ((src_x | dst_x | width) & 0x07) == 0;
+    size_t pitch = WIDTH / 8;
+
+    if(vga_current_video_mode->mode == VGA_640X480X16_GFX && aligned) {
+        // Reading a byte loads all planes into the latches, write mode 1 stores them again
+        vga_set_write_mode(0x01);
+    }
+
+    // Copy the rows in the order that does not overwrite rows not yet copied
+    for(uint32_t index = 0; index < height; index++) {
+        uint32_t row = dst_y <= src_y ? index : height - index - 1;
+
+        if(vga_current_video_mode->mode != VGA_640X480X16_GFX) {
+            memmove(vga_gfx_video_memory + (dst_y + row) * WIDTH + dst_x, vga_gfx_video_memory + (src_y + row) * WIDTH + src_x, width);
+        } else if(aligned) {
+            vga_gfx_12h_copy_row_latched(vga_gfx_video_memory + (dst_y + row) * pitch + dst_x / 8, vga_gfx_video_memory + (src_y + row) * pitch + src_x / 8, width / 8);
+        } else {
+            vga_gfx_copy_row_pixels(src_x, src_y + row, dst_x, dst_y + row, width);
+        }
+    }
+
+    if(vga_current_video_mode->mode == VGA_640X480X16_GFX && aligned) {
+        vga_set_write_mode(0x02);
+    }
+
+    return 0;
+}
+
+static void vga_gfx_12h_copy_row_latched(volatile uint8_t* destination, volatile uint8_t* source, size_t count) {
+    if(destination <= source) {
+        for(size_t index = 0; index < count; index++) {
+            uint8_t latch = source[index];
+            destination[index] = latch;
+        }
+    } else {
+        for(size_t index = count; index > 0; index--) {
+            uint8_t latch = source[index - 1];
+            destination[index - 1] = latch;
+        }
+    }
+}
+
+static void vga_gfx_copy_row_pixels(uint32_t src_x, uint32_t src_y, uint32_t dst_x, uint32_t dst_y, uint32_t width) {
+    // Unaligned pixels are copied one by one, in the order that keeps overlapping sources intact
+    for(uint32_t index = 0; index < width; index++) {
+        uint32_t column = dst_x <= src_x ? index : width - index - 1;
+
+        vga_gfx_set_pixel(dst_x + column, dst_y, vga_gfx_get_pixel(src_x + column, src_y));
+    }
+}
@@ -1,7 +1,67 @@
 #include <drivers/video/vga/gfx.h>
+#include <io/font.h>
 
 extern uint8_t *const vga_gfx_video_memory;
 
+extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+
+static void vga_gfx_12h_draw_char(const font_t* font, uint32_t x, uint32_t y, const uint8_t* rows, uint32_t color);
+
 int32_t vga_gfx_draw_char(uint32_t x, uint32_t y, char c, uint32_t color) {
-    return -1;
+    const font_t* font = font_get_default();
+
+    if(!font || x + font->width > vga_current_video_mode->width || y + font->height > vga_current_video_mode->height) {
+        return -1;
+    }
+
+    const uint8_t* rows = font->bitmap + (uint8_t) c * font->height;
+
+    if(vga_current_video_mode->mode == VGA_640X480X16_GFX) {
+        vga_gfx_12h_draw_char(font, x, y, rows, color);
+        return 0;
+    }
+
+    // Only the set bits are drawn, the background is left as it is
+    for(uint32_t index = 0; index < font->height; index++) {
+        uint8_t* row = vga_gfx_video_memory + (y + index) * vga_current_video_mode->width + x;
+
+        for(uint32_t bit = 0; bit < font->width; bit++) {
+            if(rows[index] & (0x80 >> bit)) {
+                row[bit] = color;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void vga_gfx_12h_draw_char(const font_t* font, uint32_t x, uint32_t y, const uint8_t* rows, uint32_t color) {
+    size_t pitch = vga_current_video_mode->width / 8;
+    uint32_t shift = x & 0x07;
+    uint8_t width_mask = 0xFF << (8 - font->width);
+
+    /*
+     * In write mode 3 the set/reset color is written to all planes and the CPU
+     * data acts as additional bit mask, so a glyph row is drawn by writing its
+     * bits. Glyphs that are not byte aligned span two bytes.
+     */
+    vga_set_write_mode(0x03);
+    vga_set_set_reset(color);
+    vga_set_bit_mask(0xFF);
+
+    for(uint32_t index = 0; index < font->height; index++) {
+        volatile uint8_t* destination = vga_gfx_video_memory + (y + index) * pitch + (x >> 3);
+        uint8_t bits = rows[index] & width_mask;
+
+        (void) destination[0];
+        destination[0] = bits >> shift;
+
+        if(shift) {
+            (void) destination[1];
+            destination[1] = bits << (8 - shift);
+        }
+    }
+
+    vga_set_write_mode(0x02);
+    vga_set_set_reset(0x00);
 }
@@ -1,15 +1,77 @@
 #include <drivers/video/vga/gfx.h>
+#include <util/string.h>
 
 extern uint8_t *const vga_gfx_video_memory;
 
 extern const vga_video_mode_descriptor_t* vga_current_video_mode;
 
+static void vga_gfx_12h_fill_span(uint32_t x, uint32_t y, uint32_t width, uint32_t color);
+
 int32_t vga_gfx_fill(uint32_t color) {
-    for(size_t y = 0; y < vga_current_video_mode->height; ++y) {
-        for(size_t x = 0; x < vga_current_video_mode->width; ++x) {
-            vga_gfx_set_pixel(x, y, color);
-        }
+    if(vga_current_video_mode->mode == VGA_640X480X16_GFX) {
+        // Each byte covers 8 pixels of all planes in write mode 2
+        size_t pitch = vga_current_video_mode->width / 8;
+
+        vga_set_bit_mask(0xFF);
+        memset(vga_gfx_video_memory, color, pitch * vga_current_video_mode->height);
+
+        return 0;
     }
 
+    memset(vga_gfx_video_memory, color, vga_current_video_mode->width * vga_current_video_mode->height);
+
     return 0;
 }
+
+int32_t vga_gfx_fill_span(uint32_t x, uint32_t y, uint32_t width, uint32_t color) {
+    if(x > vga_current_video_mode->width || width > vga_current_video_mode->width - x || y >= vga_current_video_mode->height) {
+        return -1;
+    }
+
+    if(width == 0) {
+        return 0;
+    }
+
+    if(vga_current_video_mode->mode == VGA_640X480X16_GFX) {
+        vga_gfx_12h_fill_span(x, y, width, color);
+        return 0;
+    }
+
+    memset(vga_gfx_video_memory + y * vga_current_video_mode->width + x, color, width);
+
+    return 0;
+}
+
+static void vga_gfx_12h_fill_span(uint32_t x, uint32_t y, uint32_t width, uint32_t color) {
+    size_t pitch = vga_current_video_mode->width / 8;
+    volatile uint8_t* row = vga_gfx_video_memory + y * pitch;
+
+    uint32_t first = x >> 3;
+    uint32_t last = (x + width - 1) >> 3;
+    uint8_t left_mask = 0xFF >> (x & 0x07);
+    uint8_t right_mask = 0xFF << (7 - ((x + width - 1) & 0x07));
+
+    /*
+     * Partial bytes need the other pixels from the latches, so they are read
+     * before the write. Whole bytes are written without reading.
+     */
+    if(first == last) {
+        vga_set_bit_mask(left_mask & right_mask);
+        (void) row[first];
+        row[first] = color;
+        return;
+    }
+
+    vga_set_bit_mask(left_mask);
+    (void) row[first];
+    row[first] = color;
+
+    if(last > first + 1) {
+        vga_set_bit_mask(0xFF);
+        memset((uint8_t*) row + first + 1, color, last - first - 1);
+    }
+
+    vga_set_bit_mask(right_mask);
+    (void) row[last];
+    row[last] = color;
+}
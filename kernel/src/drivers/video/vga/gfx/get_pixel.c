@@ -0,0 +1,33 @@
+#include <drivers/video/vga/gfx.h>
+
+extern uint8_t *const vga_gfx_video_memory;
+
+extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+
+uint32_t vga_gfx_get_pixel(uint32_t x, uint32_t y) {
+    if(x >= vga_current_video_mode->width || y >= vga_current_video_mode->height) {
+        return 0;
+    }
+
+    if(vga_current_video_mode->mode != VGA_640X480X16_GFX) {
+        return vga_gfx_video_memory[y * vga_current_video_mode->width + x];
+    }
+
+    // Collect the bit of the pixel from each plane
+    size_t pitch = vga_current_video_mode->width / 8;
+    volatile uint8_t* source = vga_gfx_video_memory + (y * pitch) + (x >> 3);
+    uint8_t bit = 0x80 >> (x & 0x07);
+    uint32_t color = 0;
+
+    for(uint8_t plane = 0; plane < 4; plane++) {
+        vga_set_read_plane(plane);
+
+        if(*source & bit) {
+            color |= 1 << plane;
+        }
+    }
+
+    vga_set_read_plane(0);
+
+    return color;
+}
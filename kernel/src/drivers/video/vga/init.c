@@ -6,6 +6,7 @@
 #include <system/kpanic.h>
 
 uint16_t *const vga_tm_video_memory = (uint16_t *const) VGA_TM_VIDEO_MEMORY;
+size_t vga_tm_start_cell = 0;
 uint8_t *const vga_gfx_video_memory = (uint8_t *const) VGA_GFX_VIDEO_MEMORY;
 
 const vga_video_mode_descriptor_t* vga_current_video_mode = NULL;
@@ -35,6 +36,9 @@ int32_t vga_init(vga_video_mode_t mode, bool probe) {
     vga_init_registers(descriptor->config);
     vga_current_video_mode = descriptor;
 
+    // The register configuration displays the text mode buffer from its start
+    vga_tm_start_cell = 0;
+
     if(probe) {
         video_device_t *device = (video_device_t*) kmalloc(sizeof(video_device_t));
 
@@ -66,6 +70,7 @@ int32_t vga_init(vga_video_mode_t mode, bool probe) {
             device->driver->tm.fill = vga_tm_fill;
             device->driver->tm.write = vga_tm_write;
             device->driver->tm.strwrite = vga_tm_strwrite;
+            device->driver->tm.blit = vga_tm_blit;
             device->driver->tm.scroll = vga_tm_scroll;
             device->driver->tm.move_cursor = vga_tm_move_cursor;
             device->driver->tm.enable_cursor = vga_tm_enable_cursor;
@@ -90,6 +95,9 @@ int32_t vga_init(vga_video_mode_t mode, bool probe) {
             device->driver->gfx.draw_string = vga_gfx_draw_string;
             device->driver->gfx.total_width = vga_gfx_total_width;
             device->driver->gfx.total_height = vga_gfx_total_height;
+            device->driver->gfx.blit = NULL;
+            device->driver->gfx.copy_rect = vga_gfx_copy_rect;
+            device->driver->gfx.flush = NULL;
 
             vga_gfx_init();
         } else if (mode == VGA_320X200X256_GFX) {
@@ -108,6 +116,9 @@ int32_t vga_init(vga_video_mode_t mode, bool probe) {
             device->driver->gfx.draw_string = vga_gfx_draw_string;
             device->driver->gfx.total_width = vga_gfx_total_width;
             device->driver->gfx.total_height = vga_gfx_total_height;
+            device->driver->gfx.blit = NULL;
+            device->driver->gfx.copy_rect = vga_gfx_copy_rect;
+            device->driver->gfx.flush = NULL;
 
             vga_gfx_init();
         }
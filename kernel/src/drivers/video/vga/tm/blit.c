@@ -0,0 +1,18 @@
+#include <drivers/video/vga/tm.h>
+
+extern uint16_t *const vga_tm_video_memory;
+extern size_t vga_tm_start_cell;
+
+extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+
+int32_t vga_tm_blit(size_t cell, const uint16_t* cells, size_t count) {
+    const size_t TOTAL_CELLS = vga_current_video_mode->width * vga_current_video_mode->height;
+
+    if(cell >= TOTAL_CELLS || count > TOTAL_CELLS - cell) {
+        return -1;
+    }
+
+    memcpy(vga_tm_video_memory + vga_tm_start_cell + cell, cells, count * sizeof(uint16_t));
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include <drivers/video/vga/tm.h>
 
 extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+extern size_t vga_tm_start_cell;
+
+// Cursor position relative to the displayed screen, kept across scrolls
+size_t vga_tm_cursor_cell = 0;
 
 void vga_tm_enable_cursor(uint8_t start, uint8_t end) {
 	outb(VGA_CRTC_ADDRESS_REGISTER_PORT, VGA_CRTC_CURSOR_START_REGISTER);
@@ -22,11 +26,16 @@ int32_t vga_tm_move_cursor(size_t cell) {
 		return -1;
 	}
 
+	vga_tm_cursor_cell = cell;
+
+	// The cursor location is an offset into the text mode buffer, not the screen
+	size_t location = vga_tm_start_cell + cell;
+
     outb(VGA_CRTC_ADDRESS_REGISTER_PORT, VGA_CRTC_CURSOR_LOCATION_HIGH_REGISTER);
-	outb(VGA_CRTC_DATA_REGISTER_PORT, cell >> 8);
+	outb(VGA_CRTC_DATA_REGISTER_PORT, location >> 8);
 
 	outb(VGA_CRTC_ADDRESS_REGISTER_PORT, VGA_CRTC_CURSOR_LOCATION_LOW_REGISTER);
-	outb(VGA_CRTC_DATA_REGISTER_PORT, cell & 0xFF);
+	outb(VGA_CRTC_DATA_REGISTER_PORT, location & 0xFF);
 
 	return 0;
 }
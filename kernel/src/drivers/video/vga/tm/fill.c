@@ -1,6 +1,8 @@
 #include <drivers/video/vga/tm.h>
+#include <util/string.h>
 
 extern uint16_t *const vga_tm_video_memory;
+extern size_t vga_tm_start_cell;
 
 extern const vga_video_mode_descriptor_t* vga_current_video_mode;
 
@@ -9,7 +11,5 @@ void vga_tm_fill(uint8_t bgcolor) {
 
     const size_t TOTAL_CELLS = vga_current_video_mode->width * vga_current_video_mode->height;
 
-    for(size_t cell = 0; cell < TOTAL_CELLS; ++cell) {
-        vga_tm_video_memory[cell] = entry;
-    }
+    memsetw(vga_tm_video_memory + vga_tm_start_cell, entry, TOTAL_CELLS);
 }
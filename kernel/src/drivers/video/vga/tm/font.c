@@ -0,0 +1,46 @@
+#include <drivers/video/vga/tm.h>
+
+extern uint8_t *const vga_gfx_video_memory;
+
+extern const vga_video_mode_descriptor_t* vga_current_video_mode;
+
+static void vga_tm_write_seq(uint8_t index, uint8_t value);
+static void vga_tm_write_gc(uint8_t index, uint8_t value);
+
+int32_t vga_tm_read_font(uint8_t* buffer) {
+    if(vga_current_video_mode == NULL || vga_current_video_mode->mode != VGA_80x25_16_TEXT) {
+        return -1;
+    }
+
+    // Map plane 2 linearly to 0xA0000 for reading
+    vga_tm_write_seq(VGA_SEQ_MAP_MASK_REGISTER, 0x04);
+    vga_tm_write_seq(VGA_SEQ_MEMORY_MODE_REGISTER, 0x07);
+    vga_tm_write_gc(VGA_GC_READ_MAP_SELECT_REGISTER, 0x02);
+    vga_tm_write_gc(VGA_GC_MODE_REGISTER, 0x00);
+    vga_tm_write_gc(VGA_GC_MISC_REGISTER, 0x04);
+
+    for(size_t glyph = 0; glyph < VGA_TM_FONT_GLYPHS; glyph++) {
+        for(size_t row = 0; row < VGA_TM_FONT_HEIGHT; row++) {
+            buffer[glyph * VGA_TM_FONT_HEIGHT + row] = vga_gfx_video_memory[glyph * VGA_TM_FONT_STRIDE + row];
+        }
+    }
+
+    // Restore the text mode memory layout (see VGA_80x25_16_TEXT_CONFIG)
+    vga_tm_write_seq(VGA_SEQ_MAP_MASK_REGISTER, 0x03);
+    vga_tm_write_seq(VGA_SEQ_MEMORY_MODE_REGISTER, 0x02);
+    vga_tm_write_gc(VGA_GC_READ_MAP_SELECT_REGISTER, 0x00);
+    vga_tm_write_gc(VGA_GC_MODE_REGISTER, 0x10);
+    vga_tm_write_gc(VGA_GC_MISC_REGISTER, 0x0E);
+
+    return 0;
+}
+
+static void vga_tm_write_seq(uint8_t index, uint8_t value) {
+    outb(VGA_SEQ_ADDRESS_REGISTER_PORT, index);
+    outb(VGA_SEQ_DATA_REGISTER_PORT, value);
+}
+
+static void vga_tm_write_gc(uint8_t index, uint8_t value) {
+    outb(VGA_GC_ADDRESS_REGISTER_PORT, index);
+    outb(VGA_GC_DATA_REGISTER_PORT, value);
+}
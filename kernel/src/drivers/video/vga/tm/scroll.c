@@ -1,15 +1,54 @@
 #include <drivers/video/vga/tm.h>
+#include <util/string.h>
 
 extern uint16_t *const vga_tm_video_memory;
+extern size_t vga_tm_start_cell;
+extern size_t vga_tm_cursor_cell;
 
 extern const vga_video_mode_descriptor_t* vga_current_video_mode;
 
+static void vga_tm_set_start_cell(size_t cell);
+
 void vga_tm_scroll(uint8_t fgcolor, uint8_t bgcolor) {
-    for (uint16_t index = vga_current_video_mode->width; index < (vga_current_video_mode->width * vga_current_video_mode->height); index++) {
-        vga_tm_video_memory[index - 80] = vga_tm_video_memory[index];
+    const size_t WIDTH = vga_current_video_mode->width;
+    const size_t HEIGHT = vga_current_video_mode->height;
+    const size_t TOTAL_CELLS = WIDTH * HEIGHT;
+
+    uint16_t entry = VGA_TM_ENTRY(' ', fgcolor, bgcolor);
+
+    // Without room for panning, move all rows except the first one up by one row
+    if(TOTAL_CELLS + WIDTH > VGA_TM_VIDEO_MEMORY_CELLS) {
+        memmove(vga_tm_video_memory, vga_tm_video_memory + WIDTH, (HEIGHT - 1) * WIDTH * sizeof(uint16_t));
+        memsetw(vga_tm_video_memory + (HEIGHT - 1) * WIDTH, entry, WIDTH);
+        return;
     }
 
-    for (uint16_t index = vga_current_video_mode->width * vga_current_video_mode->height; index < (vga_current_video_mode->width * (vga_current_video_mode->height + 1)); index++) {
-        vga_tm_video_memory[index - 80] = VGA_TM_ENTRY(' ', fgcolor, bgcolor);
+    size_t start_cell = vga_tm_start_cell + WIDTH;
+
+    /*
+     * Pan the display by one row. Only once the end of the text mode buffer is
+     * reached, the rows that remain visible are copied back to its start.
+     */
+    if(start_cell + TOTAL_CELLS > VGA_TM_VIDEO_MEMORY_CELLS) {
+        memmove(vga_tm_video_memory, vga_tm_video_memory + start_cell, (HEIGHT - 1) * WIDTH * sizeof(uint16_t));
+        start_cell = 0;
     }
+
+    // Clear the last row before it becomes visible
+    memsetw(vga_tm_video_memory + start_cell + (HEIGHT - 1) * WIDTH, entry, WIDTH);
+
+    vga_tm_set_start_cell(start_cell);
+}
+
+static void vga_tm_set_start_cell(size_t cell) {
+    vga_tm_start_cell = cell;
+
+    outb(VGA_CRTC_ADDRESS_REGISTER_PORT, VGA_CRTC_START_ADDRESS_HIGH_REGISTER);
+    outb(VGA_CRTC_DATA_REGISTER_PORT, cell >> 8);
+
+    outb(VGA_CRTC_ADDRESS_REGISTER_PORT, VGA_CRTC_START_ADDRESS_LOW_REGISTER);
+    outb(VGA_CRTC_DATA_REGISTER_PORT, cell & 0xFF);
+
+    // Keep the cursor at the same position on the screen
+    vga_tm_move_cursor(vga_tm_cursor_cell);
 }
@@ -1,6 +1,7 @@
 #include <drivers/video/vga/tm.h>
 
 extern uint16_t *const vga_tm_video_memory;
+extern size_t vga_tm_start_cell;
 
 extern const vga_video_mode_descriptor_t* vga_current_video_mode;
 
@@ -12,7 +13,7 @@ int32_t vga_tm_write(size_t cell, uint8_t ch, uint8_t fgcolor, uint8_t bgcolor)
     }
 
     uint16_t entry = VGA_TM_ENTRY(ch, fgcolor, bgcolor);
-    vga_tm_video_memory[cell] = entry;
+    vga_tm_video_memory[vga_tm_start_cell + cell] = entry;
 
     return 0;
 }
@@ -20,3 +20,21 @@ int32_t vga_set_bit_mask(uint8_t mask) {
 
     return 0;
 }
+
+int32_t vga_set_set_reset(uint8_t color) {
+    outb(VGA_GC_ADDRESS_REGISTER_PORT, VGA_GC_SET_RESET_REGISTER);
+    outb(VGA_GC_DATA_REGISTER_PORT, color & 0x0F);
+
+    return 0;
+}
+
+int32_t vga_set_read_plane(uint8_t plane) {
+    if(plane > 3) {
+        return -1;
+    }
+
+    outb(VGA_GC_ADDRESS_REGISTER_PORT, VGA_GC_READ_MAP_SELECT_REGISTER);
+    outb(VGA_GC_DATA_REGISTER_PORT, plane);
+
+    return 0;
+}
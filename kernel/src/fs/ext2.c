@@ -3,9 +3,25 @@
 #include <system/kpanic.h>
 #include <util/string.h>
 
+/**
+ * Cached copy of an inode. Entries that are no longer referenced stay cached on an LRU
+ * list until the cache exceeds EXT2_INODE_CACHE_SIZE.
+ */
+typedef struct ext2_inode_cache_entry ext2_inode_cache_entry_t;
+
+struct ext2_inode_cache_entry {
+    uint32_t inode_no;                  // Inode number
+    uint32_t references;                // Number of holders, 0 if only cached
+    ext2_inode_cache_entry_t* hash_next;
+    ext2_inode_cache_entry_t* lru_prev;
+    ext2_inode_cache_entry_t* lru_next;
+    ext2_inode_t inode;                 // Cached inode
+};
+
 /**
  * In-memory state of a mounted ext2 file system. Stored in vfs_filesystem_t::fs_data. Holds the
- * cached superblock together with the values derived from it that are needed on every access.
+ * cached superblock and block group descriptor table together with the values derived from them
+ * that are needed on every access, as well as the inode cache of the mount.
  */
 typedef struct ext2_fs {
     ext2_superblock_t superblock;   // Cached copy of the superblock
@@ -15,12 +31,41 @@ typedef struct ext2_fs {
     uint32_t blocks_per_group;      // Number of blocks per block group
     uint32_t bgd_table_block;       // Block number of the block group descriptor table
     uint32_t num_block_groups;      // Number of block groups
+    uint32_t first_inode;           // First non-reserved inode
+    bool read_only;                 // Mounted read-only because of unsupported features
+    bool dirty;                     // Superblock or descriptors changed since the last sync
+    ext2_block_group_descriptor_t* bgd_table;   // Cached block group descriptor table
+    ext2_inode_cache_entry_t* inode_buckets[EXT2_INODE_CACHE_BUCKETS];
+    ext2_inode_cache_entry_t* inode_lru_head;   // Most recently released unreferenced inode
+    ext2_inode_cache_entry_t* inode_lru_tail;   // Least recently released unreferenced inode
+    uint32_t inode_lru_count;       // Number of unreferenced inodes in the cache
 } ext2_fs_t;
 
+/**
+ * The indirect blocks last used to map file blocks, one per level of indirection. Consecutive
+ * file blocks share their indirect blocks, so sequential and repeated lookups are resolved from
+ * memory and only hit the disk once per pointers_per_block blocks.
+ */
+typedef struct ext2_block_map {
+    uint32_t blocks[3];             // Block number held at each level, 0 if none
+    uint32_t* entries[3];           // Block pointers of the held blocks, allocated on first use
+} ext2_block_map_t;
+
+/**
+ * Per-open state of a regular file. Stored in vfs_node_t::inode_data while the node is open.
+ */
+typedef struct ext2_file {
+    ext2_inode_t* inode;            // Referenced inode from the inode cache
+    ext2_block_map_t map;           // Block map cache of the file
+    uint32_t prealloc_block;        // Next reserved block, 0 if none
+    uint32_t prealloc_count;        // Number of reserved blocks left, still free on disk
+} ext2_file_t;
+
 // File system lifecycle
 
 static int32_t ext2_mount(vfs_filesystem_t* filesystem);
 static int32_t ext2_unmount(vfs_filesystem_t* filesystem);
+static int32_t ext2_sync(vfs_filesystem_t* filesystem);
 
 // Node operations
 
@@ -28,20 +73,63 @@ static int32_t ext2_open(vfs_node_t* node);
 static int32_t ext2_close(vfs_node_t* node);
 static int32_t ext2_read(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
 static int32_t ext2_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
+static int32_t ext2_readahead(vfs_node_t* node, uint32_t offset, size_t size);
+static int32_t ext2_truncate(vfs_node_t* node, uint32_t length);
 static int32_t ext2_create(vfs_node_t* node, char* name, uint32_t permissions);
 static int32_t ext2_unlink(vfs_node_t* node, char* name);
 static int32_t ext2_mkdir(vfs_node_t* node, char* name, uint32_t permissions);
 static int32_t ext2_rmdir(vfs_node_t* node, char* name);
-static vfs_dirent_t* ext2_readdir(vfs_node_t* node, uint32_t index);
+static int32_t ext2_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size);
 static vfs_node_t* ext2_finddir(vfs_node_t* node, char* name);
 static int32_t ext2_rename(vfs_node_t* node, char* new_name);
 
 // Internal helpers
 
 static size_t ext2_read_block(vfs_filesystem_t* filesystem, uint32_t block, void* buffer);
+static size_t ext2_write_block(vfs_filesystem_t* filesystem, uint32_t block, const void* buffer);
 static int32_t ext2_read_bgd(vfs_filesystem_t* filesystem, uint32_t group, ext2_block_group_descriptor_t* out);
 static int32_t ext2_read_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* out);
-static uint32_t ext2_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t index);
+static int32_t ext2_write_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, const ext2_inode_t* inode);
+static uint32_t ext2_inode_offset(vfs_filesystem_t* filesystem, uint32_t inode_no);
+static ext2_inode_cache_entry_t* ext2_inode_find(ext2_fs_t* data, uint32_t inode_no);
+static ext2_inode_t* ext2_inode_get(vfs_filesystem_t* filesystem, uint32_t inode_no);
+static void ext2_inode_put(vfs_filesystem_t* filesystem, uint32_t inode_no);
+static void ext2_inode_lru_unlink(ext2_fs_t* data, ext2_inode_cache_entry_t* entry);
+static void ext2_inode_evict(ext2_fs_t* data, ext2_inode_cache_entry_t* entry);
+static uint32_t ext2_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index);
+static uint32_t* ext2_block_map_load(vfs_filesystem_t* filesystem, ext2_block_map_t* map, uint32_t level, uint32_t block);
+static void ext2_block_map_release(ext2_block_map_t* map);
+static void ext2_block_map_invalidate(ext2_block_map_t* map);
+static int32_t ext2_set_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index, uint32_t block);
+static uint32_t ext2_block_goal(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index);
+static void ext2_free_file_blocks(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t first);
+static void ext2_free_tree(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t* slot, uint32_t depth, uint32_t first);
+static uint32_t ext2_alloc_blocks(vfs_filesystem_t* filesystem, uint32_t goal, uint32_t count, uint32_t* run);
+static bool ext2_claim_block(vfs_filesystem_t* filesystem, uint32_t block);
+static uint32_t ext2_alloc_block(vfs_filesystem_t* filesystem, uint32_t goal);
+static uint32_t ext2_file_alloc_block(vfs_filesystem_t* filesystem, ext2_file_t* file, uint32_t goal);
+static void ext2_free_blocks(vfs_filesystem_t* filesystem, uint32_t block, uint32_t count);
+static uint32_t ext2_alloc_inode(vfs_filesystem_t* filesystem, uint32_t parent_no, bool directory);
+static void ext2_free_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* inode, bool directory);
+static uint32_t ext2_dir_lookup(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name);
+static uint32_t ext2_dir_block_find(ext2_fs_t* data, uint8_t* block_buffer, const char* name, size_t name_len);
+static bool ext2_dx_lookup(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map,
+                           const char* name, size_t name_len, uint8_t* block_buffer, uint32_t* inode_no);
+static int32_t ext2_dx_hash(ext2_fs_t* data, uint32_t version, const char* name, size_t name_len, uint32_t* hash);
+static uint32_t ext2_dx_hack_hash(const char* name, size_t name_len, bool unsigned_chars);
+static void ext2_dx_str2hashbuf(const char* name, size_t name_len, uint32_t* input, int32_t count, bool unsigned_chars);
+static uint32_t ext2_dx_rol(uint32_t value, uint32_t shift);
+static uint32_t ext2_dx_f(uint32_t x, uint32_t y, uint32_t z);
+static uint32_t ext2_dx_g(uint32_t x, uint32_t y, uint32_t z);
+static uint32_t ext2_dx_h(uint32_t x, uint32_t y, uint32_t z);
+static void ext2_dx_half_md4(uint32_t buffer[4], const uint32_t input[8]);
+static void ext2_dx_tea(uint32_t buffer[4], const uint32_t input[4]);
+static int32_t ext2_dir_add(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name, uint32_t inode_no, uint8_t file_type);
+static uint32_t ext2_dir_remove(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name);
+static bool ext2_dir_is_empty(vfs_filesystem_t* filesystem, uint32_t dir_no);
+static void ext2_dir_fill(ext2_dir_entry_t* entry, const char* name, uint32_t inode_no, uint8_t file_type);
+static uint8_t ext2_dir_file_type(ext2_fs_t* data, uint16_t mode);
+static uint8_t ext2_dir_vfs_type(ext2_fs_t* data, uint8_t file_type);
 static vfs_node_t* ext2_build_node(vfs_filesystem_t* filesystem, uint32_t inode_no, const char* name, ext2_inode_t* inode);
 
 static vfs_node_operations_t ext2_directory_operations = {
@@ -50,8 +138,10 @@ static vfs_node_operations_t ext2_directory_operations = {
     .rename = &ext2_rename,
     .read = NULL,
     .write = NULL,
-    .create = NULL,
-    .unlink = NULL,
+    .readahead = NULL,
+    .truncate = NULL,
+    .create = &ext2_create,
+    .unlink = &ext2_unlink,
     .mkdir = &ext2_mkdir,
     .rmdir = &ext2_rmdir,
     .readdir = &ext2_readdir,
@@ -64,8 +154,10 @@ static vfs_node_operations_t ext2_file_operations = {
     .rename = &ext2_rename,
     .read = &ext2_read,
     .write = &ext2_write,
-    .create = &ext2_create,
-    .unlink = &ext2_unlink,
+    .readahead = &ext2_readahead,
+    .truncate = &ext2_truncate,
+    .create = NULL,
+    .unlink = NULL,
     .mkdir = NULL,
     .rmdir = NULL,
     .readdir = NULL,
@@ -103,6 +195,7 @@ vfs_filesystem_t* ext2_init(volume_t* volume) {
 
     ext2_mountpoint->operations->mount = &ext2_mount;
     ext2_mountpoint->operations->unmount = &ext2_unmount;
+    ext2_mountpoint->operations->sync = &ext2_sync;
 
     return ext2_mountpoint;
 }
@@ -114,6 +207,8 @@ static int32_t ext2_mount(vfs_filesystem_t* filesystem) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
+    memset(data, 0, sizeof(ext2_fs_t));
+
     filesystem->volume->operations->read(filesystem->volume, EXT2_SUPERBLOCK_OFFSET, sizeof(ext2_superblock_t), (char*) &data->superblock);
 
     if(data->superblock.s_magic != EXT2_SUPER_MAGIC) {
@@ -129,25 +224,69 @@ static int32_t ext2_mount(vfs_filesystem_t* filesystem) {
     data->inode_size = (data->superblock.s_rev_level >= 1) ? data->superblock.s_inode_size : 128;
     data->bgd_table_block = data->superblock.s_first_data_block + 1;
     data->num_block_groups = (data->superblock.s_blocks_count + data->blocks_per_group - 1) / data->blocks_per_group;
+    data->first_inode = (data->superblock.s_rev_level >= 1) ? data->superblock.s_first_ino : EXT2_GOOD_OLD_FIRST_INO;
+
+    // Features the driver does not know how to maintain restrict the file system to reads
+    if(data->superblock.s_rev_level >= 1) {
+        data->read_only = (data->superblock.s_feature_incompat & ~EXT2_FEATURE_INCOMPAT_FILETYPE) != 0 ||
+                          (data->superblock.s_feature_ro_compat & ~(EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER | EXT2_FEATURE_RO_COMPAT_LARGE_FILE)) != 0;
+    }
+
+    // The descriptor table is small and needed for every inode lookup, so it is loaded once.
+    size_t bgd_table_size = data->num_block_groups * sizeof(ext2_block_group_descriptor_t);
+
+    data->bgd_table = (ext2_block_group_descriptor_t*) kmalloc(bgd_table_size);
+
+    if(!data->bgd_table) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    if(filesystem->volume->operations->read(filesystem->volume, data->bgd_table_block * data->block_size, bgd_table_size, (char*) data->bgd_table) != bgd_table_size) {
+        kfree(data->bgd_table);
+        kfree(data);
+        return -1;
+    }
 
     // fs_data has to be set before reading the root inode, as the helpers rely on it.
     filesystem->fs_data = data;
 
-    ext2_inode_t root_inode;
+    ext2_inode_t* root_inode = ext2_inode_get(filesystem, EXT2_ROOT_INODE);
 
-    if(ext2_read_inode(filesystem, EXT2_ROOT_INODE, &root_inode) != 0) {
+    if(!root_inode) {
+        kfree(data->bgd_table);
         kfree(data);
         filesystem->fs_data = NULL;
         return -1;
     }
 
-    filesystem->root = ext2_build_node(filesystem, EXT2_ROOT_INODE, "/", &root_inode);
+    filesystem->root = ext2_build_node(filesystem, EXT2_ROOT_INODE, "/", root_inode);
+    filesystem->root->parent_inode = EXT2_ROOT_INODE;
+
+    ext2_inode_put(filesystem, EXT2_ROOT_INODE);
 
     return 0;
 }
 
 static int32_t ext2_unmount(vfs_filesystem_t* filesystem) {
-    kfree(filesystem->root);
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(data) {
+        ext2_sync(filesystem);
+
+        for(size_t bucket = 0; bucket < EXT2_INODE_CACHE_BUCKETS; bucket++) {
+            ext2_inode_cache_entry_t* entry = data->inode_buckets[bucket];
+
+            while(entry) {
+                ext2_inode_cache_entry_t* next = entry->hash_next;
+                kfree(entry);
+                entry = next;
+            }
+        }
+
+        kfree(data->bgd_table);
+    }
+
+    vfs_node_put(filesystem->root);
     kfree(filesystem->fs_data);
     kfree(filesystem->operations);
     kfree(filesystem);
@@ -155,12 +294,38 @@ static int32_t ext2_unmount(vfs_filesystem_t* filesystem) {
     return 0;
 }
 
+/**
+ * Write the superblock and the block group descriptor table back if they changed, then write
+ * back the dirty blocks of the volume.
+ */
+static int32_t ext2_sync(vfs_filesystem_t* filesystem) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    volume_t* volume = filesystem->volume;
+
+    if(data->dirty) {
+        size_t bgd_table_size = data->num_block_groups * sizeof(ext2_block_group_descriptor_t);
+
+        volume->operations->write(volume, EXT2_SUPERBLOCK_OFFSET, sizeof(ext2_superblock_t), (char*) &data->superblock);
+        volume->operations->write(volume, data->bgd_table_block * data->block_size, bgd_table_size, (char*) data->bgd_table);
+
+        data->dirty = false;
+    }
+
+    return volume->operations->sync(volume);
+}
+
 static size_t ext2_read_block(vfs_filesystem_t* filesystem, uint32_t block, void* buffer) {
     ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
 
     return filesystem->volume->operations->read(filesystem->volume, block * data->block_size, data->block_size, (char*) buffer);
 }
 
+static size_t ext2_write_block(vfs_filesystem_t* filesystem, uint32_t block, const void* buffer) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    return filesystem->volume->operations->write(filesystem->volume, block * data->block_size, data->block_size, (char*) buffer);
+}
+
 static int32_t ext2_read_bgd(vfs_filesystem_t* filesystem, uint32_t group, ext2_block_group_descriptor_t* out) {
     ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
 
@@ -168,29 +333,19 @@ static int32_t ext2_read_bgd(vfs_filesystem_t* filesystem, uint32_t group, ext2_
         return -1;
     }
 
-    uint32_t offset = group * sizeof(ext2_block_group_descriptor_t);
-    uint32_t block = data->bgd_table_block + (offset / data->block_size);
-    uint32_t offset_in_block = offset % data->block_size;
-
-    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
-
-    if(!block_buffer) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-    }
-
-    ext2_read_block(filesystem, block, block_buffer);
-    memcpy(out, block_buffer + offset_in_block, sizeof(ext2_block_group_descriptor_t));
-
-    kfree(block_buffer);
+    memcpy(out, &data->bgd_table[group], sizeof(ext2_block_group_descriptor_t));
 
     return 0;
 }
 
-static int32_t ext2_read_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* out) {
+/**
+ * Get the byte offset of an inode on the volume. Returns 0 for an invalid inode number.
+ */
+static uint32_t ext2_inode_offset(vfs_filesystem_t* filesystem, uint32_t inode_no) {
     ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
 
     if(inode_no == 0) {
-        return -1;
+        return 0;
     }
 
     uint32_t group = (inode_no - 1) / data->inodes_per_group;
@@ -199,306 +354,1646 @@ static int32_t ext2_read_inode(vfs_filesystem_t* filesystem, uint32_t inode_no,
     ext2_block_group_descriptor_t bgd;
 
     if(ext2_read_bgd(filesystem, group, &bgd) != 0) {
-        return -1;
+        return 0;
     }
 
-    uint32_t offset = index * data->inode_size;
-    uint32_t block = bgd.bg_inode_table + (offset / data->block_size);
-    uint32_t offset_in_block = offset % data->block_size;
+    return bgd.bg_inode_table * data->block_size + index * data->inode_size;
+}
 
-    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+static int32_t ext2_read_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* out) {
+    uint32_t offset = ext2_inode_offset(filesystem, inode_no);
 
-    if(!block_buffer) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    if(offset == 0) {
+        return -1;
     }
 
-    ext2_read_block(filesystem, block, block_buffer);
+    // Only the base 128-byte inode is read. A larger on-disk inode_size just changes the stride.
+    size_t bytes_read = filesystem->volume->operations->read(filesystem->volume, offset, sizeof(ext2_inode_t), (char*) out);
 
-    // Only the base 128-byte inode is copied. A larger on-disk inode_size just changes the stride.
-    memcpy(out, block_buffer + offset_in_block, sizeof(ext2_inode_t));
-
-    kfree(block_buffer);
-
-    return 0;
+    return bytes_read == sizeof(ext2_inode_t) ? 0 : -1;
 }
 
 /**
- * Resolve the absolute block number of the index-th block of a file. Returns 0 for a sparse hole
- * or an out-of-range index. Handles the 12 direct as well as the single, double and triple
- * indirect block pointers.
+ * Write an inode back to disk. A cached copy of the inode is updated as well, so inodes
+ * must only ever be written through this function.
  */
-static uint32_t ext2_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t index) {
+static int32_t ext2_write_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, const ext2_inode_t* inode) {
     ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    uint32_t offset = ext2_inode_offset(filesystem, inode_no);
 
-    uint32_t pointers_per_block = data->block_size / sizeof(uint32_t);
-
-    // 12 direct block pointers
-    if(index < 12) {
-        return inode->i_block[index];
+    if(offset == 0) {
+        return -1;
     }
 
-    index -= 12;
-
-    uint32_t* block_buffer = (uint32_t*) kmalloc(data->block_size);
+    ext2_inode_cache_entry_t* entry = ext2_inode_find(data, inode_no);
 
-    if(!block_buffer) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    if(entry && &entry->inode != inode) {
+        memcpy(&entry->inode, inode, sizeof(ext2_inode_t));
     }
 
-    uint32_t result = 0;
+    size_t bytes_written = filesystem->volume->operations->write(filesystem->volume, offset, sizeof(ext2_inode_t), (char*) inode);
 
-    // Single indirect
-    if(index < pointers_per_block) {
-        if(inode->i_block[12] != 0) {
-            ext2_read_block(filesystem, inode->i_block[12], block_buffer);
-            result = block_buffer[index];
-        }
+    return bytes_written == sizeof(ext2_inode_t) ? 0 : -1;
+}
 
-        kfree(block_buffer);
-        return result;
+static ext2_inode_cache_entry_t* ext2_inode_find(ext2_fs_t* data, uint32_t inode_no) {
+    ext2_inode_cache_entry_t* entry = data->inode_buckets[inode_no % EXT2_INODE_CACHE_BUCKETS];
+
+    while(entry && entry->inode_no != inode_no) {
+        entry = entry->hash_next;
     }
 
-    index -= pointers_per_block;
+    return entry;
+}
 
-    // Double indirect
-    if(index < pointers_per_block * pointers_per_block) {
-        if(inode->i_block[13] != 0) {
-            ext2_read_block(filesystem, inode->i_block[13], block_buffer);
-            uint32_t single = block_buffer[index / pointers_per_block];
+/**
+ * Get a referenced inode from the inode cache, reading it from disk on a miss. Every
+ * successful call must be paired with ext2_inode_put.
+ */
+static ext2_inode_t* ext2_inode_get(vfs_filesystem_t* filesystem, uint32_t inode_no) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    size_t bucket = inode_no % EXT2_INODE_CACHE_BUCKETS;
+    ext2_inode_cache_entry_t* entry = ext2_inode_find(data, inode_no);
 
-            if(single != 0) {
-                ext2_read_block(filesystem, single, block_buffer);
-                result = block_buffer[index % pointers_per_block];
-            }
+    if(entry) {
+        if(entry->references == 0) {
+            ext2_inode_lru_unlink(data, entry);
         }
 
-        kfree(block_buffer);
-        return result;
+        entry->references++;
+
+        return &entry->inode;
     }
 
-    index -= pointers_per_block * pointers_per_block;
+    entry = (ext2_inode_cache_entry_t*) kmalloc(sizeof(ext2_inode_cache_entry_t));
 
-    // Triple indirect
-    if(inode->i_block[14] != 0) {
-        ext2_read_block(filesystem, inode->i_block[14], block_buffer);
-        uint32_t double_block = block_buffer[index / (pointers_per_block * pointers_per_block)];
-
-        if(double_block != 0) {
-            ext2_read_block(filesystem, double_block, block_buffer);
-            uint32_t remainder = index % (pointers_per_block * pointers_per_block);
-            uint32_t single = block_buffer[remainder / pointers_per_block];
-
-            if(single != 0) {
-                ext2_read_block(filesystem, single, block_buffer);
-                result = block_buffer[remainder % pointers_per_block];
-            }
-        }
+    if(!entry) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
-    kfree(block_buffer);
-    return result;
+    if(ext2_read_inode(filesystem, inode_no, &entry->inode) != 0) {
+        kfree(entry);
+        return NULL;
+    }
+
+    entry->inode_no = inode_no;
+    entry->references = 1;
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+    entry->hash_next = data->inode_buckets[bucket];
+    data->inode_buckets[bucket] = entry;
+
+    return &entry->inode;
 }
 
 /**
- * Allocate and populate a vfs_node from an inode. The type, size and ownership are taken directly
- * from the inode, and the matching operation table is selected based on the file type.
+ * Release a reference obtained by ext2_inode_get. Unreferenced inodes are kept cached
+ * and the least recently released ones are evicted once the cache is full.
  */
-static vfs_node_t* ext2_build_node(vfs_filesystem_t* filesystem, uint32_t inode_no, const char* name, ext2_inode_t* inode) {
-    vfs_node_t* node = (vfs_node_t*) kmalloc(sizeof(vfs_node_t));
+static void ext2_inode_put(vfs_filesystem_t* filesystem, uint32_t inode_no) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    ext2_inode_cache_entry_t* entry = ext2_inode_find(data, inode_no);
 
-    if(!node) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    if(!entry || entry->references == 0 || --entry->references > 0) {
+        return;
     }
 
-    strncpy(node->name, name, 256);
-
-    node->permissions = inode->i_mode & 0x0FFF;
-    node->uid = inode->i_uid;
-    node->gid = inode->i_gid;
-    node->length = inode->i_size;
-    node->inode = inode_no;
-    node->inode_data = NULL;
-    node->link = NULL;
-    node->filesystem = filesystem;
+    entry->lru_prev = NULL;
+    entry->lru_next = data->inode_lru_head;
 
-    switch(inode->i_mode & EXT2_S_IFMT) {
-        case EXT2_S_IFDIR:
-            node->type = VFS_DIRECTORY;
-            node->operations = &ext2_directory_operations;
-            break;
-        case EXT2_S_IFLNK:
-            node->type = VFS_SYMLINK;
-            node->operations = &ext2_file_operations;
-            break;
-        default:
-            node->type = VFS_FILE;
-            node->operations = &ext2_file_operations;
-            break;
+    if(data->inode_lru_head) {
+        data->inode_lru_head->lru_prev = entry;
+    } else {
+        data->inode_lru_tail = entry;
     }
 
-    return node;
-}
+    data->inode_lru_head = entry;
+    data->inode_lru_count++;
 
-static int32_t ext2_open(vfs_node_t* node) {
-    // Directories are read on demand in readdir/finddir and need no state loaded here.
-    if(node->type == VFS_DIRECTORY) {
-        return 0;
+    while(data->inode_lru_count > EXT2_INODE_CACHE_SIZE) {
+        ext2_inode_evict(data, data->inode_lru_tail);
     }
+}
 
-    ext2_inode_t* inode = (ext2_inode_t*) kmalloc(sizeof(ext2_inode_t));
-
-    if(!inode) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+static void ext2_inode_lru_unlink(ext2_fs_t* data, ext2_inode_cache_entry_t* entry) {
+    if(entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        data->inode_lru_head = entry->lru_next;
     }
 
-    if(ext2_read_inode(node->filesystem, node->inode, inode) != 0) {
-        kfree(inode);
-        return -1;
+    if(entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        data->inode_lru_tail = entry->lru_prev;
     }
 
-    node->inode_data = (void*) inode;
-
-    return 0;
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+    data->inode_lru_count--;
 }
 
-static int32_t ext2_close(vfs_node_t* node) {
-    if(node->inode_data) {
-        kfree(node->inode_data);
-        node->inode_data = NULL;
+static void ext2_inode_evict(ext2_fs_t* data, ext2_inode_cache_entry_t* entry) {
+    ext2_inode_cache_entry_t** link = &data->inode_buckets[entry->inode_no % EXT2_INODE_CACHE_BUCKETS];
+
+    while(*link != entry) {
+        link = &(*link)->hash_next;
     }
 
-    return 0;
+    *link = entry->hash_next;
+
+    ext2_inode_lru_unlink(data, entry);
+    kfree(entry);
 }
 
-static int32_t ext2_read(vfs_node_t* node, uint32_t offset, size_t size, void* buffer) {
-    if(node->inode_data == NULL) {
-        return -1;
+/**
+ * Resolve the absolute block number of the index-th block of a file. Returns 0 for a sparse hole
+ * or an out-of-range index. Handles the 12 direct as well as the single, double and triple
+ * indirect block pointers, reading indirect blocks through the given block map cache.
+ */
+static uint32_t ext2_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    uint32_t pointers_per_block = data->block_size / sizeof(uint32_t);
+    uint32_t* entries;
+
+    // 12 direct block pointers
+    if(index < 12) {
+        return inode->i_block[index];
     }
 
-    ext2_inode_t* inode = (ext2_inode_t*) node->inode_data;
-    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+    index -= 12;
 
-    if(offset > inode->i_size) {
-        return 0;
+    // Single indirect
+    if(index < pointers_per_block) {
+        entries = ext2_block_map_load(filesystem, map, 0, inode->i_block[12]);
+
+        return entries ? entries[index] : 0;
     }
 
-    if(offset + size > inode->i_size) {
-        size = inode->i_size - offset;
+    index -= pointers_per_block;
+
+    // Double indirect
+    if(index < pointers_per_block * pointers_per_block) {
+        entries = ext2_block_map_load(filesystem, map, 0, inode->i_block[13]);
+
+        if(!entries) {
+            return 0;
+        }
+
+        entries = ext2_block_map_load(filesystem, map, 1, entries[index / pointers_per_block]);
+
+        return entries ? entries[index % pointers_per_block] : 0;
     }
 
-    if(size == 0) {
+    index -= pointers_per_block * pointers_per_block;
+
+    // Triple indirect
+    entries = ext2_block_map_load(filesystem, map, 0, inode->i_block[14]);
+
+    if(!entries) {
         return 0;
     }
 
-    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+    entries = ext2_block_map_load(filesystem, map, 1, entries[index / (pointers_per_block * pointers_per_block)]);
 
-    if(!block_buffer) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    if(!entries) {
+        return 0;
     }
 
-    size_t bytes_read = 0;
+    uint32_t remainder = index % (pointers_per_block * pointers_per_block);
 
-    while(bytes_read < size) {
-        uint32_t file_block = (offset + bytes_read) / data->block_size;
-        uint32_t offset_in_block = (offset + bytes_read) % data->block_size;
+    entries = ext2_block_map_load(filesystem, map, 2, entries[remainder / pointers_per_block]);
 
-        uint32_t chunk = data->block_size - offset_in_block;
+    return entries ? entries[remainder % pointers_per_block] : 0;
+}
 
-        if(chunk > size - bytes_read) {
-            chunk = size - bytes_read;
-        }
+/**
+ * Get the block pointers of an indirect block at the given level of the block map, reading the
+ * block only if the level currently holds a different one. Returns NULL for a sparse hole.
+ */
+static uint32_t* ext2_block_map_load(vfs_filesystem_t* filesystem, ext2_block_map_t* map, uint32_t level, uint32_t block) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(block == 0) {
+        return NULL;
+    }
 
-        uint32_t physical_block = ext2_inode_block(node->filesystem, inode, file_block);
+    if(map->blocks[level] == block) {
+        return map->entries[level];
+    }
 
-        if(physical_block == 0) {
-            // Sparse hole: the region reads back as zeros.
-            memset((uint8_t*) buffer + bytes_read, 0, chunk);
-        } else {
-            ext2_read_block(node->filesystem, physical_block, block_buffer);
-            memcpy((uint8_t*) buffer + bytes_read, block_buffer + offset_in_block, chunk);
+    if(!map->entries[level]) {
+        map->entries[level] = (uint32_t*) kmalloc(data->block_size);
+
+        if(!map->entries[level]) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
         }
+    }
 
-        bytes_read += chunk;
+    if(ext2_read_block(filesystem, block, map->entries[level]) != data->block_size) {
+        map->blocks[level] = 0;
+        return NULL;
     }
 
-    kfree(block_buffer);
+    map->blocks[level] = block;
 
-    return (int32_t) bytes_read;
+    return map->entries[level];
 }
 
-static vfs_dirent_t* ext2_readdir(vfs_node_t* node, uint32_t index) {
-    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+static void ext2_block_map_release(ext2_block_map_t* map) {
+    for(size_t level = 0; level < 3; level++) {
+        if(map->entries[level]) {
+            kfree(map->entries[level]);
+        }
 
-    ext2_inode_t inode;
+        map->entries[level] = NULL;
+        map->blocks[level] = 0;
+    }
+}
 
-    if(ext2_read_inode(node->filesystem, node->inode, &inode) != 0) {
-        return NULL;
+/**
+ * Forget the held indirect blocks after their contents changed on disk behind the map.
+ */
+static void ext2_block_map_invalidate(ext2_block_map_t* map) {
+    for(size_t level = 0; level < 3; level++) {
+        map->blocks[level] = 0;
     }
+}
 
-    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+/**
+ * Map the index-th block of a file to the given block, allocating the indirect blocks on the
+ * way if needed. Modified indirect blocks are written through the block map, so it stays
+ * consistent with the disk. The caller has to write the inode back afterwards.
+ */
+static int32_t ext2_set_inode_block(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index, uint32_t block) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
 
-    if(!block_buffer) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    uint32_t pointers_per_block = data->block_size / sizeof(uint32_t);
+    uint32_t offsets[3];
+    uint32_t depth;
+
+    if(index < 12) {
+        inode->i_block[index] = block;
+        return 0;
     }
 
-    uint32_t total_blocks = (inode.i_size + data->block_size - 1) / data->block_size;
-    uint32_t current = 0;
+    index -= 12;
 
-    for(uint32_t b = 0; b < total_blocks; b++) {
-        uint32_t physical_block = ext2_inode_block(node->filesystem, &inode, b);
+    // Split the index into the entry offsets at each level of indirection
+    if(index < pointers_per_block) {
+        depth = 1;
+        offsets[0] = index;
+    } else if((index -= pointers_per_block) < pointers_per_block * pointers_per_block) {
+        depth = 2;
+        offsets[0] = index / pointers_per_block;
+        offsets[1] = index % pointers_per_block;
+    } else {
+        index -= pointers_per_block * pointers_per_block;
+        depth = 3;
+        offsets[0] = index / (pointers_per_block * pointers_per_block);
+        offsets[1] = (index / pointers_per_block) % pointers_per_block;
+        offsets[2] = index % pointers_per_block;
+    }
 
-        if(physical_block == 0) {
-            continue;
-        }
+    // The inode is packed, so its top level slot is handled through a copy
+    uint32_t root = inode->i_block[11 + depth];
+    uint32_t* slot = &root;
 
-        ext2_read_block(node->filesystem, physical_block, block_buffer);
+    for(uint32_t level = 0; level < depth; level++) {
+        if(*slot == 0) {
+            uint32_t indirect = ext2_alloc_block(filesystem, block);
 
-        uint32_t position = 0;
+            if(indirect == 0) {
+                return -1;
+            }
 
-        while(position < data->block_size) {
-            ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + position);
+            uint8_t* zero_buffer = (uint8_t*) kmalloc(data->block_size);
 
-            // A zero record length would loop forever on a corrupt directory block.
-            if(entry->rec_len == 0) {
-                break;
+            if(!zero_buffer) {
+                KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
             }
 
-            if(entry->inode != 0) {
-                if(current == index) {
-                    vfs_dirent_t* dirent = (vfs_dirent_t*) kmalloc(sizeof(vfs_dirent_t));
+            memset(zero_buffer, 0, data->block_size);
+            ext2_write_block(filesystem, indirect, zero_buffer);
+            kfree(zero_buffer);
 
-                    if(!dirent) {
-                        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-                    }
+            *slot = indirect;
+            inode->i_blocks += data->block_size / 512;
 
-                    uint8_t name_len = entry->name_len;
+            if(level == 0) {
+                inode->i_block[11 + depth] = indirect;
+            }
 
-                    memcpy(dirent->name, (uint8_t*) entry + sizeof(ext2_dir_entry_t), name_len);
-                    dirent->name[name_len] = '\0';
-                    dirent->inode = entry->inode;
+            // The map could still hold a stale copy if the block was in use before
+            if(map->blocks[level] == indirect) {
+                map->blocks[level] = 0;
+            }
 
-                    kfree(block_buffer);
-                    return dirent;
+            // The slot lives in the indirect block of the level above, unless it is in the inode
+            if(level > 0) {
+                ext2_write_block(filesystem, map->blocks[level - 1], map->entries[level - 1]);
+            }
+        }
+
+        uint32_t* entries = ext2_block_map_load(filesystem, map, level, *slot);
+
+        if(!entries) {
+            return -1;
+        }
+
+        slot = &entries[offsets[level]];
+    }
+
+    *slot = block;
+
+    ext2_write_block(filesystem, map->blocks[depth - 1], map->entries[depth - 1]);
+
+    return 0;
+}
+
+/**
+ * Pick the block a new block of a file should preferably be allocated at. That is the block
+ * after the previous block of the file, or the start of the inode's block group.
+ */
+static uint32_t ext2_block_goal(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* inode, ext2_block_map_t* map, uint32_t index) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(index > 0) {
+        uint32_t previous = ext2_inode_block(filesystem, inode, map, index - 1);
+
+        if(previous != 0) {
+            return previous + 1;
+        }
+    }
+
+    uint32_t group = (inode_no - 1) / data->inodes_per_group;
+
+    return data->superblock.s_first_data_block + group * data->blocks_per_group;
+}
+
+/**
+ * Release all blocks of a file from the first-th block on, including indirect blocks that
+ * no longer map anything. The caller has to write the inode back afterwards.
+ */
+static void ext2_free_file_blocks(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t first) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    uint32_t pointers_per_block = data->block_size / sizeof(uint32_t);
+
+    for(uint32_t index = first; index < 12; index++) {
+        if(inode->i_block[index] != 0) {
+            ext2_free_blocks(filesystem, inode->i_block[index], 1);
+            inode->i_block[index] = 0;
+            inode->i_blocks -= data->block_size / 512;
+        }
+    }
+
+    uint32_t base = 12;
+    uint32_t span = pointers_per_block;
+
+    for(uint32_t depth = 1; depth <= 3; depth++) {
+        if(first < base + span) {
+            uint32_t root = inode->i_block[11 + depth];
+
+            ext2_free_tree(filesystem, inode, &root, depth, first > base ? first - base : 0);
+            inode->i_block[11 + depth] = root;
+        }
+
+        base += span;
+        span *= pointers_per_block;
+    }
+}
+
+/**
+ * Release the blocks of an indirect tree from the first-th mapped block on. The indirect
+ * block itself is released as well if the whole tree is released.
+ */
+static void ext2_free_tree(vfs_filesystem_t* filesystem, ext2_inode_t* inode, uint32_t* slot, uint32_t depth, uint32_t first) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(*slot == 0) {
+        return;
+    }
+
+    if(depth > 0) {
+        uint32_t pointers_per_block = data->block_size / sizeof(uint32_t);
+        uint32_t span = 1;
+
+        for(uint32_t level = 1; level < depth; level++) {
+            span *= pointers_per_block;
+        }
+
+        uint32_t* entries = (uint32_t*) kmalloc(data->block_size);
+
+        if(!entries) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+        }
+
+        if(ext2_read_block(filesystem, *slot, entries) != data->block_size) {
+            kfree(entries);
+            return;
+        }
+
+        for(uint32_t entry = first / span; entry < pointers_per_block; entry++) {
+            ext2_free_tree(filesystem, inode, &entries[entry], depth - 1, entry == first / span ? first % span : 0);
+        }
+
+        if(first != 0) {
+            ext2_write_block(filesystem, *slot, entries);
+        }
+
+        kfree(entries);
+    }
+
+    if(first == 0) {
+        ext2_free_blocks(filesystem, *slot, 1);
+        *slot = 0;
+        inode->i_blocks -= data->block_size / 512;
+    }
+}
+
+/**
+ * Allocate a block at the start of a run of up to count free blocks, preferably at the goal
+ * block. The groups are searched starting at the goal's group. Only the first block is marked
+ * in the bitmap, the rest of the run stays free and may be reserved by the caller. Returns the
+ * allocated block and stores the length of the run, or returns 0 if the file system is full.
+ */
+static uint32_t ext2_alloc_blocks(vfs_filesystem_t* filesystem, uint32_t goal, uint32_t count, uint32_t* run) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    uint32_t first_data_block = data->superblock.s_first_data_block;
+
+    *run = 0;
+
+    if(data->read_only || data->superblock.s_free_blocks_count == 0) {
+        return 0;
+    }
+
+    uint32_t goal_group = 0;
+    uint32_t goal_bit = 0;
+
+    if(goal >= first_data_block && goal < data->superblock.s_blocks_count) {
+        goal_group = (goal - first_data_block) / data->blocks_per_group;
+        goal_bit = (goal - first_data_block) % data->blocks_per_group;
+    }
+
+    uint8_t* bitmap = (uint8_t*) kmalloc(data->block_size);
+
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    for(uint32_t attempt = 0; attempt < data->num_block_groups; attempt++) {
+        uint32_t group = (goal_group + attempt) % data->num_block_groups;
+        ext2_block_group_descriptor_t* bgd = &data->bgd_table[group];
+
+        if(bgd->bg_free_blocks_count == 0) {
+            continue;
+        }
+
+        if(ext2_read_block(filesystem, bgd->bg_block_bitmap, bitmap) != data->block_size) {
+            continue;
+        }
+
+        // The last group may be shorter than the others
+        uint32_t group_blocks = data->superblock.s_blocks_count - first_data_block - group * data->blocks_per_group;
+
+        if(group_blocks > data->blocks_per_group) {
+            group_blocks = data->blocks_per_group;
+        }
+
+        uint32_t start = (attempt == 0 && goal_bit < group_blocks) ? goal_bit : 0;
+
+        for(uint32_t probe = 0; probe < group_blocks; probe++) {
+            uint32_t bit = (start + probe) % group_blocks;
+
+            if(bitmap[bit / 8] & (1 << (bit % 8))) {
+                continue;
+            }
+
+            uint32_t length = 0;
+
+            while(length < count && bit + length < group_blocks && length < bgd->bg_free_blocks_count &&
+                  !(bitmap[(bit + length) / 8] & (1 << ((bit + length) % 8)))) {
+                length++;
+            }
+
+            bitmap[bit / 8] |= 1 << (bit % 8);
+
+            ext2_write_block(filesystem, bgd->bg_block_bitmap, bitmap);
+            kfree(bitmap);
+
+            bgd->bg_free_blocks_count--;
+            data->superblock.s_free_blocks_count--;
+            data->dirty = true;
+
+            *run = length;
+
+            return first_data_block + group * data->blocks_per_group + bit;
+        }
+    }
+
+    kfree(bitmap);
+
+    return 0;
+}
+
+static uint32_t ext2_alloc_block(vfs_filesystem_t* filesystem, uint32_t goal) {
+    uint32_t run;
+
+    return ext2_alloc_blocks(filesystem, goal, 1, &run);
+}
+
+/**
+ * Mark a specific block as used. Returns false if the block is no longer free.
+ */
+static bool ext2_claim_block(vfs_filesystem_t* filesystem, uint32_t block) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    uint32_t first_data_block = data->superblock.s_first_data_block;
+
+    if(data->read_only || block < first_data_block || block >= data->superblock.s_blocks_count) {
+        return false;
+    }
+
+    uint32_t group = (block - first_data_block) / data->blocks_per_group;
+    uint32_t bit = (block - first_data_block) % data->blocks_per_group;
+    ext2_block_group_descriptor_t* bgd = &data->bgd_table[group];
+
+    uint8_t* bitmap = (uint8_t*) kmalloc(data->block_size);
+
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    bool claimed = false;
+
+    if(ext2_read_block(filesystem, bgd->bg_block_bitmap, bitmap) == data->block_size && !(bitmap[bit / 8] & (1 << (bit % 8)))) {
+        bitmap[bit / 8] |= 1 << (bit % 8);
+
+        ext2_write_block(filesystem, bgd->bg_block_bitmap, bitmap);
+
+        bgd->bg_free_blocks_count--;
+        data->superblock.s_free_blocks_count--;
+        data->dirty = true;
+
+        claimed = true;
+    }
+
+    kfree(bitmap);
+
+    return claimed;
+}
+
+/**
+ * Allocate a data block for an open file. While the file grows sequentially, blocks are taken
+ * from its reservation, otherwise a block is allocated at the goal and the free blocks following
+ * it, up to EXT2_PREALLOC_BLOCKS, are reserved. Reserved blocks stay free on disk, so a sync never
+ * writes them out as used, and are claimed in the bitmap one at a time as they are assigned.
+ */
+static uint32_t ext2_file_alloc_block(vfs_filesystem_t* filesystem, ext2_file_t* file, uint32_t goal) {
+    if(file->prealloc_count > 0 && file->prealloc_block == goal) {
+        uint32_t block = file->prealloc_block;
+
+        file->prealloc_count--;
+        file->prealloc_block = file->prealloc_count > 0 ? block + 1 : 0;
+
+        if(ext2_claim_block(filesystem, block)) {
+            return block;
+        }
+    }
+
+    // The reservation is dropped if the file does not grow sequentially or a block of it was taken
+    file->prealloc_block = 0;
+    file->prealloc_count = 0;
+
+    uint32_t run;
+    uint32_t block = ext2_alloc_blocks(filesystem, goal, EXT2_PREALLOC_BLOCKS, &run);
+
+    if(block != 0 && run > 1) {
+        file->prealloc_block = block + 1;
+        file->prealloc_count = run - 1;
+    }
+
+    return block;
+}
+
+/**
+ * Release a run of blocks, which must not cross a block group boundary.
+ */
+static void ext2_free_blocks(vfs_filesystem_t* filesystem, uint32_t block, uint32_t count) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+    uint32_t first_data_block = data->superblock.s_first_data_block;
+
+    if(block < first_data_block || block >= data->superblock.s_blocks_count || count == 0) {
+        return;
+    }
+
+    uint32_t group = (block - first_data_block) / data->blocks_per_group;
+    uint32_t bit = (block - first_data_block) % data->blocks_per_group;
+    ext2_block_group_descriptor_t* bgd = &data->bgd_table[group];
+
+    uint8_t* bitmap = (uint8_t*) kmalloc(data->block_size);
+
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    if(ext2_read_block(filesystem, bgd->bg_block_bitmap, bitmap) != data->block_size) {
+        kfree(bitmap);
+        return;
+    }
+
+    uint32_t released = 0;
+
+    for(uint32_t index = bit; index < bit + count && index < data->blocks_per_group; index++) {
+        if(bitmap[index / 8] & (1 << (index % 8))) {
+            bitmap[index / 8] &= ~(1 << (index % 8));
+            released++;
+        }
+    }
+
+    ext2_write_block(filesystem, bgd->bg_block_bitmap, bitmap);
+    kfree(bitmap);
+
+    bgd->bg_free_blocks_count += released;
+    data->superblock.s_free_blocks_count += released;
+    data->dirty = true;
+}
+
+/**
+ * Allocate an inode, preferably in the block group of the parent directory so that related
+ * files stay close together. Returns 0 if there is no free inode.
+ */
+static uint32_t ext2_alloc_inode(vfs_filesystem_t* filesystem, uint32_t parent_no, bool directory) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(data->read_only || data->superblock.s_free_inodes_count == 0) {
+        return 0;
+    }
+
+    uint32_t parent_group = (parent_no - 1) / data->inodes_per_group;
+
+    uint8_t* bitmap = (uint8_t*) kmalloc(data->block_size);
+
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    for(uint32_t attempt = 0; attempt < data->num_block_groups; attempt++) {
+        uint32_t group = (parent_group + attempt) % data->num_block_groups;
+        ext2_block_group_descriptor_t* bgd = &data->bgd_table[group];
+
+        if(bgd->bg_free_inodes_count == 0) {
+            continue;
+        }
+
+        if(ext2_read_block(filesystem, bgd->bg_inode_bitmap, bitmap) != data->block_size) {
+            continue;
+        }
+
+        for(uint32_t bit = 0; bit < data->inodes_per_group; bit++) {
+            uint32_t inode_no = group * data->inodes_per_group + bit + 1;
+
+            if(inode_no < data->first_inode || (bitmap[bit / 8] & (1 << (bit % 8)))) {
+                continue;
+            }
+
+            bitmap[bit / 8] |= 1 << (bit % 8);
+
+            ext2_write_block(filesystem, bgd->bg_inode_bitmap, bitmap);
+            kfree(bitmap);
+
+            bgd->bg_free_inodes_count--;
+
+            if(directory) {
+                bgd->bg_used_dirs_count++;
+            }
+
+            data->superblock.s_free_inodes_count--;
+            data->dirty = true;
+
+            return inode_no;
+        }
+    }
+
+    kfree(bitmap);
+
+    return 0;
+}
+
+/**
+ * Release an inode number. An inode that was written to disk is passed along, so it is marked
+ * as deleted first. fsck expects a deletion time on every unused inode with a mode, there is no
+ * wall clock, so the last write time of the file system stands in for it.
+ */
+static void ext2_free_inode(vfs_filesystem_t* filesystem, uint32_t inode_no, ext2_inode_t* inode, bool directory) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    if(inode) {
+        inode->i_links_count = 0;
+        inode->i_dtime = data->superblock.s_wtime != 0 ? data->superblock.s_wtime : 1;
+
+        ext2_write_inode(filesystem, inode_no, inode);
+    }
+
+    uint32_t group = (inode_no - 1) / data->inodes_per_group;
+    uint32_t bit = (inode_no - 1) % data->inodes_per_group;
+    ext2_block_group_descriptor_t* bgd = &data->bgd_table[group];
+
+    uint8_t* bitmap = (uint8_t*) kmalloc(data->block_size);
+
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    if(ext2_read_block(filesystem, bgd->bg_inode_bitmap, bitmap) == data->block_size && (bitmap[bit / 8] & (1 << (bit % 8)))) {
+        bitmap[bit / 8] &= ~(1 << (bit % 8));
+
+        ext2_write_block(filesystem, bgd->bg_inode_bitmap, bitmap);
+
+        bgd->bg_free_inodes_count++;
+
+        if(directory) {
+            bgd->bg_used_dirs_count--;
+        }
+
+        data->superblock.s_free_inodes_count++;
+        data->dirty = true;
+    }
+
+    kfree(bitmap);
+}
+
+/**
+ * Create a vfs_node from an inode. The type, size and ownership are taken directly from the
+ * inode, and the matching operation table is selected based on the file type.
+ */
+static vfs_node_t* ext2_build_node(vfs_filesystem_t* filesystem, uint32_t inode_no, const char* name, ext2_inode_t* inode) {
+    vfs_node_t* node = vfs_node_create(filesystem, inode_no, name);
+
+    node->permissions = inode->i_mode & 0x0FFF;
+    node->uid = inode->i_uid;
+    node->gid = inode->i_gid;
+    node->length = inode->i_size;
+
+    switch(inode->i_mode & EXT2_S_IFMT) {
+        case EXT2_S_IFDIR:
+            node->type = VFS_DIRECTORY;
+            node->operations = &ext2_directory_operations;
+            break;
+        case EXT2_S_IFLNK:
+            node->type = VFS_SYMLINK;
+            node->operations = &ext2_file_operations;
+            break;
+        default:
+            node->type = VFS_FILE;
+            node->operations = &ext2_file_operations;
+            break;
+    }
+
+    return node;
+}
+
+static int32_t ext2_open(vfs_node_t* node) {
+    // Directories are read on demand in readdir/finddir and need no state loaded here.
+    if(node->type == VFS_DIRECTORY) {
+        return 0;
+    }
+
+    ext2_inode_t* inode = ext2_inode_get(node->filesystem, node->inode);
+
+    if(!inode) {
+        return -1;
+    }
+
+    ext2_file_t* file = (ext2_file_t*) kmalloc(sizeof(ext2_file_t));
+
+    if(!file) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    memset(file, 0, sizeof(ext2_file_t));
+    file->inode = inode;
+
+    node->inode_data = (void*) file;
+
+    return 0;
+}
+
+static int32_t ext2_close(vfs_node_t* node) {
+    if(node->inode_data) {
+        ext2_file_t* file = (ext2_file_t*) node->inode_data;
+
+        // Blocks still reserved for growing the file were never marked used, so they need no release
+        ext2_block_map_release(&file->map);
+        kfree(file);
+
+        ext2_inode_put(node->filesystem, node->inode);
+        node->inode_data = NULL;
+    }
+
+    return 0;
+}
+
+static int32_t ext2_read(vfs_node_t* node, uint32_t offset, size_t size, void* buffer) {
+    if(node->inode_data == NULL) {
+        return -1;
+    }
+
+    ext2_file_t* file = (ext2_file_t*) node->inode_data;
+    ext2_inode_t* inode = file->inode;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(offset > inode->i_size) {
+        return 0;
+    }
+
+    if(offset + size > inode->i_size) {
+        size = inode->i_size - offset;
+    }
+
+    if(size == 0) {
+        return 0;
+    }
+
+    uint8_t* block_buffer = NULL;
+    size_t bytes_read = 0;
+
+    while(bytes_read < size) {
+        uint32_t file_block = (offset + bytes_read) / data->block_size;
+        uint32_t offset_in_block = (offset + bytes_read) % data->block_size;
+        size_t remaining = size - bytes_read;
+
+        uint32_t physical_block = ext2_inode_block(node->filesystem, inode, &file->map, file_block);
+
+        // Holes and partial blocks at the start or end of the request are handled one block at a time
+        if(physical_block == 0 || offset_in_block != 0 || remaining < data->block_size) {
+            uint32_t chunk = data->block_size - offset_in_block;
+
+            if(chunk > remaining) {
+                chunk = remaining;
+            }
+
+            if(physical_block == 0) {
+                // Sparse hole: the region reads back as zeros.
+                memset((uint8_t*) buffer + bytes_read, 0, chunk);
+            } else {
+                if(!block_buffer) {
+                    block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+                    if(!block_buffer) {
+                        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+                    }
+                }
+
+                if(ext2_read_block(node->filesystem, physical_block, block_buffer) != data->block_size) {
+                    break;
+                }
+
+                memcpy((uint8_t*) buffer + bytes_read, block_buffer + offset_in_block, chunk);
+            }
+
+            bytes_read += chunk;
+            continue;
+        }
+
+        // Whole blocks that are physically adjacent are read with a single transfer straight
+        // into the caller's buffer.
+        uint32_t run = 1;
+        uint32_t max_run = remaining / data->block_size;
+
+        while(run < max_run && ext2_inode_block(node->filesystem, inode, &file->map, file_block + run) == physical_block + run) {
+            run++;
+        }
+
+        size_t run_size = run * data->block_size;
+
+        if(node->filesystem->volume->operations->read(node->filesystem->volume, physical_block * data->block_size,
+                                                      run_size, (char*) buffer + bytes_read) != run_size) {
+            break;
+        }
+
+        bytes_read += run_size;
+    }
+
+    if(block_buffer) {
+        kfree(block_buffer);
+    }
+
+    if(bytes_read == 0) {
+        return -1;
+    }
+
+    return (int32_t) bytes_read;
+}
+
+static int32_t ext2_readahead(vfs_node_t* node, uint32_t offset, size_t size) {
+    if(node->inode_data == NULL) {
+        return -1;
+    }
+
+    ext2_file_t* file = (ext2_file_t*) node->inode_data;
+    ext2_inode_t* inode = file->inode;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(offset >= inode->i_size || size == 0) {
+        return 0;
+    }
+
+    if(offset + size > inode->i_size) {
+        size = inode->i_size - offset;
+    }
+
+    uint32_t block = offset / data->block_size;
+    uint32_t last_block = (offset + size - 1) / data->block_size;
+
+    // Physically adjacent blocks are prefetched with a single request, holes are skipped
+    while(block <= last_block) {
+        uint32_t physical_block = ext2_inode_block(node->filesystem, inode, &file->map, block);
+
+        if(physical_block == 0) {
+            block++;
+            continue;
+        }
+
+        uint32_t run = 1;
+
+        while(block + run <= last_block && ext2_inode_block(node->filesystem, inode, &file->map, block + run) == physical_block + run) {
+            run++;
+        }
+
+        node->filesystem->volume->operations->prefetch(node->filesystem->volume, physical_block * data->block_size, run * data->block_size);
+
+        block += run;
+    }
+
+    return 0;
+}
+
+static int32_t ext2_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size) {
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    ext2_inode_t* inode = ext2_inode_get(node->filesystem, node->inode);
+
+    if(!inode) {
+        return -1;
+    }
+
+    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!block_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    // The position is the byte offset into the directory, i.e. a block and an offset within it
+    ext2_block_map_t map = { 0 };
+    size_t filled = 0;
+    bool full = false;
+
+    while(!full && *position < inode->i_size) {
+        uint32_t b = *position / data->block_size;
+        uint32_t start = *position % data->block_size;
+        uint32_t physical_block = ext2_inode_block(node->filesystem, inode, &map, b);
+
+        if(physical_block == 0 || ext2_read_block(node->filesystem, physical_block, block_buffer) != data->block_size) {
+            *position = (b + 1) * data->block_size;
+            continue;
+        }
+
+        /*
+         * Entries may have been merged since the position was handed out, so the block is walked
+         * from its start and reading resumes at the first entry at or after the position.
+         */
+        uint32_t offset = 0;
+
+        while(offset < data->block_size) {
+            ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + offset);
+
+            // A short record length would loop forever on a corrupt directory block.
+            if(entry->rec_len < sizeof(ext2_dir_entry_t) || offset + entry->rec_len > data->block_size) {
+                offset = data->block_size;
+                break;
+            }
+
+            if(offset >= start && entry->inode != 0) {
+                uint32_t next = b * data->block_size + offset + entry->rec_len;
+                size_t length = vfs_dirent_fill((uint8_t*) buffer + filled, size - filled,
+                                                (const char*) entry + sizeof(ext2_dir_entry_t), entry->name_len,
+                                                entry->inode, ext2_dir_vfs_type(data, entry->file_type), next);
+
+                if(length == 0) {
+                    full = true;
+                    break;
+                }
+
+                filled += length;
+            }
+
+            offset += entry->rec_len;
+        }
+
+        *position = b * data->block_size + offset;
+    }
+
+    kfree(block_buffer);
+    ext2_block_map_release(&map);
+    ext2_inode_put(node->filesystem, node->inode);
+
+    if(full && filled == 0) {
+        return -1;
+    }
+
+    return (int32_t) filled;
+}
+
+static vfs_node_t* ext2_finddir(vfs_node_t* node, char* name) {
+    uint32_t child_inode_no = ext2_dir_lookup(node->filesystem, node->inode, name);
+
+    if(child_inode_no == 0) {
+        return NULL;
+    }
+
+    ext2_inode_t* child_inode = ext2_inode_get(node->filesystem, child_inode_no);
+
+    if(!child_inode) {
+        return NULL;
+    }
+
+    vfs_node_t* child = ext2_build_node(node->filesystem, child_inode_no, name, child_inode);
+
+    child->parent_inode = node->inode;
+
+    ext2_inode_put(node->filesystem, child_inode_no);
+
+    return child;
+}
+
+/**
+ * Find the inode number of a directory entry by name. Returns 0 if there is no such entry.
+ * Indexed directories are looked up through their hash tree, all others are scanned.
+ */
+static uint32_t ext2_dir_lookup(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    ext2_inode_t* inode = ext2_inode_get(filesystem, dir_no);
+
+    if(!inode) {
+        return 0;
+    }
+
+    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!block_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    uint32_t total_blocks = (inode->i_size + data->block_size - 1) / data->block_size;
+    ext2_block_map_t map = { 0 };
+    size_t name_len = strlen(name);
+    uint32_t result = 0;
+    bool indexed = false;
+
+    if((inode->i_flags & EXT2_INDEX_FL) && (data->superblock.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX)) {
+        indexed = ext2_dx_lookup(filesystem, inode, &map, name, name_len, block_buffer, &result);
+    }
+
+    // Fall back to a linear scan if the directory has no usable index
+    for(uint32_t b = 0; !indexed && b < total_blocks && result == 0; b++) {
+        uint32_t physical_block = ext2_inode_block(filesystem, inode, &map, b);
+
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
+            continue;
+        }
+
+        result = ext2_dir_block_find(data, block_buffer, name, name_len);
+    }
+
+    kfree(block_buffer);
+    ext2_block_map_release(&map);
+    ext2_inode_put(filesystem, dir_no);
+
+    return result;
+}
+
+/**
+ * Find an entry by name within a single directory block.
+ */
+static uint32_t ext2_dir_block_find(ext2_fs_t* data, uint8_t* block_buffer, const char* name, size_t name_len) {
+    uint32_t position = 0;
+
+    while(position < data->block_size) {
+        ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + position);
+
+        if(entry->rec_len == 0) {
+            break;
+        }
+
+        if(entry->inode != 0 && entry->name_len == name_len &&
+           memcmp(name, (uint8_t*) entry + sizeof(ext2_dir_entry_t), name_len) == 0) {
+            return entry->inode;
+        }
+
+        position += entry->rec_len;
+    }
+
+    return 0;
+}
+
+/**
+ * Look up a name through the hash tree of an indexed directory. The tree is walked from the
+ * root down to the leaf block whose hash range covers the name's hash, so only one block per
+ * level and the leaf are read. Returns false if the index can't be used, in which case the
+ * caller has to scan the directory instead.
+ */
+static bool ext2_dx_lookup(vfs_filesystem_t* filesystem, ext2_inode_t* inode, ext2_block_map_t* map,
+                           const char* name, size_t name_len, uint8_t* block_buffer, uint32_t* inode_no) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    uint32_t physical_block = ext2_inode_block(filesystem, inode, map, 0);
+
+    if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
+        return false;
+    }
+
+    // The root info follows the "." entry and the ".." header and name
+    uint32_t root_offset = EXT2_DIR_REC_LEN(1) + EXT2_DIR_REC_LEN(2);
+    ext2_dx_root_info_t* info = (ext2_dx_root_info_t*) (block_buffer + root_offset);
+
+    if(info->reserved_zero != 0 || info->info_length < sizeof(ext2_dx_root_info_t) ||
+       info->indirect_levels >= EXT2_HTREE_MAX_LEVELS) {
+        return false;
+    }
+
+    uint32_t hash_version = info->hash_version;
+
+    if(hash_version <= EXT2_HASH_TEA && (data->superblock.s_flags & EXT2_FLAGS_UNSIGNED_HASH)) {
+        hash_version += EXT2_HASH_LEGACY_UNSIGNED;
+    }
+
+    uint32_t hash;
+
+    if(ext2_dx_hash(data, hash_version, name, name_len, &hash) != 0) {
+        return false;
+    }
+
+    // The index blocks are kept while the leaves are read, to follow hash collisions
+    uint8_t* index_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!index_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    memcpy(index_buffer, block_buffer, data->block_size);
+
+    uint32_t entries_offset = root_offset + info->info_length;
+    uint32_t levels = info->indirect_levels;
+    ext2_dx_entry_t* entries = NULL;
+    uint32_t count = 0;
+    uint32_t at = 0;
+    bool usable = true;
+
+    for(uint32_t level = 0; level <= levels; level++) {
+        ext2_dx_countlimit_t* countlimit = (ext2_dx_countlimit_t*) (index_buffer + entries_offset);
+
+        entries = (ext2_dx_entry_t*) (index_buffer + entries_offset);
+        count = countlimit->count;
+
+        if(count == 0 || count > countlimit->limit ||
+           entries_offset + count * sizeof(ext2_dx_entry_t) > data->block_size) {
+            usable = false;
+            break;
+        }
+
+        // Find the last entry whose hash is not above the searched one, the first is implicitly 0
+        uint32_t low = 1;
+        uint32_t high = count;
+
+        while(low < high) {
+            uint32_t middle = low + (high - low) / 2;
+
+            if(entries[middle].hash > hash) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+
+        at = low - 1;
+
+        if(level == levels) {
+            break;
+        }
+
+        // Index nodes start with an empty entry spanning the block
+        physical_block = ext2_inode_block(filesystem, inode, map, entries[at].block & 0x0FFFFFFF);
+
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, index_buffer) != data->block_size) {
+            usable = false;
+            break;
+        }
+
+        entries_offset = sizeof(ext2_dir_entry_t);
+    }
+
+    *inode_no = 0;
+
+    while(usable) {
+        physical_block = ext2_inode_block(filesystem, inode, map, entries[at].block & 0x0FFFFFFF);
+
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
+            usable = false;
+            break;
+        }
+
+        *inode_no = ext2_dir_block_find(data, block_buffer, name, name_len);
+
+        // Names with the same hash may continue in the next leaf, which is then marked by the
+        // lowest hash bit. Continuations across index nodes are not followed.
+        if(*inode_no != 0 || at + 1 >= count || (entries[at + 1].hash & ~1U) != hash) {
+            break;
+        }
+
+        at++;
+    }
+
+    kfree(index_buffer);
+
+    return usable;
+}
+
+/**
+ * Compute the directory index hash of a name. Returns -1 for unknown hash versions.
+ */
+static int32_t ext2_dx_hash(ext2_fs_t* data, uint32_t version, const char* name, size_t name_len, uint32_t* hash) {
+    uint32_t buffer[4] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+    uint32_t input[8];
+    bool unsigned_chars = version >= EXT2_HASH_LEGACY_UNSIGNED;
+
+    // A seed of all zeros means the default seed
+    for(size_t index = 0; index < 4; index++) {
+        if(data->superblock.s_hash_seed[index] != 0) {
+            for(size_t word = 0; word < 4; word++) {
+                buffer[word] = data->superblock.s_hash_seed[word];
+            }
+
+            break;
+        }
+    }
+
+    switch(version) {
+        case EXT2_HASH_LEGACY:
+        case EXT2_HASH_LEGACY_UNSIGNED:
+            *hash = ext2_dx_hack_hash(name, name_len, unsigned_chars);
+            break;
+        case EXT2_HASH_HALF_MD4:
+        case EXT2_HASH_HALF_MD4_UNSIGNED:
+            for(size_t offset = 0; offset < name_len; offset += 32) {
+                ext2_dx_str2hashbuf(name + offset, name_len - offset, input, 8, unsigned_chars);
+                ext2_dx_half_md4(buffer, input);
+            }
+
+            *hash = buffer[1];
+            break;
+        case EXT2_HASH_TEA:
+        case EXT2_HASH_TEA_UNSIGNED:
+            for(size_t offset = 0; offset < name_len; offset += 16) {
+                ext2_dx_str2hashbuf(name + offset, name_len - offset, input, 4, unsigned_chars);
+                ext2_dx_tea(buffer, input);
+            }
+
+            *hash = buffer[0];
+            break;
+        default:
+            return -1;
+    }
+
+    // The lowest bit marks collision continuations and the highest hash marks the end
+    *hash &= ~1U;
+
+    if(*hash == 0xFFFFFFFE) {
+        *hash = 0xFFFFFFFC;
+    }
+
+    return 0;
+}
+
+/**
+ * The original hash of directory indexes.
+ */
+static uint32_t ext2_dx_hack_hash(const char* name, size_t name_len, bool unsigned_chars) {
+    uint32_t hash0 = 0x12A3FE2D;
+    uint32_t hash1 = 0x37ABE8F9;
+
+    for(size_t index = 0; index < name_len; index++) {
+        int32_t c = unsigned_chars ? (int32_t) (uint8_t) name[index] : (int32_t) (int8_t) name[index];
+        uint32_t hash = hash1 + (hash0 ^ (uint32_t) (c * 7152373));
+
+        if(hash & 0x80000000) {
+            hash -= 0x7FFFFFFF;
+        }
+
+        hash1 = hash0;
+        hash0 = hash;
+    }
+
+    return hash0 << 1;
+}
+
+/**
+ * Pack up to count words of a name into the input of a hash transform, padding the rest with
+ * a pattern of the remaining length.
+ */
+static void ext2_dx_str2hashbuf(const char* name, size_t name_len, uint32_t* input, int32_t count, bool unsigned_chars) {
+    uint32_t pad = (uint32_t) name_len | ((uint32_t) name_len << 8);
+
+    pad |= pad << 16;
+
+    uint32_t value = pad;
+
+    if(name_len > (size_t) count * 4) {
+        name_len = count * 4;
+    }
+
+    for(size_t index = 0; index < name_len; index++) {
+        int32_t c = unsigned_chars ? (int32_t) (uint8_t) name[index] : (int32_t) (int8_t) name[index];
+
+        value = (uint32_t) c + (value << 8);
+
+        if(index % 4 == 3) {
+            *input++ = value;
+            value = pad;
+            count--;
+        }
+    }
+
+    if(--count >= 0) {
+        *input++ = value;
+    }
+
+    while(--count >= 0) {
+        *input++ = pad;
+    }
+}
+
+static uint32_t ext2_dx_rol(uint32_t value, uint32_t shift) {
+    return (value << shift) | (value >> (32 - shift));
+}
+
+static uint32_t ext2_dx_f(uint32_t x, uint32_t y, uint32_t z) {
+    return z ^ (x & (y ^ z));
+}
+
+static uint32_t ext2_dx_g(uint32_t x, uint32_t y, uint32_t z) {
+    return (x & y) + ((x ^ y) & z);
+}
+
+static uint32_t ext2_dx_h(uint32_t x, uint32_t y, uint32_t z) {
+    return x ^ y ^ z;
+}
+
+/**
+ * Reduced MD4 transform with three rounds of eight steps.
+ */
+static void ext2_dx_half_md4(uint32_t buffer[4], const uint32_t input[8]) {
+    const uint32_t k2 = 013240474631U;
+    const uint32_t k3 = 015666365641U;
+
+    uint32_t a = buffer[0];
+    uint32_t b = buffer[1];
+    uint32_t c = buffer[2];
+    uint32_t d = buffer[3];
+
+    a = ext2_dx_rol(a + ext2_dx_f(b, c, d) + input[0], 3);
+    d = ext2_dx_rol(d + ext2_dx_f(a, b, c) + input[1], 7);
+    c = ext2_dx_rol(c + ext2_dx_f(d, a, b) + input[2], 11);
+    b = ext2_dx_rol(b + ext2_dx_f(c, d, a) + input[3], 19);
+    a = ext2_dx_rol(a + ext2_dx_f(b, c, d) + input[4], 3);
+    d = ext2_dx_rol(d + ext2_dx_f(a, b, c) + input[5], 7);
+    c = ext2_dx_rol(c + ext2_dx_f(d, a, b) + input[6], 11);
+    b = ext2_dx_rol(b + ext2_dx_f(c, d, a) + input[7], 19);
+
+    a = ext2_dx_rol(a + ext2_dx_g(b, c, d) + input[1] + k2, 3);
+    d = ext2_dx_rol(d + ext2_dx_g(a, b, c) + input[3] + k2, 5);
+    c = ext2_dx_rol(c + ext2_dx_g(d, a, b) + input[5] + k2, 9);
+    b = ext2_dx_rol(b + ext2_dx_g(c, d, a) + input[7] + k2, 13);
+    a = ext2_dx_rol(a + ext2_dx_g(b, c, d) + input[0] + k2, 3);
+    d = ext2_dx_rol(d + ext2_dx_g(a, b, c) + input[2] + k2, 5);
+    c = ext2_dx_rol(c + ext2_dx_g(d, a, b) + input[4] + k2, 9);
+    b = ext2_dx_rol(b + ext2_dx_g(c, d, a) + input[6] + k2, 13);
+
+    a = ext2_dx_rol(a + ext2_dx_h(b, c, d) + input[3] + k3, 3);
+    d = ext2_dx_rol(d + ext2_dx_h(a, b, c) + input[7] + k3, 9);
+    c = ext2_dx_rol(c + ext2_dx_h(d, a, b) + input[2] + k3, 11);
+    b = ext2_dx_rol(b + ext2_dx_h(c, d, a) + input[6] + k3, 15);
+    a = ext2_dx_rol(a + ext2_dx_h(b, c, d) + input[1] + k3, 3);
+    d = ext2_dx_rol(d + ext2_dx_h(a, b, c) + input[5] + k3, 9);
+    c = ext2_dx_rol(c + ext2_dx_h(d, a, b) + input[0] + k3, 11);
+    b = ext2_dx_rol(b + ext2_dx_h(c, d, a) + input[4] + k3, 15);
+
+    buffer[0] += a;
+    buffer[1] += b;
+    buffer[2] += c;
+    buffer[3] += d;
+}
+
+/**
+ * Tiny Encryption Algorithm transform with 16 cycles.
+ */
+static void ext2_dx_tea(uint32_t buffer[4], const uint32_t input[4]) {
+    uint32_t sum = 0;
+    uint32_t b0 = buffer[0];
+    uint32_t b1 = buffer[1];
+
+    for(size_t cycle = 0; cycle < 16; cycle++) {
+        sum += 0x9E3779B9;
+        b0 += ((b1 << 4) + input[0]) ^ (b1 + sum) ^ ((b1 >> 5) + input[1]);
+        b1 += ((b0 << 4) + input[2]) ^ (b0 + sum) ^ ((b0 >> 5) + input[3]);
+    }
+
+    buffer[0] += b0;
+    buffer[1] += b1;
+}
+
+/**
+ * Add an entry to a directory. The entry is placed into the slack space of an existing entry
+ * if there is enough, otherwise a new block is appended to the directory. The hash index of
+ * the directory is not maintained, so it is dropped and the directory is scanned from then on.
+ */
+static int32_t ext2_dir_add(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name, uint32_t inode_no, uint8_t file_type) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    ext2_inode_t* inode = ext2_inode_get(filesystem, dir_no);
+
+    if(!inode) {
+        return -1;
+    }
+
+    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!block_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    uint32_t total_blocks = inode->i_size / data->block_size;
+    ext2_block_map_t map = { 0 };
+    uint16_t needed = EXT2_DIR_REC_LEN(strlen(name));
+    int32_t result = -1;
+
+    for(uint32_t b = 0; b < total_blocks && result != 0; b++) {
+        uint32_t physical_block = ext2_inode_block(filesystem, inode, &map, b);
+
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
+            continue;
+        }
+
+        uint32_t position = 0;
+
+        while(position < data->block_size) {
+            ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + position);
+
+            if(entry->rec_len == 0) {
+                break;
+            }
+
+            uint16_t used = entry->inode != 0 ? EXT2_DIR_REC_LEN(entry->name_len) : 0;
+
+            if(entry->rec_len >= used + needed) {
+                ext2_dir_entry_t* target = entry;
+
+                // Split the slack space off the existing entry
+                if(used > 0) {
+                    target = (ext2_dir_entry_t*) (block_buffer + position + used);
+                    target->rec_len = entry->rec_len - used;
+                    entry->rec_len = used;
+                }
+
+                ext2_dir_fill(target, name, inode_no, file_type);
+                ext2_write_block(filesystem, physical_block, block_buffer);
+
+                result = 0;
+                break;
+            }
+
+            position += entry->rec_len;
+        }
+    }
+
+    if(result != 0) {
+        uint32_t block = ext2_alloc_block(filesystem, ext2_block_goal(filesystem, dir_no, inode, &map, total_blocks));
+
+        if(block != 0) {
+            ext2_dir_entry_t* entry = (ext2_dir_entry_t*) block_buffer;
+
+            memset(block_buffer, 0, data->block_size);
+
+            entry->rec_len = data->block_size;
+            ext2_dir_fill(entry, name, inode_no, file_type);
+            ext2_write_block(filesystem, block, block_buffer);
+
+            if(ext2_set_inode_block(filesystem, inode, &map, total_blocks, block) == 0) {
+                inode->i_blocks += data->block_size / 512;
+                inode->i_size += data->block_size;
+
+                ext2_write_inode(filesystem, dir_no, inode);
+
+                result = 0;
+            } else {
+                ext2_free_blocks(filesystem, block, 1);
+            }
+        }
+    }
+
+    // Without the flag, the index blocks read as unused entries
+    if(result == 0 && (inode->i_flags & EXT2_INDEX_FL)) {
+        inode->i_flags &= ~EXT2_INDEX_FL;
+        ext2_write_inode(filesystem, dir_no, inode);
+    }
+
+    kfree(block_buffer);
+    ext2_block_map_release(&map);
+    ext2_inode_put(filesystem, dir_no);
+
+    return result;
+}
+
+/**
+ * Remove an entry from a directory by merging it into the preceding entry of its block.
+ * Returns the inode number of the removed entry or 0 if there is no such entry.
+ */
+static uint32_t ext2_dir_remove(vfs_filesystem_t* filesystem, uint32_t dir_no, const char* name) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
+
+    ext2_inode_t* inode = ext2_inode_get(filesystem, dir_no);
+
+    if(!inode) {
+        return 0;
+    }
+
+    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!block_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    uint32_t total_blocks = (inode->i_size + data->block_size - 1) / data->block_size;
+    ext2_block_map_t map = { 0 };
+    size_t name_len = strlen(name);
+    uint32_t result = 0;
+
+    for(uint32_t b = 0; b < total_blocks && result == 0; b++) {
+        uint32_t physical_block = ext2_inode_block(filesystem, inode, &map, b);
+
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
+            continue;
+        }
+
+        ext2_dir_entry_t* previous = NULL;
+        uint32_t position = 0;
+
+        while(position < data->block_size) {
+            ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + position);
+
+            if(entry->rec_len == 0) {
+                break;
+            }
+
+            if(entry->inode != 0 && entry->name_len == name_len &&
+               memcmp(name, (uint8_t*) entry + sizeof(ext2_dir_entry_t), name_len) == 0) {
+                result = entry->inode;
+
+                // The first entry of a block has no predecessor and is only marked unused
+                if(previous) {
+                    previous->rec_len += entry->rec_len;
+                } else {
+                    entry->inode = 0;
                 }
 
-                current++;
+                ext2_write_block(filesystem, physical_block, block_buffer);
+                break;
             }
 
+            previous = entry;
             position += entry->rec_len;
         }
     }
 
     kfree(block_buffer);
-    return NULL;
+    ext2_block_map_release(&map);
+    ext2_inode_put(filesystem, dir_no);
+
+    return result;
 }
 
-static vfs_node_t* ext2_finddir(vfs_node_t* node, char* name) {
-    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+/**
+ * Check if a directory has no entries besides "." and "..".
+ */
+static bool ext2_dir_is_empty(vfs_filesystem_t* filesystem, uint32_t dir_no) {
+    ext2_fs_t* data = (ext2_fs_t*) filesystem->fs_data;
 
-    ext2_inode_t inode;
+    ext2_inode_t* inode = ext2_inode_get(filesystem, dir_no);
 
-    if(ext2_read_inode(node->filesystem, node->inode, &inode) != 0) {
-        return NULL;
+    if(!inode) {
+        return false;
     }
 
     uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
@@ -507,40 +2002,33 @@ static vfs_node_t* ext2_finddir(vfs_node_t* node, char* name) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
-    uint32_t total_blocks = (inode.i_size + data->block_size - 1) / data->block_size;
-    size_t name_len = strlen(name);
+    uint32_t total_blocks = (inode->i_size + data->block_size - 1) / data->block_size;
+    ext2_block_map_t map = { 0 };
+    bool empty = true;
 
-    for(uint32_t b = 0; b < total_blocks; b++) {
-        uint32_t physical_block = ext2_inode_block(node->filesystem, &inode, b);
+    for(uint32_t b = 0; b < total_blocks && empty; b++) {
+        uint32_t physical_block = ext2_inode_block(filesystem, inode, &map, b);
 
-        if(physical_block == 0) {
+        if(physical_block == 0 || ext2_read_block(filesystem, physical_block, block_buffer) != data->block_size) {
             continue;
         }
 
-        ext2_read_block(node->filesystem, physical_block, block_buffer);
-
         uint32_t position = 0;
 
         while(position < data->block_size) {
             ext2_dir_entry_t* entry = (ext2_dir_entry_t*) (block_buffer + position);
+            const char* entry_name = (const char*) entry + sizeof(ext2_dir_entry_t);
 
             if(entry->rec_len == 0) {
                 break;
             }
 
-            if(entry->inode != 0 && entry->name_len == name_len &&
-               memcmp(name, (uint8_t*) entry + sizeof(ext2_dir_entry_t), name_len) == 0) {
-                uint32_t child_inode_no = entry->inode;
-
-                kfree(block_buffer);
-
-                ext2_inode_t child_inode;
-
-                if(ext2_read_inode(node->filesystem, child_inode_no, &child_inode) != 0) {
-                    return NULL;
-                }
+            bool dot = entry->name_len == 1 && entry_name[0] == '.';
+            bool dot_dot = entry->name_len == 2 && entry_name[0] == '.' && entry_name[1] == '.';
 
-                return ext2_build_node(node->filesystem, child_inode_no, name, &child_inode);
+            if(entry->inode != 0 && !dot && !dot_dot) {
+                empty = false;
+                break;
             }
 
             position += entry->rec_len;
@@ -548,35 +2036,429 @@ static vfs_node_t* ext2_finddir(vfs_node_t* node, char* name) {
     }
 
     kfree(block_buffer);
-    return NULL;
+    ext2_block_map_release(&map);
+    ext2_inode_put(filesystem, dir_no);
+
+    return empty;
+}
+
+static void ext2_dir_fill(ext2_dir_entry_t* entry, const char* name, uint32_t inode_no, uint8_t file_type) {
+    size_t name_len = strlen(name);
+
+    entry->inode = inode_no;
+    entry->name_len = name_len;
+    entry->file_type = file_type;
+
+    memcpy((uint8_t*) entry + sizeof(ext2_dir_entry_t), name, name_len);
+}
+
+static uint8_t ext2_dir_file_type(ext2_fs_t* data, uint16_t mode) {
+    // Without the filetype feature the field is the upper byte of the name length
+    if(!(data->superblock.s_feature_incompat & EXT2_FEATURE_INCOMPAT_FILETYPE)) {
+        return EXT2_FT_UNKNOWN;
+    }
+
+    switch(mode & EXT2_S_IFMT) {
+        case EXT2_S_IFREG:
+            return EXT2_FT_REG_FILE;
+        case EXT2_S_IFDIR:
+            return EXT2_FT_DIR;
+        case EXT2_S_IFLNK:
+            return EXT2_FT_SYMLINK;
+        default:
+            return EXT2_FT_UNKNOWN;
+    }
+}
+
+static uint8_t ext2_dir_vfs_type(ext2_fs_t* data, uint8_t file_type) {
+    if(!(data->superblock.s_feature_incompat & EXT2_FEATURE_INCOMPAT_FILETYPE)) {
+        return 0;
+    }
+
+    switch(file_type) {
+        case EXT2_FT_REG_FILE:
+            return VFS_FILE;
+        case EXT2_FT_DIR:
+            return VFS_DIRECTORY;
+        case EXT2_FT_SYMLINK:
+            return VFS_SYMLINK;
+        default:
+            return 0;
+    }
 }
 
 static int32_t ext2_rename(vfs_node_t* node, char* new_name) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+    size_t name_len = strlen(new_name);
+
+    // The root directory has no entry of its own that could be renamed
+    if(data->read_only || node->inode == EXT2_ROOT_INODE || node->parent_inode == 0) {
+        return -1;
+    }
+
+    if(name_len == 0 || name_len > EXT2_NAME_LEN || strpbrk(new_name, "/")) {
+        return -1;
+    }
+
+    if(ext2_dir_lookup(node->filesystem, node->parent_inode, new_name) != 0) {
+        return -1;
+    }
+
+    ext2_inode_t* inode = ext2_inode_get(node->filesystem, node->inode);
+
+    if(!inode) {
+        return -1;
+    }
+
+    uint8_t file_type = ext2_dir_file_type(data, inode->i_mode);
+
+    ext2_inode_put(node->filesystem, node->inode);
+
+    // Add the new entry first, so the file is never left without a name
+    if(ext2_dir_add(node->filesystem, node->parent_inode, new_name, node->inode, file_type) != 0) {
+        return -1;
+    }
+
+    ext2_dir_remove(node->filesystem, node->parent_inode, node->name);
+
+    return 0;
 }
 
 static int32_t ext2_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    if(node->inode_data == NULL) {
+        return -1;
+    }
+
+    ext2_file_t* file = (ext2_file_t*) node->inode_data;
+    ext2_inode_t* inode = file->inode;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(data->read_only) {
+        return -1;
+    }
+
+    if(size == 0) {
+        return 0;
+    }
+
+    uint8_t* block_buffer = NULL;
+    size_t bytes_written = 0;
+
+    // Blocks are only written into the block cache here, which absorbs small writes and
+    // writes them back in large batches later on.
+    while(bytes_written < size) {
+        uint32_t file_block = (offset + bytes_written) / data->block_size;
+        uint32_t offset_in_block = (offset + bytes_written) % data->block_size;
+
+        uint32_t chunk = data->block_size - offset_in_block;
+
+        if(chunk > size - bytes_written) {
+            chunk = size - bytes_written;
+        }
+
+        uint32_t physical_block = ext2_inode_block(node->filesystem, inode, &file->map, file_block);
+        bool fresh = false;
+
+        if(physical_block == 0) {
+            uint32_t goal = ext2_block_goal(node->filesystem, node->inode, inode, &file->map, file_block);
+
+            physical_block = ext2_file_alloc_block(node->filesystem, file, goal);
+
+            if(physical_block == 0) {
+                break;
+            }
+
+            if(ext2_set_inode_block(node->filesystem, inode, &file->map, file_block, physical_block) != 0) {
+                ext2_free_blocks(node->filesystem, physical_block, 1);
+                break;
+            }
+
+            inode->i_blocks += data->block_size / 512;
+            fresh = true;
+        }
+
+        if(chunk == data->block_size) {
+            ext2_write_block(node->filesystem, physical_block, (uint8_t*) buffer + bytes_written);
+        } else {
+            if(!block_buffer) {
+                block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+                if(!block_buffer) {
+                    KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+                }
+            }
+
+            // A freshly allocated block has to read back as zeros outside of the written part
+            if(fresh) {
+                memset(block_buffer, 0, data->block_size);
+            } else if(ext2_read_block(node->filesystem, physical_block, block_buffer) != data->block_size) {
+                break;
+            }
+
+            memcpy(block_buffer + offset_in_block, (uint8_t*) buffer + bytes_written, chunk);
+            ext2_write_block(node->filesystem, physical_block, block_buffer);
+        }
+
+        bytes_written += chunk;
+    }
+
+    if(block_buffer) {
+        kfree(block_buffer);
+    }
+
+    if(offset + bytes_written > inode->i_size) {
+        inode->i_size = offset + bytes_written;
+        node->length = inode->i_size;
+    }
+
+    ext2_write_inode(node->filesystem, node->inode, inode);
+
+    if(bytes_written == 0) {
+        return -1;
+    }
+
+    return (int32_t) bytes_written;
+}
+
+static int32_t ext2_truncate(vfs_node_t* node, uint32_t length) {
+    if(node->inode_data == NULL) {
+        return -1;
+    }
+
+    ext2_file_t* file = (ext2_file_t*) node->inode_data;
+    ext2_inode_t* inode = file->inode;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(data->read_only) {
+        return -1;
+    }
+
+    if(length < inode->i_size) {
+        // Clear the tail of the new last block, so a later extension reads back zeros
+        if(length % data->block_size != 0) {
+            uint32_t physical_block = ext2_inode_block(node->filesystem, inode, &file->map, length / data->block_size);
+
+            if(physical_block != 0) {
+                uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+                if(!block_buffer) {
+                    KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+                }
+
+                if(ext2_read_block(node->filesystem, physical_block, block_buffer) == data->block_size) {
+                    memset(block_buffer + length % data->block_size, 0, data->block_size - length % data->block_size);
+                    ext2_write_block(node->filesystem, physical_block, block_buffer);
+                }
+
+                kfree(block_buffer);
+            }
+        }
+
+        ext2_free_file_blocks(node->filesystem, inode, (length + data->block_size - 1) / data->block_size);
+        ext2_block_map_invalidate(&file->map);
+    }
+
+    // Growing a file just leaves a hole
+    inode->i_size = length;
+    node->length = length;
+
+    return ext2_write_inode(node->filesystem, node->inode, inode);
 }
 
 static int32_t ext2_create(vfs_node_t* node, char* name, uint32_t permissions) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+    size_t name_len = strlen(name);
+
+    if(data->read_only || name_len == 0 || name_len > EXT2_NAME_LEN || strpbrk(name, "/")) {
+        return -1;
+    }
+
+    if(ext2_dir_lookup(node->filesystem, node->inode, name) != 0) {
+        return -1;
+    }
+
+    uint32_t inode_no = ext2_alloc_inode(node->filesystem, node->inode, false);
+
+    if(inode_no == 0) {
+        return -1;
+    }
+
+    ext2_inode_t inode;
+
+    memset(&inode, 0, sizeof(ext2_inode_t));
+
+    inode.i_mode = EXT2_S_IFREG | (permissions & 0x0FFF);
+    inode.i_links_count = 1;
+
+    if(ext2_write_inode(node->filesystem, inode_no, &inode) != 0 ||
+       ext2_dir_add(node->filesystem, node->inode, name, inode_no, ext2_dir_file_type(data, inode.i_mode)) != 0) {
+        ext2_free_inode(node->filesystem, inode_no, &inode, false);
+        return -1;
+    }
+
+    return 0;
 }
 
 static int32_t ext2_unlink(vfs_node_t* node, char* name) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(data->read_only) {
+        return -1;
+    }
+
+    uint32_t inode_no = ext2_dir_lookup(node->filesystem, node->inode, name);
+
+    if(inode_no == 0) {
+        return -1;
+    }
+
+    ext2_inode_t* inode = ext2_inode_get(node->filesystem, inode_no);
+
+    if(!inode) {
+        return -1;
+    }
+
+    // Directories are removed with rmdir
+    if((inode->i_mode & EXT2_S_IFMT) == EXT2_S_IFDIR) {
+        ext2_inode_put(node->filesystem, inode_no);
+        return -1;
+    }
+
+    ext2_dir_remove(node->filesystem, node->inode, name);
+
+    if(inode->i_links_count > 0) {
+        inode->i_links_count--;
+    }
+
+    // The inode and its blocks are released with the last link
+    if(inode->i_links_count == 0) {
+        ext2_free_file_blocks(node->filesystem, inode, 0);
+        inode->i_size = 0;
+        ext2_free_inode(node->filesystem, inode_no, inode, false);
+    } else {
+        ext2_write_inode(node->filesystem, inode_no, inode);
+    }
+
+    ext2_inode_put(node->filesystem, inode_no);
+
+    return 0;
 }
 
 static int32_t ext2_mkdir(vfs_node_t* node, char* name, uint32_t permissions) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+    size_t name_len = strlen(name);
+
+    if(data->read_only || name_len == 0 || name_len > EXT2_NAME_LEN || strpbrk(name, "/")) {
+        return -1;
+    }
+
+    if(ext2_dir_lookup(node->filesystem, node->inode, name) != 0) {
+        return -1;
+    }
+
+    uint32_t inode_no = ext2_alloc_inode(node->filesystem, node->inode, true);
+
+    if(inode_no == 0) {
+        return -1;
+    }
+
+    uint32_t group = (inode_no - 1) / data->inodes_per_group;
+    uint32_t block = ext2_alloc_block(node->filesystem, data->superblock.s_first_data_block + group * data->blocks_per_group);
+
+    if(block == 0) {
+        ext2_free_inode(node->filesystem, inode_no, NULL, true);
+        return -1;
+    }
+
+    ext2_inode_t inode;
+
+    memset(&inode, 0, sizeof(ext2_inode_t));
+
+    inode.i_mode = EXT2_S_IFDIR | (permissions & 0x0FFF);
+    inode.i_links_count = 2;
+    inode.i_size = data->block_size;
+    inode.i_blocks = data->block_size / 512;
+    inode.i_block[0] = block;
+
+    // The first block holds the "." and ".." entries, with ".." spanning the rest of the block
+    uint8_t* block_buffer = (uint8_t*) kmalloc(data->block_size);
+
+    if(!block_buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    memset(block_buffer, 0, data->block_size);
+
+    ext2_dir_entry_t* dot = (ext2_dir_entry_t*) block_buffer;
+    ext2_dir_entry_t* dot_dot = (ext2_dir_entry_t*) (block_buffer + EXT2_DIR_REC_LEN(1));
+
+    dot->rec_len = EXT2_DIR_REC_LEN(1);
+    ext2_dir_fill(dot, ".", inode_no, ext2_dir_file_type(data, inode.i_mode));
+
+    dot_dot->rec_len = data->block_size - EXT2_DIR_REC_LEN(1);
+    ext2_dir_fill(dot_dot, "..", node->inode, ext2_dir_file_type(data, inode.i_mode));
+
+    ext2_write_block(node->filesystem, block, block_buffer);
+    kfree(block_buffer);
+
+    if(ext2_write_inode(node->filesystem, inode_no, &inode) != 0 ||
+       ext2_dir_add(node->filesystem, node->inode, name, inode_no, ext2_dir_file_type(data, inode.i_mode)) != 0) {
+        ext2_free_blocks(node->filesystem, block, 1);
+        ext2_free_inode(node->filesystem, inode_no, &inode, true);
+        return -1;
+    }
+
+    // The ".." entry of the new directory links back to the parent
+    ext2_inode_t* parent = ext2_inode_get(node->filesystem, node->inode);
+
+    if(parent) {
+        parent->i_links_count++;
+        ext2_write_inode(node->filesystem, node->inode, parent);
+        ext2_inode_put(node->filesystem, node->inode);
+    }
+
+    return 0;
 }
 
 static int32_t ext2_rmdir(vfs_node_t* node, char* name) {
-    // Unsupported because the driver is read-only for now.
-    return -1;
+    ext2_fs_t* data = (ext2_fs_t*) node->filesystem->fs_data;
+
+    if(data->read_only || strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+        return -1;
+    }
+
+    uint32_t inode_no = ext2_dir_lookup(node->filesystem, node->inode, name);
+
+    if(inode_no == 0) {
+        return -1;
+    }
+
+    ext2_inode_t* inode = ext2_inode_get(node->filesystem, inode_no);
+
+    if(!inode) {
+        return -1;
+    }
+
+    if((inode->i_mode & EXT2_S_IFMT) != EXT2_S_IFDIR || !ext2_dir_is_empty(node->filesystem, inode_no)) {
+        ext2_inode_put(node->filesystem, inode_no);
+        return -1;
+    }
+
+    ext2_dir_remove(node->filesystem, node->inode, name);
+
+    ext2_free_file_blocks(node->filesystem, inode, 0);
+    inode->i_size = 0;
+    ext2_free_inode(node->filesystem, inode_no, inode, true);
+
+    ext2_inode_put(node->filesystem, inode_no);
+
+    ext2_inode_t* parent = ext2_inode_get(node->filesystem, node->inode);
+
+    if(parent) {
+        parent->i_links_count--;
+        ext2_write_inode(node->filesystem, node->inode, parent);
+        ext2_inode_put(node->filesystem, node->inode);
+    }
+
+    return 0;
 }
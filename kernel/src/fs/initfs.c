@@ -10,12 +10,13 @@ static int32_t initfs_open(vfs_node_t* node);
 static int32_t initfs_close(vfs_node_t* node);
 static int32_t initfs_read(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
 static int32_t initfs_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer);
+static int32_t initfs_readahead(vfs_node_t* node, uint32_t offset, size_t size);
 static int32_t initfs_create(vfs_node_t* node, char* name, uint32_t permissions);
 static int32_t initfs_unlink(vfs_node_t* node, char* name);
 
 static int32_t initfs_mkdir(vfs_node_t* node, char* name, uint32_t permissions);
 static int32_t initfs_rmdir(vfs_node_t* node, char* name);
-static vfs_dirent_t* initfs_readdir(vfs_node_t* node, uint32_t index);
+static int32_t initfs_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size);
 static vfs_node_t* initfs_finddir(vfs_node_t* node, char* name);
 
 static int32_t initfs_rename(vfs_node_t* node, char* new_name);
@@ -26,6 +27,8 @@ static vfs_node_operations_t initfs_directory_operations = {
     .rename = &initfs_rename,
     .read = NULL,
     .write = NULL,
+    .readahead = NULL,
+    .truncate = NULL,
     .create = NULL,
     .unlink = NULL,
     .mkdir = &initfs_mkdir,
@@ -40,6 +43,8 @@ static vfs_node_operations_t initfs_file_operations = {
     .rename = &initfs_rename,
     .read = &initfs_read,
     .write = &initfs_write,
+    .readahead = &initfs_readahead,
+    .truncate = NULL,
     .create = &initfs_create,
     .unlink = &initfs_unlink,
     .mkdir = NULL,
@@ -78,28 +83,16 @@ vfs_filesystem_t* initfs_init(volume_t* volume) {
 
     initfs_mountpoint->operations->mount = &initfs_mount;
     initfs_mountpoint->operations->unmount = &initfs_unmount;
+    initfs_mountpoint->operations->sync = NULL;
 
     return initfs_mountpoint;
 }
 
 static int32_t initfs_mount(vfs_filesystem_t* filesystem) {
-    vfs_node_t* root = (vfs_node_t*) kmalloc(sizeof(vfs_node_t));
-
-    if(!root) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-    }
-
-    strncpy(root->name, "/", 256);
+    vfs_node_t* root = vfs_node_create(filesystem, INITFS_ROOT_INODE, "/");
 
     root->type = VFS_DIRECTORY;
-    root->permissions = 0;
-    root->uid = 0;
-    root->gid = 0;
-    root->inode = 0;
-    root->length = 0;
-    root->link = NULL;
     root->operations = &initfs_directory_operations;
-    root->filesystem = filesystem;
 
     filesystem->root = root;
 
@@ -107,8 +100,7 @@ static int32_t initfs_mount(vfs_filesystem_t* filesystem) {
 }
 
 static int32_t initfs_unmount(vfs_filesystem_t* filesystem) {
-    kfree(filesystem->root->name);
-    kfree(filesystem->root);
+    vfs_node_put(filesystem->root);
     kfree(filesystem);
 
     return 0;
@@ -123,7 +115,7 @@ static int32_t initfs_open(vfs_node_t* node) {
     initfs_header_t initfs_header;
     node->filesystem->volume->operations->read(node->filesystem->volume, 0, sizeof(initfs_header_t), &initfs_header);
 
-    if(node->inode >= initfs_header.n_files) {
+    if(node->inode == INITFS_ROOT_INODE || INITFS_FILE_INDEX(node->inode) >= initfs_header.n_files) {
         return -1;
     }
 
@@ -133,9 +125,10 @@ static int32_t initfs_open(vfs_node_t* node) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
-    node->filesystem->volume->operations->read(node->filesystem->volume, sizeof(initfs_header_t) + node->inode * sizeof(initfs_file_header_t), sizeof(initfs_file_header_t), file_header);
+    node->filesystem->volume->operations->read(node->filesystem->volume, sizeof(initfs_header_t) + INITFS_FILE_INDEX(node->inode) * sizeof(initfs_file_header_t), sizeof(initfs_file_header_t), file_header);
 
     if(file_header->magic != INITFS_FILE_HEADER_MAGIC) {
+        kfree(file_header);
         return -1;
     }
 
@@ -147,6 +140,7 @@ static int32_t initfs_open(vfs_node_t* node) {
 static int32_t initfs_close(vfs_node_t* node) {
     // This applys only to file nodes
     kfree(node->inode_data);
+    node->inode_data = NULL;
 
     return 0;
 }
@@ -176,6 +170,27 @@ static int32_t initfs_read(vfs_node_t* node, uint32_t offset, size_t size, void*
     return size;
 }
 
+static int32_t initfs_readahead(vfs_node_t* node, uint32_t offset, size_t size) {
+    if(node->inode_data == NULL) {
+        return -1;
+    }
+
+    initfs_file_header_t* file_header = (initfs_file_header_t*) node->inode_data;
+
+    if(offset >= file_header->length) {
+        return 0;
+    }
+
+    if(offset + size > file_header->length) {
+        size = file_header->length - offset;
+    }
+
+    // Files are stored contiguously, so the range maps directly to the volume
+    node->filesystem->volume->operations->prefetch(node->filesystem->volume, file_header->offset + offset, size);
+
+    return 0;
+}
+
 static int32_t initfs_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer) {
     // Unsupported because the file system is read-only
     return -1;
@@ -201,31 +216,40 @@ static int32_t initfs_rmdir(vfs_node_t* node, char* name) {
     return -1;
 }
 
-static vfs_dirent_t* initfs_readdir(vfs_node_t* node, uint32_t index) {
+static int32_t initfs_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size) {
     initfs_header_t initfs_header;
     node->filesystem->volume->operations->read(node->filesystem->volume, 0, sizeof(initfs_header_t), &initfs_header);
 
-    if(index >= initfs_header.n_files) {
-        return NULL;
-    }
+    // The position is the index of the next file
+    size_t filled = 0;
 
-    vfs_dirent_t* dirent = (vfs_dirent_t*) kmalloc(sizeof(vfs_dirent_t));
+    while(*position < initfs_header.n_files) {
+        initfs_file_header_t file_header;
+        node->filesystem->volume->operations->read(node->filesystem->volume, sizeof(initfs_header_t) + *position * sizeof(initfs_file_header_t), sizeof(initfs_file_header_t), &file_header);
 
-    if(!dirent) {
-        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-    }
+        if(file_header.magic != INITFS_FILE_HEADER_MAGIC) {
+            return -1;
+        }
 
-    initfs_file_header_t file_header;
-    node->filesystem->volume->operations->read(node->filesystem->volume, sizeof(initfs_header_t) + index * sizeof(initfs_file_header_t), sizeof(initfs_file_header_t), &file_header);
+        // Names filling the whole field are not NUL terminated
+        uint8_t name_len = 0;
 
-    if(file_header.magic != INITFS_FILE_HEADER_MAGIC) {
-        return NULL;
-    }
+        while(name_len < sizeof(file_header.name) && file_header.name[name_len] != '\0') {
+            name_len++;
+        }
 
-    strncpy(dirent->name, (const char*) file_header.name, 256);
-    dirent->inode = index;
+        size_t length = vfs_dirent_fill((uint8_t*) buffer + filled, size - filled, (const char*) file_header.name,
+                                        name_len, INITFS_FILE_INODE(*position), VFS_FILE, *position + 1);
+
+        if(length == 0) {
+            return filled > 0 ? (int32_t) filled : -1;
+        }
 
-    return dirent;
+        filled += length;
+        (*position)++;
+    }
+
+    return (int32_t) filled;
 }
 
 static vfs_node_t* initfs_finddir(vfs_node_t* node, char* name) {
@@ -237,23 +261,12 @@ static vfs_node_t* initfs_finddir(vfs_node_t* node, char* name) {
         node->filesystem->volume->operations->read(node->filesystem->volume, sizeof(initfs_header_t) + index * sizeof(initfs_file_header_t), sizeof(initfs_file_header_t), &file_header);
 
         if(!strcmp(name, file_header.name)) {
-            vfs_node_t* new_node = (vfs_node_t*) kmalloc(sizeof(vfs_node_t));
-
-            if(!new_node) {
-                KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-            }
-
-            strncpy(new_node->name, (const char*) file_header.name, 256);
+            vfs_node_t* new_node = vfs_node_create(node->filesystem, INITFS_FILE_INODE(index), (const char*) file_header.name);
 
             new_node->type = VFS_FILE;
-            new_node->permissions = 0;
-            new_node->uid = 0;
-            new_node->gid = 0;
-            new_node->inode = index;
             new_node->length = file_header.length;
-            new_node->link = NULL;
+            new_node->parent_inode = INITFS_ROOT_INODE;
             new_node->operations = &initfs_file_operations;
-            new_node->filesystem = node->filesystem;
 
             return new_node;
         }
@@ -56,6 +56,8 @@ int32_t mnt_volume_unmount(char drive) {
         return -1;
     }
 
+    vfs_dcache_purge(mnt_mountpoints[index]);
+
     if(mnt_mountpoints[index]->operations->unmount(mnt_mountpoints[index]) != 0) {
         return -1;
     }
@@ -89,6 +91,18 @@ const vfs_filesystem_t* mnt_get_drive(char drive) {
     return mnt_mountpoints[index];
 }
 
+int32_t mnt_sync(void) {
+    int32_t result = 0;
+
+    for(size_t index = 0; index < FS_VOLUME_MAX_MOUNTPOINTS; index++) {
+        if(mnt_mountpoints[index] && vfs_sync(mnt_mountpoints[index]) != 0) {
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
 static int32_t mnt_get_drive_index(char drive) {
     if(drive >= 'a' && drive <= 'z') {
         return drive - 'a';
@@ -2,7 +2,86 @@
 #include <memory/kheap.h>
 #include <system/kpanic.h>
 
-static vfs_node_t* vfs_findpath_recursive(vfs_node_t* node, char* path);
+/**
+ * Entry of the dentry cache. A NULL node marks a name that does not exist.
+ */
+typedef struct vfs_dentry vfs_dentry_t;
+
+struct vfs_dentry {
+    vfs_filesystem_t* filesystem;
+    uint32_t parent_inode;
+    vfs_node_t* node;
+    vfs_dentry_t* hash_next;
+    vfs_dentry_t* lru_prev;
+    vfs_dentry_t* lru_next;
+    char name[];
+};
+
+/**
+ * Interned name. Nodes point to the string, the entry is found from it by its offset.
+ */
+typedef struct vfs_name vfs_name_t;
+
+struct vfs_name {
+    uint32_t references;
+    vfs_name_t* hash_next;
+    char string[];
+};
+
+static vfs_node_t* vfs_node_buckets[VFS_NODE_BUCKETS];
+static vfs_name_t* vfs_name_buckets[VFS_NAME_BUCKETS];
+static vfs_dentry_t* vfs_dcache_buckets[VFS_DCACHE_BUCKETS];
+static vfs_dentry_t* vfs_dcache_lru_head = NULL;
+static vfs_dentry_t* vfs_dcache_lru_tail = NULL;
+static size_t vfs_dcache_entries = 0;
+
+static uint32_t vfs_string_hash(const char* string);
+static size_t vfs_node_hash(vfs_filesystem_t* filesystem, uint32_t inode);
+static vfs_node_t* vfs_node_register(vfs_node_t* node);
+static void vfs_node_unhash(vfs_node_t* node);
+static const char* vfs_name_intern(const char* string);
+static void vfs_name_release(const char* string);
+static vfs_node_t* vfs_dcache_lookup(vfs_node_t* parent, char* name);
+static size_t vfs_dcache_hash(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name);
+static vfs_dentry_t* vfs_dcache_find(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name);
+static void vfs_dcache_insert(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name, vfs_node_t* node);
+static void vfs_dcache_remove(vfs_dentry_t* entry);
+static void vfs_dcache_touch(vfs_dentry_t* entry);
+static void vfs_dcache_invalidate(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name);
+static void vfs_dcache_invalidate_dir(vfs_filesystem_t* filesystem, uint32_t inode);
+
+vfs_node_t* vfs_node_create(vfs_filesystem_t* filesystem, uint32_t inode, const char* name) {
+    vfs_node_t* node = (vfs_node_t*) kmalloc(sizeof(vfs_node_t));
+
+    if(!node) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    memset(node, 0, sizeof(vfs_node_t));
+
+    node->name = vfs_name_intern(name);
+    node->references = 1;
+    node->inode = inode;
+    node->filesystem = filesystem;
+
+    return node;
+}
+
+vfs_node_t* vfs_node_get(vfs_node_t* node) {
+    node->references++;
+
+    return node;
+}
+
+void vfs_node_put(vfs_node_t* node) {
+    if(!node || --node->references > 0) {
+        return;
+    }
+
+    vfs_node_unhash(node);
+    vfs_name_release(node->name);
+    kfree(node);
+}
 
 bool vfs_is_abs_path(char* path) {
     if(strlen(path) < 3) {
@@ -28,14 +107,25 @@ bool vfs_is_dir(vfs_node_t* node) {
 
 int32_t vfs_open(vfs_node_t* node) {
     if (node && node->operations->open != NULL) {
-        return node->operations->open(node);
+        // Later opens share what the file system loaded for the first one
+        if(node->open_count == 0 && node->operations->open(node) != 0) {
+            return -1;
+        }
+
+        node->open_count++;
+
+        return 0;
     }
 
     return -1;
 }
 
 int32_t vfs_close(vfs_node_t* node) {
-    if (node && node->operations->close != NULL) {
+    if (node && node->operations->close != NULL && node->open_count > 0) {
+        if(--node->open_count > 0) {
+            return 0;
+        }
+
         return node->operations->close(node);
     }
 
@@ -44,7 +134,20 @@ int32_t vfs_close(vfs_node_t* node) {
 
 int32_t vfs_rename(vfs_node_t* node, char* new_name) {
     if (node && node->operations->rename != NULL) {
-        return node->operations->rename(node, new_name);
+        vfs_dcache_invalidate(node->filesystem, node->parent_inode, node->name);
+
+        int32_t result = node->operations->rename(node, new_name);
+
+        vfs_dcache_invalidate(node->filesystem, node->parent_inode, new_name);
+
+        if(result == 0) {
+            const char* old_name = node->name;
+
+            node->name = vfs_name_intern(new_name);
+            vfs_name_release(old_name);
+        }
+
+        return result;
     }
 
     return -1;
@@ -66,8 +169,34 @@ int32_t vfs_write(vfs_node_t* node, uint32_t offset, size_t size, void* buffer)
     return -1;
 }
 
+int32_t vfs_readahead(vfs_node_t* node, uint32_t offset, size_t size) {
+    if (node && node->operations->readahead != NULL && node->type == VFS_FILE) {
+        return node->operations->readahead(node, offset, size);
+    }
+
+    return -1;
+}
+
+int32_t vfs_truncate(vfs_node_t* node, uint32_t length) {
+    if (node && node->operations->truncate != NULL && node->type == VFS_FILE) {
+        return node->operations->truncate(node, length);
+    }
+
+    return -1;
+}
+
+int32_t vfs_sync(vfs_filesystem_t* filesystem) {
+    if (filesystem && filesystem->operations->sync != NULL) {
+        return filesystem->operations->sync(filesystem);
+    }
+
+    return 0;
+}
+
 int32_t vfs_create(vfs_node_t* node, char* name, uint32_t permissions) {
     if (node && node->operations->create != NULL && node->type == VFS_DIRECTORY) {
+        vfs_dcache_invalidate(node->filesystem, node->inode, name);
+
         return node->operations->create(node, name, permissions);
     }
 
@@ -76,7 +205,26 @@ int32_t vfs_create(vfs_node_t* node, char* name, uint32_t permissions) {
 
 int32_t vfs_unlink(vfs_node_t* node, char* name) {
     if (node && node->operations->unlink != NULL && node->type == VFS_DIRECTORY) {
-        return node->operations->unlink(node, name);
+        vfs_node_t* child = vfs_dcache_lookup(node, name);
+
+        if(child) {
+            vfs_node_get(child);
+        }
+
+        vfs_dcache_invalidate(node->filesystem, node->inode, name);
+
+        int32_t result = node->operations->unlink(node, name);
+
+        // Holders keep the node, but its inode may be reused by another file
+        if(child) {
+            if(result == 0) {
+                vfs_node_unhash(child);
+            }
+
+            vfs_node_put(child);
+        }
+
+        return result;
     }
 
     return -1;
@@ -84,6 +232,8 @@ int32_t vfs_unlink(vfs_node_t* node, char* name) {
 
 int32_t vfs_mkdir(vfs_node_t* node, char* name, uint32_t permissions) {
     if (node && node->operations->mkdir != NULL && node->type == VFS_DIRECTORY) {
+        vfs_dcache_invalidate(node->filesystem, node->inode, name);
+
         return node->operations->mkdir(node, name, permissions);
     }
 
@@ -92,23 +242,66 @@ int32_t vfs_mkdir(vfs_node_t* node, char* name, uint32_t permissions) {
 
 int32_t vfs_rmdir(vfs_node_t* node, char* name) {
     if (node && node->operations->rmdir != NULL && node->type == VFS_DIRECTORY) {
-        return node->operations->rmdir(node, name);
+        vfs_node_t* child = vfs_dcache_lookup(node, name);
+
+        // Entries below the directory must go as well, its inode may be reused
+        if(child) {
+            vfs_node_get(child);
+            vfs_dcache_invalidate_dir(node->filesystem, child->inode);
+        }
+
+        vfs_dcache_invalidate(node->filesystem, node->inode, name);
+
+        int32_t result = node->operations->rmdir(node, name);
+
+        if(child) {
+            if(result == 0) {
+                vfs_node_unhash(child);
+            }
+
+            vfs_node_put(child);
+        }
+
+        return result;
     }
 
     return -1;
 }
 
-vfs_dirent_t* vfs_readdir(vfs_node_t* node, uint32_t index) {
+int32_t vfs_readdir(vfs_node_t* node, uint32_t* position, void* buffer, size_t size) {
     if (node && node->operations->readdir != NULL && node->type == VFS_DIRECTORY) {
-        return node->operations->readdir(node, index);
+        return node->operations->readdir(node, position, buffer, size);
     }
 
-    return NULL;
+    return -1;
+}
+
+size_t vfs_dirent_fill(void* buffer, size_t size, const char* name, uint8_t name_len, uint32_t inode, uint8_t type, uint32_t next) {
+    size_t rec_len = VFS_DIRENT_LEN(name_len);
+
+    if(rec_len > size) {
+        return 0;
+    }
+
+    vfs_dirent_t* dirent = (vfs_dirent_t*) buffer;
+
+    dirent->inode = inode;
+    dirent->next = next;
+    dirent->rec_len = rec_len;
+    dirent->name_len = name_len;
+    dirent->type = type;
+
+    memcpy(dirent->name, name, name_len);
+    dirent->name[name_len] = '\0';
+
+    return rec_len;
 }
 
 vfs_node_t* vfs_finddir(vfs_node_t* node, char* name) {
     if (node && node->operations->finddir != NULL && node->type == VFS_DIRECTORY) {
-        return node->operations->finddir(node, name);
+        vfs_node_t* child = node->operations->finddir(node, name);
+
+        return child ? vfs_node_register(child) : NULL;
     }
 
     return NULL;
@@ -120,7 +313,7 @@ vfs_node_t* vfs_findpath(vfs_node_t* node, char* path) {
     }
 
     if(strcmp(path, "/") == 0 || strcmp(path, "") == 0) {
-        return node;
+        return vfs_node_get(node);
     }
 
     char* path_copy = (char*) kmalloc(strlen(path) + 1);
@@ -131,37 +324,304 @@ vfs_node_t* vfs_findpath(vfs_node_t* node, char* path) {
 
     strcpy(path_copy, path);
 
-    if(path_copy[0] == '/') {
-        path_copy++;
-    }
+    char* remaining = path_copy;
+    char* token;
+    vfs_node_t* current = vfs_node_get(node);
+
+    // Each step holds a reference, so the cache can't free a node still walked through
+    while(current && (token = strsep(&remaining, "/")) != NULL) {
+        if(*token == '\0') {
+            continue;
+        }
+
+        vfs_node_t* next = NULL;
 
-    vfs_node_t* found_node = vfs_findpath_recursive(node, path_copy);
+        if(current->type == VFS_DIRECTORY) {
+            next = vfs_dcache_lookup(current, token);
+        }
+
+        if(next) {
+            vfs_node_get(next);
+        }
+
+        vfs_node_put(current);
+        current = next;
+    }
 
     kfree(path_copy);
 
-    return found_node;
+    return current;
 }
 
-static vfs_node_t* vfs_findpath_recursive(vfs_node_t* node, char* path) {
-    if(!node || !(node->type == VFS_DIRECTORY) || node->operations->finddir == NULL) {
-        return NULL;
+void vfs_dcache_purge(vfs_filesystem_t* filesystem) {
+    vfs_dentry_t* entry = vfs_dcache_lru_head;
+
+    while(entry) {
+        vfs_dentry_t* next = entry->lru_next;
+
+        if(entry->filesystem == filesystem) {
+            vfs_dcache_remove(entry);
+        }
+
+        entry = next;
     }
+}
 
-    char* token = strsep(&path, "/");
+/**
+ * Look up an entry of a directory through the dentry cache, asking the file system on a miss.
+ * The returned node belongs to the cache.
+ */
+static vfs_node_t* vfs_dcache_lookup(vfs_node_t* parent, char* name) {
+    vfs_dentry_t* entry = vfs_dcache_find(parent->filesystem, parent->inode, name);
 
-    if(!token) {
-        return node;
+    if(entry) {
+        vfs_dcache_touch(entry);
+        return entry->node;
     }
 
-    vfs_node_t* next_node = vfs_finddir(node, token);
+    vfs_node_t* node = vfs_finddir(parent, name);
 
-    if(!next_node) {
-        return NULL;
+    vfs_dcache_insert(parent->filesystem, parent->inode, name, node);
+
+    return node;
+}
+
+static size_t vfs_dcache_hash(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name) {
+    uint32_t hash = vfs_string_hash(name) ^ (((uintptr_t) filesystem) >> 4) ^ (parent_inode * 2654435761u);
+
+    return hash & (VFS_DCACHE_BUCKETS - 1);
+}
+
+static vfs_dentry_t* vfs_dcache_find(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name) {
+    vfs_dentry_t* entry = vfs_dcache_buckets[vfs_dcache_hash(filesystem, parent_inode, name)];
+
+    while(entry && (entry->filesystem != filesystem || entry->parent_inode != parent_inode || strcmp(entry->name, name) != 0)) {
+        entry = entry->hash_next;
+    }
+
+    return entry;
+}
+
+static void vfs_dcache_insert(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name, vfs_node_t* node) {
+    if(vfs_dcache_entries >= VFS_DCACHE_SIZE) {
+        vfs_dcache_remove(vfs_dcache_lru_tail);
+    }
+
+    // The name is stored right behind the entry
+    vfs_dentry_t* entry = (vfs_dentry_t*) kmalloc(sizeof(vfs_dentry_t) + strlen(name) + 1);
+
+    if(!entry) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    size_t bucket = vfs_dcache_hash(filesystem, parent_inode, name);
+
+    entry->filesystem = filesystem;
+    entry->parent_inode = parent_inode;
+    entry->node = node;
+    strcpy(entry->name, name);
+
+    entry->hash_next = vfs_dcache_buckets[bucket];
+    vfs_dcache_buckets[bucket] = entry;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = vfs_dcache_lru_head;
+
+    if(vfs_dcache_lru_head) {
+        vfs_dcache_lru_head->lru_prev = entry;
+    } else {
+        vfs_dcache_lru_tail = entry;
+    }
+
+    vfs_dcache_lru_head = entry;
+    vfs_dcache_entries++;
+}
+
+static void vfs_dcache_remove(vfs_dentry_t* entry) {
+    vfs_dentry_t** link = &vfs_dcache_buckets[vfs_dcache_hash(entry->filesystem, entry->parent_inode, entry->name)];
+
+    while(*link != entry) {
+        link = &(*link)->hash_next;
+    }
+
+    *link = entry->hash_next;
+
+    if(entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        vfs_dcache_lru_head = entry->lru_next;
+    }
+
+    if(entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        vfs_dcache_lru_tail = entry->lru_prev;
+    }
+
+    vfs_dcache_entries--;
+
+    vfs_node_put(entry->node);
+    kfree(entry);
+}
+
+static void vfs_dcache_touch(vfs_dentry_t* entry) {
+    if(entry == vfs_dcache_lru_head) {
+        return;
     }
 
-    if(!path) {
-        return next_node;
+    // Unlink the entry and move it to the front of the LRU list
+    entry->lru_prev->lru_next = entry->lru_next;
+
+    if(entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        vfs_dcache_lru_tail = entry->lru_prev;
+    }
+
+    entry->lru_prev = NULL;
+    entry->lru_next = vfs_dcache_lru_head;
+    vfs_dcache_lru_head->lru_prev = entry;
+    vfs_dcache_lru_head = entry;
+}
+
+static void vfs_dcache_invalidate(vfs_filesystem_t* filesystem, uint32_t parent_inode, const char* name) {
+    vfs_dentry_t* entry = vfs_dcache_find(filesystem, parent_inode, name);
+
+    if(entry) {
+        vfs_dcache_remove(entry);
+    }
+}
+
+/**
+ * Drop all entries of a directory, e.g. when the directory is removed and its inode may be reused.
+ */
+static void vfs_dcache_invalidate_dir(vfs_filesystem_t* filesystem, uint32_t inode) {
+    vfs_dentry_t* entry = vfs_dcache_lru_head;
+
+    while(entry) {
+        vfs_dentry_t* next = entry->lru_next;
+
+        if(entry->filesystem == filesystem && entry->parent_inode == inode) {
+            vfs_dcache_remove(entry);
+        }
+
+        entry = next;
+    }
+}
+
+/**
+ * FNV-1a hash of a string.
+ */
+static uint32_t vfs_string_hash(const char* string) {
+    uint32_t hash = 2166136261u;
+
+    while(*string) {
+        hash = (hash ^ (uint8_t) *string++) * 16777619u;
+    }
+
+    return hash;
+}
+
+static size_t vfs_node_hash(vfs_filesystem_t* filesystem, uint32_t inode) {
+    return ((((uintptr_t) filesystem) >> 4) ^ (inode * 2654435761u)) & (VFS_NODE_BUCKETS - 1);
+}
+
+/**
+ * Enter a node freshly built by a file system into the node table. If the table already holds
+ * a node for the inode, the new node is dropped and a reference to the existing one returned.
+ */
+static vfs_node_t* vfs_node_register(vfs_node_t* node) {
+    vfs_filesystem_t* filesystem = node->filesystem;
+    size_t bucket = vfs_node_hash(filesystem, node->inode);
+    vfs_node_t* existing = NULL;
+
+    // The root is created on mount and is not part of the table
+    if(filesystem->root && filesystem->root->inode == node->inode) {
+        existing = filesystem->root;
+    } else {
+        existing = vfs_node_buckets[bucket];
+
+        while(existing && (existing->filesystem != filesystem || existing->inode != node->inode)) {
+            existing = existing->hash_next;
+        }
+    }
+
+    if(existing) {
+        vfs_node_put(node);
+        return vfs_node_get(existing);
+    }
+
+    node->hash_next = vfs_node_buckets[bucket];
+    vfs_node_buckets[bucket] = node;
+
+    return node;
+}
+
+/**
+ * Remove a node from the node table, so later lookups of its inode build a new node.
+ */
+static void vfs_node_unhash(vfs_node_t* node) {
+    size_t bucket = vfs_node_hash(node->filesystem, node->inode);
+    vfs_node_t* previous = NULL;
+    vfs_node_t* current = vfs_node_buckets[bucket];
+
+    // Nodes are packed, so the chain is walked without pointers to their links
+    while(current && current != node) {
+        previous = current;
+        current = current->hash_next;
+    }
+
+    if(current) {
+        if(previous) {
+            previous->hash_next = node->hash_next;
+        } else {
+            vfs_node_buckets[bucket] = node->hash_next;
+        }
+    }
+
+    node->hash_next = NULL;
+}
+
+static const char* vfs_name_intern(const char* string) {
+    size_t bucket = vfs_string_hash(string) & (VFS_NAME_BUCKETS - 1);
+    vfs_name_t* name = vfs_name_buckets[bucket];
+
+    while(name && strcmp(name->string, string) != 0) {
+        name = name->hash_next;
+    }
+
+    if(!name) {
+        name = (vfs_name_t*) kmalloc(sizeof(vfs_name_t) + strlen(string) + 1);
+
+        if(!name) {
+            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+        }
+
+        name->references = 0;
+        strcpy(name->string, string);
+
+        name->hash_next = vfs_name_buckets[bucket];
+        vfs_name_buckets[bucket] = name;
+    }
+
+    name->references++;
+
+    return name->string;
+}
+
+static void vfs_name_release(const char* string) {
+    vfs_name_t* name = (vfs_name_t*) (string - offsetof(vfs_name_t, string));
+
+    if(--name->references > 0) {
+        return;
+    }
+
+    vfs_name_t** link = &vfs_name_buckets[vfs_string_hash(string) & (VFS_NAME_BUCKETS - 1)];
+
+    while(*link != name) {
+        link = &(*link)->hash_next;
     }
 
-    return vfs_findpath_recursive(next_node, path);
+    *link = name->hash_next;
+    kfree(name);
 }
@@ -27,40 +27,24 @@ int32_t dir_open(char* path) {
     }
 
     if(node->type != VFS_DIRECTORY) {
-        kfree(node);
+        vfs_node_put(node);
         return -1;
     }
 
     int32_t dd = dir_get_free_descriptor();
 
     if(dd < 0) {
-        kfree(node);
+        vfs_node_put(node);
         return -1;
     }
 
-    // Copy the root node to avoid freeing the root node when closing the directory
-    if(node == mountpoint->root) {
-        vfs_node_t* root_copy = (vfs_node_t*) kmalloc(sizeof(vfs_node_t));
-
-        if(!root_copy) {
-            KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
-        }
-
-        memcpy(root_copy, node, sizeof(vfs_node_t));
-
-        strncpy(root_copy->name, node->name, 256);
-
-        node = root_copy;
+    if(vfs_open(node) != 0) {
+        vfs_node_put(node);
+        return -1;
     }
 
     dir_descriptors[dd].node = node;
-    dir_descriptors[dd].index = 0;
-
-    if(vfs_open(node) != 0) {
-        kfree(node->name);
-        kfree(node);
-        return NULL;
-    }
+    dir_descriptors[dd].position = 0;
 
     return dd;
 }
@@ -74,43 +58,51 @@ int32_t dir_close(int32_t dd) {
         return -1;
     }
 
-    kfree(dir_descriptors[dd].node->name);
-    kfree(dir_descriptors[dd].node);
+    vfs_close(dir_descriptors[dd].node);
+    vfs_node_put(dir_descriptors[dd].node);
     dir_descriptors[dd].node = NULL;
 
     return 0;
 }
 
-const dir_dirent_t* dir_read(int32_t dd) {
+int32_t dir_read(int32_t dd, dir_dirent_t* dirent) {
     if(dd < 0 || dd >= MAX_DIR_DESCRIPTORS) {
-        return NULL;
+        return -1;
     }
 
     if(!dir_descriptors[dd].node) {
-        return NULL;
+        return -1;
     }
 
-    vfs_dirent_t* dirent = vfs_readdir(dir_descriptors[dd].node, dir_descriptors[dd].index);
+    // Room for one entry of the longest name, more entries may be read but only the first is used
+    uint32_t record[VFS_DIRENT_LEN(255) / sizeof(uint32_t)];
+    uint32_t position = dir_descriptors[dd].position;
 
-    if(!dirent) {
-        return NULL;
+    if(vfs_readdir(dir_descriptors[dd].node, &position, record, sizeof(record)) <= 0) {
+        return -1;
     }
 
-    dir_dirent_t* dir_dirent = kmalloc(sizeof(dir_dirent_t));
+    vfs_dirent_t* vfs_dirent = (vfs_dirent_t*) record;
 
-    if(!dir_dirent) {
-        kfree(dirent);
-        return NULL;
-    }
+    memcpy(dirent->name, vfs_dirent->name, vfs_dirent->name_len + 1);
+    dirent->inode = vfs_dirent->inode;
+    dirent->type = vfs_dirent->type;
 
-    strncpy(dir_dirent->name, dirent->name, 256);
-    dir_dirent->inode = dirent->inode;
+    dir_descriptors[dd].position = vfs_dirent->next;
 
-    kfree(dirent);
+    return 0;
+}
 
-    dir_descriptors[dd].index++;
+int32_t dir_getdents(int32_t dd, void* buffer, size_t size) {
+    if(dd < 0 || dd >= MAX_DIR_DESCRIPTORS) {
+        return -1;
+    }
+
+    if(!dir_descriptors[dd].node || !buffer) {
+        return -1;
+    }
 
-    return dir_dirent;
+    return vfs_readdir(dir_descriptors[dd].node, &dir_descriptors[dd].position, buffer, size);
 }
 
 static int32_t dir_get_free_descriptor() {
@@ -3,6 +3,9 @@
 #include <memory/kheap.h>
 #include <system/kpanic.h>
 
+static vfs_node_t* file_create(vfs_node_t* root, char* path);
+static void file_readahead(file_descriptor_t* fd, size_t size);
+
 file_descriptor_t* file_open(char* path, uint32_t flags) {
     if(!vfs_is_abs_path(path)) {
         return NULL;
@@ -18,8 +21,11 @@ file_descriptor_t* file_open(char* path, uint32_t flags) {
 
     vfs_node_t* node = vfs_findpath(mountpoint->root, relative_path);
 
+    if(!node && (flags & FILE_CREAT)) {
+        node = file_create(mountpoint->root, relative_path);
+    }
+
     if(!node) {
-        kfree(node);
         return NULL;
     }
 
@@ -33,17 +39,73 @@ file_descriptor_t* file_open(char* path, uint32_t flags) {
     file_descriptor->size = node->length;
     file_descriptor->offset = 0;
     file_descriptor->flags = flags;
+    file_descriptor->readahead_next = 0;
+    file_descriptor->readahead_end = 0;
+    file_descriptor->readahead_window = 0;
 
     if(vfs_open(node) != 0) {
         kfree(file_descriptor);
-        kfree(node->name);
-        kfree(node);
+        vfs_node_put(node);
         return NULL;
     }
 
+    if((flags & FILE_TRUNC) && (flags & FILE_WRONLY) && node->type == VFS_FILE) {
+        if(vfs_truncate(node, 0) != 0) {
+            vfs_close(node);
+            kfree(file_descriptor);
+            vfs_node_put(node);
+            return NULL;
+        }
+
+        file_descriptor->size = 0;
+    }
+
     return file_descriptor;
 }
 
+/**
+ * Create a regular file at the given path relative to the root of its file system. The
+ * parent directory must already exist.
+ */
+static vfs_node_t* file_create(vfs_node_t* root, char* path) {
+    char* path_copy = (char*) kmalloc(strlen(path) + 1);
+
+    if(!path_copy) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    strcpy(path_copy, path);
+
+    // Split the path into the parent directory and the name of the new file
+    char* name = path_copy;
+    vfs_node_t* parent = NULL;
+
+    for(char* current = path_copy; *current; current++) {
+        if(*current == '/') {
+            name = current + 1;
+        }
+    }
+
+    if(name != path_copy) {
+        *(name - 1) = '\0';
+        parent = vfs_findpath(root, path_copy);
+    } else {
+        parent = vfs_node_get(root);
+    }
+
+    vfs_node_t* node = NULL;
+
+    if(parent && *name && vfs_create(parent, name, FILE_CREATE_PERMISSIONS) == 0) {
+        node = vfs_finddir(parent, name);
+    }
+
+    vfs_node_put(parent);
+
+    kfree(path_copy);
+
+    return node;
+}
+
 int32_t file_close(file_descriptor_t* fd) {
     if(!fd) {
         return -1;
@@ -57,6 +119,7 @@ int32_t file_close(file_descriptor_t* fd) {
         return -1;
     }
 
+    vfs_node_put(fd->node);
     kfree(fd);
 
     return 0;
@@ -79,6 +142,10 @@ int32_t file_read(file_descriptor_t* fd, void* buffer, size_t size) {
         size = fd->size - fd->offset;
     }
 
+    if(size > 0) {
+        file_readahead(fd, size);
+    }
+
     int32_t bytes_read = vfs_read(fd->node, fd->offset, size, buffer);
 
     if(bytes_read < 0) {
@@ -86,10 +153,49 @@ int32_t file_read(file_descriptor_t* fd, void* buffer, size_t size) {
     }
 
     fd->offset += bytes_read;
+    fd->readahead_next = fd->offset;
 
     return bytes_read;
 }
 
+/**
+ * Reads ahead of sequential reads. The window starts at FILE_READAHEAD_MIN and doubles up to
+ * FILE_READAHEAD_MAX each time the reader gets within half a window of the range read ahead so
+ * far. A read that does not continue where the previous one ended resets the window.
+ */
+static void file_readahead(file_descriptor_t* fd, size_t size) {
+    if(fd->offset != fd->readahead_next) {
+        fd->readahead_window = 0;
+        fd->readahead_end = 0;
+        return;
+    }
+
+    uint32_t target = fd->offset + size;
+
+    if(fd->readahead_window != 0 && target + fd->readahead_window / 2 <= fd->readahead_end) {
+        return;
+    }
+
+    if(fd->readahead_window == 0) {
+        fd->readahead_window = FILE_READAHEAD_MIN;
+    } else if(fd->readahead_window < FILE_READAHEAD_MAX) {
+        fd->readahead_window *= 2;
+    }
+
+    uint32_t start = fd->readahead_end > fd->offset ? fd->readahead_end : fd->offset;
+    uint32_t end = target + fd->readahead_window;
+
+    if(end > fd->size) {
+        end = fd->size;
+    }
+
+    if(end > start) {
+        vfs_readahead(fd->node, start, end - start);
+    }
+
+    fd->readahead_end = end;
+}
+
 int32_t file_write(file_descriptor_t* fd, void* buffer, size_t size) {
     if(!fd) {
         return -1;
@@ -103,8 +209,8 @@ int32_t file_write(file_descriptor_t* fd, void* buffer, size_t size) {
         return -1;
     }
 
-    if(fd->offset + size > fd->size) {
-        size = fd->size - fd->offset;
+    if(fd->flags & FILE_APPEND) {
+        fd->offset = fd->size;
     }
 
     int32_t bytes_written = vfs_write(fd->node, fd->offset, size, buffer);
@@ -115,6 +221,11 @@ int32_t file_write(file_descriptor_t* fd, void* buffer, size_t size) {
 
     fd->offset += bytes_written;
 
+    // Writing past the end grows the file
+    if(fd->offset > fd->size) {
+        fd->size = fd->offset;
+    }
+
     return bytes_written;
 }
 
@@ -168,12 +279,11 @@ int32_t file_stat(const char* path, file_stat_t* stat) {
     vfs_node_t* node = vfs_findpath(mountpoint->root, relative_path);
 
     if(!node) {
-        kfree(node);
         return -1;
     }
 
     if(node->type != VFS_FILE) {
-        kfree(node);
+        vfs_node_put(node);
         return -1;
     }
 
@@ -182,7 +292,7 @@ int32_t file_stat(const char* path, file_stat_t* stat) {
     stat->gid = node->gid;
     stat->permissions = node->permissions;
 
-    kfree(node);
+    vfs_node_put(node);
 
     return 0;
 }
@@ -0,0 +1,89 @@
+#include <io/font.h>
+#include <memory/kheap.h>
+#include <system/kpanic.h>
+#include <util/string.h>
+
+static const font_t* font_default = NULL;
+
+static void font_expand_glyph(const font_t* font, uint8_t ch, uint32_t fgcolor, uint32_t bgcolor, uint32_t* pixels);
+
+font_t* font_create(uint32_t width, uint32_t height, const uint8_t* bitmap) {
+    if(width == 0 || width > 8 || height == 0) {
+        return NULL;
+    }
+
+    font_t* font = (font_t*) kmalloc(sizeof(font_t));
+
+    if(!font) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    font->bitmap = (uint8_t*) kmalloc(FONT_GLYPHS * height);
+
+    if(!font->bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    memcpy(font->bitmap, bitmap, FONT_GLYPHS * height);
+    font->width = width;
+    font->height = height;
+
+    return font;
+}
+
+void font_set_default(const font_t* font) {
+    font_default = font;
+}
+
+const font_t* font_get_default() {
+    return font_default;
+}
+
+font_glyph_cache_t* font_glyph_cache_create(const font_t* font) {
+    font_glyph_cache_t* cache = (font_glyph_cache_t*) kmalloc(sizeof(font_glyph_cache_t));
+
+    if(!cache) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    cache->entries = (font_glyph_cache_entry_t*) kcalloc(FONT_GLYPH_CACHE_SIZE, sizeof(font_glyph_cache_entry_t));
+    cache->pixels = (uint32_t*) kmalloc(FONT_GLYPH_CACHE_SIZE * font->width * font->height * sizeof(uint32_t));
+
+    if(!cache->entries || !cache->pixels) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    cache->font = font;
+
+    return cache;
+}
+
+const uint32_t* font_glyph_cache_get(font_glyph_cache_t* cache, uint8_t ch, uint32_t fgcolor, uint32_t bgcolor) {
+    // Direct mapped, the multiplicative hash spreads the few colors in use over the slots
+    uint32_t hash = ch * 0x9E3779B1 ^ fgcolor * 0x85EBCA77 ^ bgcolor * 0xC2B2AE3D;
+    size_t index = hash >> (32 - FONT_GLYPH_CACHE_BITS);
+
+    font_glyph_cache_entry_t* entry = &cache->entries[index];
+    uint32_t* pixels = cache->pixels + index * cache->font->width * cache->font->height;
+
+    if(!entry->valid || entry->ch != ch || entry->fgcolor != fgcolor || entry->bgcolor != bgcolor) {
+        font_expand_glyph(cache->font, ch, fgcolor, bgcolor, pixels);
+
+        entry->valid = true;
+        entry->ch = ch;
+        entry->fgcolor = fgcolor;
+        entry->bgcolor = bgcolor;
+    }
+
+    return pixels;
+}
+
+static void font_expand_glyph(const font_t* font, uint8_t ch, uint32_t fgcolor, uint32_t bgcolor, uint32_t* pixels) {
+    const uint8_t* rows = font->bitmap + ch * font->height;
+
+    for(uint32_t y = 0; y < font->height; y++) {
+        for(uint32_t x = 0; x < font->width; x++) {
+            *pixels++ = (rows[y] & (0x80 >> x)) ? fgcolor : bgcolor;
+        }
+    }
+}
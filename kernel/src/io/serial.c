@@ -0,0 +1,136 @@
+#include <io/serial.h>
+#include <drivers/serial/uart/16550.h>
+#include <memory/kheap.h>
+#include <system/kpanic.h>
+#include <util/string.h>
+
+static void serial_stream_putchar(stream_t* stream, char ch);
+static int serial_stream_getchar(stream_t* stream);
+static void serial_stream_puts(stream_t* stream, const char* str);
+static char* serial_stream_gets(stream_t* stream);
+static size_t serial_stream_write(stream_t* stream, const char* buffer, size_t size);
+static size_t serial_stream_read(stream_t* stream, char* buffer, size_t size);
+
+stream_t* serial_create_stream(uint16_t port) {
+    stream_t *stream = (stream_t*) kmalloc(sizeof(stream_t));
+
+    if(stream == NULL) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    stream->putchar = serial_stream_putchar;
+    stream->getchar = serial_stream_getchar;
+    stream->puts = serial_stream_puts;
+    stream->gets = serial_stream_gets;
+    stream->write = serial_stream_write;
+    stream->read = serial_stream_read;
+    stream->data = (void*) (uintptr_t) port;
+
+    return stream;
+}
+
+bool serial_is_stream(const stream_t* stream) {
+    return stream->write == serial_stream_write;
+}
+
+static void serial_stream_putchar(stream_t* stream, char ch) {
+    serial_stream_write(stream, &ch, 1);
+}
+
+static int serial_stream_getchar(stream_t* stream) {
+    char ch;
+
+    if(serial_stream_read(stream, &ch, 1) == 0) {
+        return -1;
+    }
+
+    return (uint8_t) ch;
+}
+
+static void serial_stream_puts(stream_t* stream, const char* str) {
+    serial_stream_write(stream, str, strlen(str));
+}
+
+static char* serial_stream_gets(stream_t* stream) {
+    char *buffer = kmalloc(1);
+    size_t buffer_size = 1;
+    size_t buffer_index = 0;
+
+    if(!buffer) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    // The host terminal does not echo, so the line is echoed as it is typed
+    while(true) {
+        int ch;
+        while((ch = serial_stream_getchar(stream)) == -1);
+
+        if(ch == '\n') {
+            serial_stream_putchar(stream, ch);
+            break;
+        }
+
+        if(ch == '\b') {
+            if(buffer_index == 0) {
+                continue;
+            }
+
+            buffer_index--;
+
+            serial_stream_puts(stream, "\b \b");
+
+            continue;
+        }
+
+        if(buffer_index + 1 == buffer_size) {
+            buffer_size *= 2;
+            buffer = krealloc(buffer, buffer_size);
+
+            if(!buffer) {
+                KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+            }
+        }
+
+        buffer[buffer_index] = ch;
+        buffer_index++;
+        serial_stream_putchar(stream, ch);
+    }
+
+    buffer[buffer_index] = '\0';
+
+    return buffer;
+}
+
+static size_t serial_stream_write(stream_t* stream, const char* buffer, size_t size) {
+    uint16_t port = (uint16_t) (uintptr_t) stream->data;
+    size_t start = 0;
+
+    // Runs without newlines are queued at once, newlines become CR LF
+    for(size_t index = 0; index < size; index++) {
+        if(buffer[index] == '\n') {
+            uart_16550_write(port, buffer + start, index - start);
+            uart_16550_write(port, "\r\n", 2);
+            start = index + 1;
+        }
+    }
+
+    uart_16550_write(port, buffer + start, size - start);
+
+    return size;
+}
+
+static size_t serial_stream_read(stream_t* stream, char* buffer, size_t size) {
+    uint16_t port = (uint16_t) (uintptr_t) stream->data;
+    size_t count = uart_16550_read(port, buffer, size);
+
+    // Terminals send carriage return for Enter and delete for Backspace
+    for(size_t index = 0; index < count; index++) {
+        if(buffer[index] == '\r') {
+            buffer[index] = '\n';
+        } else if(buffer[index] == 0x7F) {
+            buffer[index] = '\b';
+        }
+    }
+
+    return count;
+}
@@ -1,10 +1,14 @@
 #include <io/stream.h>
+#include <util/string.h>
+#include <format.h>
+
+static void stream_printf_flush(const char* chunk, size_t length, void* context);
 
 void stream_putchar(stream_t* stream, char ch) {
     stream->putchar(stream, ch);
 }
 
-char stream_getchar(stream_t* stream) {
+int stream_getchar(stream_t* stream) {
     return stream->getchar(stream);
 }
 
@@ -16,6 +20,33 @@ char* stream_gets(stream_t* stream) {
     return stream->gets(stream);
 }
 
+size_t stream_write(stream_t* stream, const char* buffer, size_t size) {
+    if(stream->write) {
+        return stream->write(stream, buffer, size);
+    }
+
+    for(size_t index = 0; index < size; index++) {
+        stream->putchar(stream, buffer[index]);
+    }
+
+    return size;
+}
+
+size_t stream_read(stream_t* stream, char* buffer, size_t size) {
+    if(stream->read) {
+        return stream->read(stream, buffer, size);
+    }
+
+    size_t count = 0;
+    int ch;
+
+    while(count < size && (ch = stream->getchar(stream)) > 0) {
+        buffer[count++] = ch;
+    }
+
+    return count;
+}
+
 int stream_printf(stream_t* stream, const char *format, ...) {
     va_list args;
     va_start(args, format);
@@ -26,117 +57,11 @@ int stream_printf(stream_t* stream, const char *format, ...) {
 }
 
 int stream_vprintf(stream_t* stream, const char *format, va_list args) {
-    int count = 0;
-
-    while(*format != '\0') {
-        if(*format == '%') {
-            format++;
-
-            switch(*format) {
-                case '%': {
-                    stream_putchar(stream, '%');
-                    count++;
-                    break;
-                }
-                case 'c': {
-                    char ch = va_arg(args, int);
-                    stream_putchar(stream, ch);
-                    count++;
-                    break;
-                }
-                case 's': {
-                    const char *str = va_arg(args, const char*);
-
-                    while(*str != '\0') {
-                        stream_putchar(stream, *str);
-                        str++;
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'd': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    itoa(num, num_str, 10);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        stream_putchar(stream, num_str[i]);
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'x': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    stream_putchar(stream, '0');
-                    stream_putchar(stream, 'x');
-
-                    itoa(num, num_str, 16);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        stream_putchar(stream, num_str[i]);
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'p': {
-                    void *ptr = va_arg(args, void*);
-                    char ptr_str[32];
-
-                    itoa((uintptr_t) ptr, ptr_str, 16);
-
-                    for(int i = 0; ptr_str[i] != '\0'; i++) {
-                        stream_putchar(stream, ptr_str[i]);
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'b': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    stream_putchar(stream, '0');
-                    stream_putchar(stream, 'b');
-
-                    itoa(num, num_str, 2);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        stream_putchar(stream, num_str[i]);
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'f': {
-                    double num = va_arg(args, double);
-                    char num_str[32];
-
-                    gcvt(num, 2, num_str);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        stream_putchar(stream, num_str[i]);
-                        count++;
-                    }
-
-                    break;
-                }
-                default: {
-                    break;
-                }
-            }
-        } else {
-            stream_putchar(stream, *format);
-            count++;
-        }
-
-        format++;
-    }
+    char chunk[STREAM_PRINTF_CHUNK_SIZE];
 
-    return count;
+    return __vformat(chunk, STREAM_PRINTF_CHUNK_SIZE, stream_printf_flush, stream, format, args);
+}
+
+static void stream_printf_flush(const char* chunk, size_t length, void* context) {
+    stream_write((stream_t*) context, chunk, length);
 }
@@ -3,17 +3,36 @@
 #include <system/kpanic.h>
 #include <system/process.h>
 #include <device/keyboard.h>
+#include <util/string.h>
 
 static tty_t* tty_stdterm = NULL;
 
+// Pixel values of the TTY colors in graphics mode (0x00RRGGBB)
+static const uint32_t tty_gfx_palette[16] = {
+    0x000000, 0x0000AA, 0x00AA00, 0x00AAAA, 0xAA0000, 0xAA00AA, 0xAA5500, 0xAAAAAA,
+    0x555555, 0x5555FF, 0x55FF55, 0x55FFFF, 0xFF5555, 0xFF55FF, 0xFFFF55, 0xFFFFFF
+};
+
 static void tty_keyboard_listener(keyboard_event_t* event);
 static void tty_render(tty_t* tty, char ch);
 static void tty_render_char(tty_t* tty, char ch);
+static void tty_put_cell(tty_t* tty, size_t x, size_t y, char ch);
+static void tty_mark_dirty(tty_t* tty, size_t first_row, size_t last_row);
+static void tty_scroll(tty_t* tty);
+static void tty_erase_display(tty_t* tty);
+static void tty_scroll_view(tty_t* tty, size_t offset);
+static void tty_render_scrollback(tty_t* tty);
+static void tty_draw_rows(tty_t* tty, size_t row, const uint16_t* cells, size_t count);
+static void tty_draw_cursor(tty_t* tty);
 static void tty_csi_dispatch(tty_t* tty, char command);
-static tty_stream_putchar(stream_t* stream, char ch);
-static char tty_stream_getchar(stream_t* stream);
+static void tty_wait_input(tty_t* tty);
+static void tty_process_line(tty_t* tty, size_t size);
+static void tty_stream_putchar(stream_t* stream, char ch);
+static int tty_stream_getchar(stream_t* stream);
 static void tty_stream_puts(stream_t* stream, const char* str);
 static char* tty_stream_gets(stream_t* stream);
+static size_t tty_stream_write(stream_t* stream, const char* buffer, size_t size);
+static size_t tty_stream_read(stream_t* stream, char* buffer, size_t size);
 
 static char tty_keycode_to_char(tty_t* tty, uint32_t keycode, bool shifted);
 
@@ -26,8 +45,15 @@ const tty_t* tty_get_stdterm() {
 }
 
 tty_t* tty_create(video_device_t* video, keyboard_device_t* keyboard, tty_keyboard_layout_t* layout) {
+    const font_t* font = NULL;
+
     if(!video->driver->tm_probe()) {
-        return NULL;
+        font = font_get_default();
+
+        // Graphics mode requires a font and the blit operations
+        if(!video->driver->gfx_probe() || !font || !video->driver->gfx.blit || !video->driver->gfx.copy_rect || !video->driver->gfx.flush) {
+            return NULL;
+        }
     }
 
     tty_t *tty = (tty_t*) kmalloc(sizeof(tty_t));
@@ -36,8 +62,18 @@ tty_t* tty_create(video_device_t* video, keyboard_device_t* keyboard, tty_keyboa
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, KPANIC_KHEAP_OUT_OF_MEMORY_CODE, NULL);
     }
 
-    tty->rows = video->driver->tm.total_rows();
-    tty->columns = video->driver->tm.total_columns();
+    tty->font = font;
+    tty->glyphs = NULL;
+    tty->cursor_enabled = true;
+
+    if(font) {
+        tty->rows = video->driver->gfx.total_height() / font->height;
+        tty->columns = video->driver->gfx.total_width() / font->width;
+        tty->glyphs = font_glyph_cache_create(font);
+    } else {
+        tty->rows = video->driver->tm.total_rows();
+        tty->columns = video->driver->tm.total_columns();
+    }
     tty->cursor_x = 0;
     tty->cursor_y = 0;
     tty->fgcolor = TTY_WHITE;
@@ -50,15 +86,40 @@ tty_t* tty_create(video_device_t* video, keyboard_device_t* keyboard, tty_keyboa
     tty->ansi_param_count = 0;
     tty->ansi_current = 0;
 
-    tty->input = circular_buffer_create(TTY_BUFFER_SIZE, sizeof(char));
+    tty->cells = (uint16_t*) kmalloc(tty->rows * tty->columns * sizeof(uint16_t));
 
-    if (!tty->input) {
+    if(!tty->cells) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
-    tty->output = circular_buffer_create(TTY_BUFFER_SIZE, sizeof(char));
+    // The video driver starts with a blank screen, so the shadow buffer is clean
+    memsetw(tty->cells, VIDEO_TM_CELL(' ', tty->fgcolor, tty->bgcolor), tty->rows * tty->columns);
+
+    tty->dirty_start = tty->rows;
+    tty->dirty_end = 0;
+    tty->scroll_pending = 0;
+    tty->hw_cursor = tty->rows * tty->columns;
 
-    if (!tty->output) {
+    tty->scrollback = (uint16_t*) kmalloc(TTY_SCROLLBACK_ROWS * tty->columns * sizeof(uint16_t));
+
+    if(!tty->scrollback) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
+
+    tty->scrollback_head = 0;
+    tty->scrollback_count = 0;
+    tty->scrollback_offset = 0;
+
+    tty->mirror = NULL;
+
+    tty->mode = TTY_MODE_CANONICAL | TTY_MODE_ECHO;
+    tty->line_length = 0;
+    tty->line_offset = 0;
+    tty->line_ready = false;
+
+    tty->input = spsc_ring_create(TTY_BUFFER_SIZE, sizeof(char));
+
+    if (!tty->input) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
     }
 
@@ -107,6 +168,22 @@ static void tty_keyboard_listener(keyboard_event_t* event) {
         return;
     }
 
+    // Shift+PgUp/PgDn page through the scrollback buffer
+    if(shift && event->keycode == KEYBOARD_KEYCODE_PAGE_UP) {
+        tty_scroll_view(tty, tty->scrollback_offset + tty->rows);
+        return;
+    }
+
+    if(shift && event->keycode == KEYBOARD_KEYCODE_PAGE_DOWN) {
+        tty_scroll_view(tty, tty->scrollback_offset > tty->rows ? tty->scrollback_offset - tty->rows : 0);
+        return;
+    }
+
+    // Any other key returns to the live screen
+    if(tty->scrollback_offset > 0) {
+        tty_scroll_view(tty, 0);
+    }
+
     /*
      * Ctrl+C interrupts the foreground process and hands control back to its
      * parent. Only a process launched from the shell is interruptible (i.e. one
@@ -143,12 +220,13 @@ static void tty_keyboard_listener(keyboard_event_t* event) {
     }
 
     if(arrow) {
-        char escape = 0x1B;
-        char bracket = '[';
+        const char sequence[] = { 0x1B, '[', arrow };
+
+        // The sequence is enqueued completely or not at all, so readers never see a part of it
+        if(spsc_ring_capacity(tty->input) - spsc_ring_size(tty->input) >= sizeof(sequence)) {
+            spsc_ring_enqueue_bulk(tty->input, sequence, sizeof(sequence));
+        }
 
-        circular_buffer_enqueue(tty->input, &escape);
-        circular_buffer_enqueue(tty->input, &bracket);
-        circular_buffer_enqueue(tty->input, &arrow);
         return;
     }
 
@@ -156,20 +234,223 @@ static void tty_keyboard_listener(keyboard_event_t* event) {
 
     // Wait for a displayable character
     if(ch) {
-        circular_buffer_enqueue(tty->input, &ch);
+        spsc_ring_put_byte(tty->input, (uint8_t) ch);
     }
 }
 
 void tty_flush(tty_t* tty) {
-    while(!circular_buffer_empty(tty->output)) {
-        char ch = 0;
+    // The screen shows the scrollback buffer, it is redrawn when returning
+    if(tty->scrollback_offset > 0) {
+        return;
+    }
+
+    size_t cursor = tty->cursor_y * tty->columns + tty->cursor_x;
 
-        circular_buffer_dequeue(tty->output, &ch);
+    // In graphics mode the cursor is part of the drawn cells, so its cell is redrawn
+    if(tty->font && tty->hw_cursor < tty->rows * tty->columns) {
+        size_t row = tty->hw_cursor / tty->columns;
 
-        tty_render(tty, ch);
+        if(row >= tty->scroll_pending) {
+            tty_mark_dirty(tty, row - tty->scroll_pending, row - tty->scroll_pending);
+        }
+    }
+
+    /*
+     * Replay the pending scrolls first, so the device moves the rows it already
+     * holds. If the whole screen has been scrolled out, redrawing is cheaper.
+     */
+    if(tty->scroll_pending >= tty->rows) {
+        tty_mark_dirty(tty, 0, tty->rows - 1);
+    } else if(tty->scroll_pending > 0 && tty->font) {
+        size_t distance = tty->scroll_pending * tty->font->height;
+
+        tty->video->driver->gfx.copy_rect(0, distance, 0, 0, tty->columns * tty->font->width, (tty->rows - tty->scroll_pending) * tty->font->height);
+    } else {
+        for(size_t index = 0; index < tty->scroll_pending; index++) {
+            tty->video->driver->tm.scroll(tty->fgcolor, tty->bgcolor);
+        }
+    }
+
+    tty->scroll_pending = 0;
+
+    // The dirty rows are contiguous in the shadow buffer and copied at once
+    if(tty->dirty_start < tty->dirty_end) {
+        size_t first_cell = tty->dirty_start * tty->columns;
+
+        tty_draw_rows(tty, tty->dirty_start, tty->cells + first_cell, tty->dirty_end - tty->dirty_start);
+
+        tty->dirty_start = tty->rows;
+        tty->dirty_end = 0;
+    }
+
+    if(tty->font) {
+        tty->hw_cursor = cursor;
+        tty_draw_cursor(tty);
+        tty->video->driver->gfx.flush();
+    } else if(cursor != tty->hw_cursor) {
+        tty->video->driver->tm.move_cursor(cursor);
+        tty->hw_cursor = cursor;
     }
 }
 
+static void tty_draw_rows(tty_t* tty, size_t row, const uint16_t* cells, size_t count) {
+    if(!tty->font) {
+        tty->video->driver->tm.blit(row * tty->columns, cells, count * tty->columns);
+        return;
+    }
+
+    uint32_t width = tty->font->width;
+    uint32_t height = tty->font->height;
+
+    for(size_t y = row; y < row + count; y++) {
+        for(size_t x = 0; x < tty->columns; x++) {
+            uint16_t cell = *cells++;
+            uint32_t fgcolor = tty_gfx_palette[(cell >> 8) & 0x0F];
+            uint32_t bgcolor = tty_gfx_palette[(cell >> 12) & 0x0F];
+
+            const uint32_t* pixels = font_glyph_cache_get(tty->glyphs, cell & 0xFF, fgcolor, bgcolor);
+
+            tty->video->driver->gfx.blit(x * width, y * height, width, height, pixels);
+        }
+    }
+}
+
+static void tty_draw_cursor(tty_t* tty) {
+    if(!tty->cursor_enabled || tty->hw_cursor >= tty->rows * tty->columns) {
+        return;
+    }
+
+    uint32_t width = tty->font->width;
+    uint32_t height = tty->font->height;
+    uint32_t x = (tty->hw_cursor % tty->columns) * width;
+    uint32_t y = (tty->hw_cursor / tty->columns) * height;
+
+    // Underline cursor in the color of the cell, like the VGA text mode cursor
+    uint16_t cell = tty->cells[tty->hw_cursor];
+
+    tty->video->driver->gfx.draw_rect(x, y + height - 2, width, 2, tty_gfx_palette[(cell >> 8) & 0x0F]);
+}
+
+static void tty_put_cell(tty_t* tty, size_t x, size_t y, char ch) {
+    tty->cells[y * tty->columns + x] = VIDEO_TM_CELL(ch, tty->fgcolor, tty->bgcolor);
+    tty_mark_dirty(tty, y, y);
+}
+
+static void tty_mark_dirty(tty_t* tty, size_t first_row, size_t last_row) {
+    if(first_row < tty->dirty_start) {
+        tty->dirty_start = first_row;
+    }
+
+    if(last_row + 1 > tty->dirty_end) {
+        tty->dirty_end = last_row + 1;
+    }
+}
+
+static void tty_scroll(tty_t* tty) {
+    size_t row_cells = tty->columns;
+    size_t total_cells = tty->rows * tty->columns;
+
+    // Save the top row into the scrollback buffer, overwriting the oldest row
+    memcpy(tty->scrollback + tty->scrollback_head * row_cells, tty->cells, row_cells * sizeof(uint16_t));
+    tty->scrollback_head = (tty->scrollback_head + 1) % TTY_SCROLLBACK_ROWS;
+
+    if(tty->scrollback_count < TTY_SCROLLBACK_ROWS) {
+        tty->scrollback_count++;
+    }
+
+    // Keep a scrolled back view on the same rows
+    if(tty->scrollback_offset > 0 && tty->scrollback_offset < tty->scrollback_count) {
+        tty->scrollback_offset++;
+    }
+
+    memmove(tty->cells, tty->cells + row_cells, (total_cells - row_cells) * sizeof(uint16_t));
+    memsetw(tty->cells + total_cells - row_cells, VIDEO_TM_CELL(' ', tty->fgcolor, tty->bgcolor), row_cells);
+
+    // Dirty rows move up together with their content, the top row is gone
+    if(tty->dirty_start < tty->dirty_end) {
+        tty->dirty_start = tty->dirty_start > 0 ? tty->dirty_start - 1 : 0;
+        tty->dirty_end--;
+    }
+
+    tty_mark_dirty(tty, tty->rows - 1, tty->rows - 1);
+    tty->scroll_pending++;
+}
+
+static void tty_scroll_view(tty_t* tty, size_t offset) {
+    if(offset > tty->scrollback_count) {
+        offset = tty->scrollback_count;
+    }
+
+    if(offset == tty->scrollback_offset) {
+        return;
+    }
+
+    tty->scrollback_offset = offset;
+
+    if(offset > 0) {
+        tty_render_scrollback(tty);
+        return;
+    }
+
+    // Back to the live screen, the device holds the scrollback rows
+    tty->scroll_pending = 0;
+    tty_mark_dirty(tty, 0, tty->rows - 1);
+    tty->hw_cursor = tty->rows * tty->columns;
+    tty_flush(tty);
+}
+
+static void tty_render_scrollback(tty_t* tty) {
+    /*
+     * The view consists of the scrollback rows (oldest first) followed by the
+     * rows of the shadow buffer. Rows that are contiguous in memory are copied
+     * at once, so at most three copies are needed.
+     */
+    size_t first_line = tty->scrollback_count - tty->scrollback_offset;
+    size_t row = 0;
+
+    while(row < tty->rows) {
+        size_t line = first_line + row;
+        const uint16_t* source;
+        size_t count;
+
+        if(line < tty->scrollback_count) {
+            size_t slot = (tty->scrollback_head + TTY_SCROLLBACK_ROWS - tty->scrollback_count + line) % TTY_SCROLLBACK_ROWS;
+
+            source = tty->scrollback + slot * tty->columns;
+            count = TTY_SCROLLBACK_ROWS - slot;
+
+            if(count > tty->scrollback_count - line) {
+                count = tty->scrollback_count - line;
+            }
+        } else {
+            source = tty->cells + (line - tty->scrollback_count) * tty->columns;
+            count = tty->rows;
+        }
+
+        if(count > tty->rows - row) {
+            count = tty->rows - row;
+        }
+
+        tty_draw_rows(tty, row, source, count);
+        row += count;
+    }
+
+    if(tty->font) {
+        tty->video->driver->gfx.flush();
+    }
+}
+
+static void tty_erase_display(tty_t* tty) {
+    memsetw(tty->cells, VIDEO_TM_CELL(' ', tty->fgcolor, tty->bgcolor), tty->rows * tty->columns);
+
+    // Scrolling rows that are overwritten anyway is pointless
+    tty->scroll_pending = 0;
+    tty_mark_dirty(tty, 0, tty->rows - 1);
+
+    tty->cursor_x = 0;
+    tty->cursor_y = 0;
+}
+
 static void tty_render(tty_t* tty, char ch) {
     /*
      * Terminal escape-sequence parser. Output bytes are fed through a small
@@ -243,13 +524,13 @@ static void tty_render_char(tty_t* tty, char ch) {
                 tty->cursor_x--;
             }
 
-            tty->video->driver->tm.write(tty->cursor_y * tty->columns + tty->cursor_x, ' ', tty->fgcolor, tty->bgcolor);
+            tty_put_cell(tty, tty->cursor_x, tty->cursor_y, ' ');
             break;
         case '\t':
             tty->cursor_x = (tty->cursor_x + 8) & ~(8 - 1);
             break;
         default:
-            tty->video->driver->tm.write(tty->cursor_y * tty->columns + tty->cursor_x, ch, tty->fgcolor, tty->bgcolor);
+            tty_put_cell(tty, tty->cursor_x, tty->cursor_y, ch);
             tty->cursor_x++;
             break;
     }
@@ -262,12 +543,9 @@ static void tty_render_char(tty_t* tty, char ch) {
 
     // Check if end of screen has been reached
     if(tty->cursor_y >= tty->rows) {
-        tty->video->driver->tm.scroll(tty->fgcolor, tty->bgcolor);
+        tty_scroll(tty);
         tty->cursor_y--;
-        tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
     }
-
-    tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
 }
 
 static void tty_csi_dispatch(tty_t* tty, char command) {
@@ -275,7 +553,7 @@ static void tty_csi_dispatch(tty_t* tty, char command) {
         case 'J': {
             // Erase display. Only mode 2 (entire screen) is supported for now.
             if(tty->ansi_params[0] == 2) {
-                tty_clear(tty);
+                tty_erase_display(tty);
             }
 
             break;
@@ -296,15 +574,15 @@ static void tty_csi_dispatch(tty_t* tty, char command) {
 
             tty->cursor_y = row - 1;
             tty->cursor_x = col - 1;
-            tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
             break;
         }
         case 'K': {
             // Erase in line. Only mode 0 (cursor to end of line) is supported.
             if(tty->ansi_params[0] == 0) {
-                for(size_t x = tty->cursor_x; x < tty->columns; x++) {
-                    tty->video->driver->tm.write(tty->cursor_y * tty->columns + x, ' ', tty->fgcolor, tty->bgcolor);
-                }
+                size_t cell = tty->cursor_y * tty->columns + tty->cursor_x;
+
+                memsetw(tty->cells + cell, VIDEO_TM_CELL(' ', tty->fgcolor, tty->bgcolor), tty->columns - tty->cursor_x);
+                tty_mark_dirty(tty, tty->cursor_y, tty->cursor_y);
             }
 
             break;
@@ -315,7 +593,6 @@ static void tty_csi_dispatch(tty_t* tty, char command) {
             size_t max_x = tty->columns - 1;
 
             tty->cursor_x = (tty->cursor_x + amount > max_x) ? max_x : tty->cursor_x + amount;
-            tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
             break;
         }
         case 'D': {
@@ -323,7 +600,6 @@ static void tty_csi_dispatch(tty_t* tty, char command) {
             uint32_t amount = tty->ansi_params[0] ? tty->ansi_params[0] : 1;
 
             tty->cursor_x = (amount > tty->cursor_x) ? 0 : tty->cursor_x - amount;
-            tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
             break;
         }
         default:
@@ -343,6 +619,8 @@ stream_t* tty_get_out_stream(tty_t* tty) {
     stream->getchar = NULL;
     stream->puts = tty_stream_puts;
     stream->gets = NULL;
+    stream->write = tty_stream_write;
+    stream->read = NULL;
     stream->data = tty;
 
     return stream;
@@ -359,6 +637,8 @@ stream_t* tty_get_in_stream(tty_t* tty) {
     stream->getchar = tty_stream_getchar;
     stream->puts = NULL;
     stream->gets = tty_stream_gets;
+    stream->write = NULL;
+    stream->read = tty_stream_read;
     stream->data = tty;
 
     return stream;
@@ -368,11 +648,15 @@ stream_t* tty_get_err_stream(tty_t* tty) {
     return tty_get_out_stream(tty);
 }
 
-static tty_stream_putchar(stream_t* stream, char ch) {
+bool tty_is_stream(const stream_t* stream) {
+    return stream->write == tty_stream_write || stream->read == tty_stream_read;
+}
+
+static void tty_stream_putchar(stream_t* stream, char ch) {
     tty_putchar((tty_t*) stream->data, ch);
 }
 
-static char tty_stream_getchar(stream_t* stream) {
+static int tty_stream_getchar(stream_t* stream) {
     return tty_getchar((tty_t*) stream->data);
 }
 
@@ -384,33 +668,152 @@ static char* tty_stream_gets(stream_t* stream) {
     return tty_gets((tty_t*) stream->data);
 }
 
+static size_t tty_stream_write(stream_t* stream, const char* buffer, size_t size) {
+    return tty_write((tty_t*) stream->data, buffer, size);
+}
+
+static size_t tty_stream_read(stream_t* stream, char* buffer, size_t size) {
+    return tty_read((tty_t*) stream->data, buffer, size);
+}
+
 void tty_clear(tty_t* tty) {
-    for(size_t y = 0; y < tty->rows; y++) {
-        for(size_t x = 0; x < tty->columns; x++) {
-            tty->video->driver->tm.write(y * tty->columns + x, ' ', tty->fgcolor, tty->bgcolor);
+    tty_erase_display(tty);
+    tty_flush(tty);
+}
+
+void tty_putchar(tty_t* tty, char ch) {
+    tty_write(tty, &ch, 1);
+}
+
+size_t tty_write(tty_t* tty, const char* buffer, size_t size) {
+    for(size_t index = 0; index < size; index++) {
+        tty_render(tty, buffer[index]);
+    }
+
+    // The device is updated once per write instead of once per character
+    tty_flush(tty);
+
+    if(tty->mirror) {
+        stream_write(tty->mirror, buffer, size);
+    }
+
+    return size;
+}
+
+size_t tty_read(tty_t* tty, char* buffer, size_t size) {
+    size_t count = 0;
+
+    if(size == 0) {
+        return 0;
+    }
+
+    if(!(tty->mode & TTY_MODE_CANONICAL)) {
+        tty_wait_input(tty);
+
+        count = spsc_ring_dequeue_bulk(tty->input, buffer, size);
+
+        if(tty->mode & TTY_MODE_ECHO) {
+            tty_write(tty, buffer, count);
         }
+
+        return count;
     }
 
-    tty->cursor_x = 0;
-    tty->cursor_y = 0;
-    tty->video->driver->tm.move_cursor(tty->cursor_y * tty->columns + tty->cursor_x);
+    while(!tty->line_ready) {
+        tty_wait_input(tty);
+        tty_process_line(tty, size);
+    }
+
+    count = tty->line_length - tty->line_offset;
+
+    if(count > size) {
+        count = size;
+    }
+
+    memcpy(buffer, tty->line + tty->line_offset, count);
+    tty->line_offset += count;
+
+    // The line has been read completely, start editing the next one
+    if(tty->line_offset == tty->line_length) {
+        tty->line_length = 0;
+        tty->line_offset = 0;
+        tty->line_ready = false;
+    }
+
+    return count;
 }
 
-void tty_putchar(tty_t* tty, char ch) {
-    circular_buffer_enqueue(tty->output, &ch);
-    tty_flush(tty);
+static void tty_wait_input(tty_t* tty) {
+    uint32_t flags;
+
+    __asm__ volatile("pushfl\n"
+                     "pop %0"
+                     : "=r" (flags));
+
+    /*
+     * Syscalls run with interrupts disabled, so they are enabled for the wait only.
+     * The sti takes effect after the hlt, hence a key pressed between the check and
+     * the hlt still wakes the CPU up.
+     */
+    while(spsc_ring_empty(tty->input)) {
+        __asm__ volatile("sti\n"
+                         "hlt\n"
+                         "cli"
+                         :
+                         :
+                         : "memory");
+    }
+
+    if(flags & 0x200) {
+        __asm__ volatile("sti" ::: "memory");
+    }
 }
 
-char tty_getchar(tty_t* tty) {
-    char ch;
+static void tty_process_line(tty_t* tty, size_t size) {
+    uint8_t byte;
 
-    if(circular_buffer_empty(tty->input)) {
-        return -1;
+    while(!tty->line_ready && spsc_ring_get_byte(tty->input, &byte)) {
+        char ch = (char) byte;
+
+        // The cursor keys are enqueued as ESC [ <final byte>, they are ignored when editing a line
+        if(ch == 0x1B) {
+            spsc_ring_dequeue(tty->input, NULL);
+            spsc_ring_dequeue(tty->input, NULL);
+            continue;
+        }
+
+        if(ch == '\b') {
+            if(tty->line_length > 0) {
+                tty->line_length--;
+
+                if(tty->mode & TTY_MODE_ECHO) {
+                    tty_putchar(tty, ch);
+                }
+            }
+
+            continue;
+        }
+
+        tty->line[tty->line_length++] = ch;
+
+        if(tty->mode & TTY_MODE_ECHO) {
+            tty_putchar(tty, ch);
+        }
+
+        if(ch == '\n' || tty->line_length == TTY_LINE_SIZE || tty->line_length >= size) {
+            tty->line_ready = true;
+        }
     }
+}
+
+int tty_getchar(tty_t* tty) {
+    uint8_t byte;
 
-    circular_buffer_dequeue(tty->input, &ch);
+    if(!spsc_ring_get_byte(tty->input, &byte)) {
+        return -1;
+    }
 
-    return ch;
+    return byte;
 }
 
 static char tty_keycode_to_char(tty_t* tty, uint32_t keycode, bool shifted) {
@@ -428,9 +831,7 @@ static char tty_keycode_to_char(tty_t* tty, uint32_t keycode, bool shifted) {
 }
 
 void tty_puts(tty_t* tty, const char* str) {
-    for(size_t i = 0; str[i] != '\0'; i++) {
-        tty_putchar(tty, str[i]);
-    }
+    tty_write(tty, str, strlen(str));
 }
 
 char* tty_gets(tty_t* tty) {
@@ -439,8 +840,9 @@ char* tty_gets(tty_t* tty) {
     size_t buffer_index = 0;
 
     while(true) {
-        char ch;
-        while((ch = tty_getchar(tty)) == -1);
+        tty_wait_input(tty);
+
+        char ch = tty_getchar(tty);
 
         if(ch == '\n') {
             tty_putchar(tty, ch);
@@ -483,9 +885,39 @@ void tty_set_bgcolor(tty_t* tty, uint8_t bgcolor) {
 }
 
 void tty_disable_cursor(tty_t* tty) {
+    if(tty->font) {
+        // Redraw the cell under the cursor without it
+        tty->cursor_enabled = false;
+        tty->hw_cursor = tty->rows * tty->columns;
+        tty_mark_dirty(tty, tty->cursor_y, tty->cursor_y);
+        tty_flush(tty);
+        return;
+    }
+
     tty->video->driver->tm.disable_cursor();
 }
 
 void tty_enable_cursor(tty_t* tty) {
+    if(tty->font) {
+        tty->cursor_enabled = true;
+        tty_flush(tty);
+        return;
+    }
+
     tty->video->driver->tm.enable_cursor(0, 15);
 }
+
+void tty_set_mode(tty_t* tty, uint32_t mode) {
+    // A pending line is discarded when leaving canonical mode
+    if(!(mode & TTY_MODE_CANONICAL)) {
+        tty->line_length = 0;
+        tty->line_offset = 0;
+        tty->line_ready = false;
+    }
+
+    tty->mode = mode;
+}
+
+void tty_set_mirror(tty_t* tty, stream_t* stream) {
+    tty->mirror = stream;
+}
@@ -1,5 +1,5 @@
 #include <stdint.h>
-#include <stdlib.h>
+#include <util/numeric.h>
 #include <multiboot.h>
 #include <memory/pmm.h>
 #include <memory/vmm.h>
@@ -9,15 +9,19 @@
 #include <arch/i386/tss.h>
 #include <arch/i386/isr.h>
 #include <arch/i386/acpi.h>
+#include <arch/i386/cpu.h>
 #include <arch/i386/pic/8259.h>
 #include <system/timer.h>
 #include <system/kpanic.h>
 #include <system/kmessage.h>
 #include <system/syscall.h>
+#include <system/cmdline.h>
 #include <device/device.h>
 #include <device/volume.h>
 #include <drivers/pci/pci.h>
 #include <drivers/video/vga/vga.h>
+#include <drivers/video/vga/tm.h>
+#include <drivers/video/bga/bga.h>
 #include <drivers/serial/uart/16550.h>
 #include <drivers/input/ps2/keyboard.h>
 #include <drivers/storage/ata.h>
@@ -26,12 +30,18 @@
 #include <fs/mount.h>
 #include <io/tty.h>
 #include <io/stream.h>
+#include <io/font.h>
+#include <io/serial.h>
 #include <system/process.h>
 
+static stream_t* serial_stream = NULL;
+
 static void init_platform(multiboot_info_t *multiboot_info);
 static void init_kernel(multiboot_info_t *multiboot_info);
 static void init_drivers();
 static void init_console();
+static void init_local_console(stream_t** out_stream, stream_t** in_stream, stream_t** err_stream);
+static video_device_t* init_framebuffer_console();
 
 void kmain(multiboot_info_t *multiboot_info, uint32_t magic) {
     if(magic != MULTIBOOT_BOOTLOADER_MAGIC) {
@@ -69,6 +79,10 @@ void kmain(multiboot_info_t *multiboot_info, uint32_t magic) {
 }
 
 static void init_platform(multiboot_info_t *multiboot_info) {
+    // Detect the CPU features first to select the fastest memory primitives
+    cpu_init();
+    string_init();
+
     gdt_init();
     idt_init();
     tss_init(0x10, 0x0);
@@ -120,6 +134,17 @@ static void init_kernel(multiboot_info_t *multiboot_info) {
 
     multiboot_info = (multiboot_info_t*) ((uintptr_t) multiboot_info + VMM_KERNEL_SPACE_BASE);
 
+    if(multiboot_info->flags & MULTIBOOT_INFO_CMDLINE) {
+        cmdline_init((const char*) (multiboot_info->cmdline + VMM_KERNEL_SPACE_BASE));
+    }
+
+    // The budget of the block cache can be set in KiB, e.g. blockcache=4096
+    char cache_budget[16];
+
+    if(cmdline_get("blockcache", cache_budget, sizeof(cache_budget)) == 0) {
+        volume_cache_set_budget((size_t) atoi(cache_budget) * 1024);
+    }
+
     // Load initial ramdisk multiboot module if provided
     if(multiboot_info->mods_count > 0) {
         multiboot_module_t *initrd_module = multiboot_info->mods_addr + VMM_KERNEL_SPACE_BASE;
@@ -131,7 +156,12 @@ static void init_kernel(multiboot_info_t *multiboot_info) {
 }
 
 static void init_drivers() {
-    uart_16550_init(UART_16550_COM1, 115200);
+    // Mirror the kernel log to COM1 so headless runs get the full boot log
+    if(uart_16550_init(UART_16550_COM1, 115200) == 0) {
+        serial_stream = serial_create_stream(UART_16550_COM1);
+        kmessage_set_mirror(serial_stream);
+    }
+
     vga_init(VGA_80x25_16_TEXT, true);
     ps2_keyboard_init();
     pci_init();
@@ -152,9 +182,55 @@ static void init_console() {
         KPANIC(KPANIC_INITRD_MOUNT_FAILED_CODE, KPANIC_INITRD_MOUNT_FAILED_MESSAGE, NULL);
     }
 
+    stream_t* out_stream = NULL;
+    stream_t* in_stream = NULL;
+    stream_t* err_stream = NULL;
+
+    // The serial console is optional and falls back to the local console
+    if(cmdline_equals("console", "ttyS0")) {
+        if(serial_stream) {
+            out_stream = serial_stream;
+            in_stream = serial_stream;
+            err_stream = serial_stream;
+        } else {
+            kmessage(KMESSAGE_LEVEL_WARN, "serial: COM1 not available, using local console");
+        }
+    }
+
+    if(!out_stream) {
+        init_local_console(&out_stream, &in_stream, &err_stream);
+    }
+
+    // Launch the init process (PID 1). It runs in userland, never exits and is
+    // responsible for keeping a shell running. process_run does not return; if
+    // init ever exits, process_terminate raises a kernel panic.
+
+    const char* init_path = "A:/init.elf";
+    const char* init_argv[] = { init_path };
+
+    process_t* init = process_create("init", init_path, 1, init_argv, out_stream, in_stream, err_stream);
+
+    if(!init) {
+        KPANIC(KPANIC_INIT_START_FAILED_CODE, KPANIC_INIT_START_FAILED_MESSAGE, NULL);
+    }
+
+    process_run(init);
+}
+
+static void init_local_console(stream_t** out_stream, stream_t** in_stream, stream_t** err_stream) {
     // Ensure that io devices required for the CLI are available
 
-    video_device_t* video_device = device_find_by_type(DEVICE_TYPE_VIDEO);
+    video_device_t* video_device = NULL;
+
+    // The framebuffer console is optional and falls back to VGA text mode
+    if(cmdline_equals("console", "fb")) {
+        video_device = init_framebuffer_console();
+    }
+
+    if(!video_device) {
+        video_device = (video_device_t*) device_find_by_type(DEVICE_TYPE_VIDEO);
+    }
+
     keyboard_device_t* keyboard_device = device_find_by_type(DEVICE_TYPE_KEYBOARD);
 
     if(!video_device) {
@@ -168,22 +244,35 @@ static void init_console() {
     tty_t* tty0 = tty_create(video_device, keyboard_device, &tty_keyboard_layout_de_DE);
     tty_set_stdterm(tty0);
 
-    stream_t* out_stream = tty_get_out_stream(tty0);
-    stream_t* in_stream = tty_get_in_stream(tty0);
-    stream_t* err_stream = tty_get_err_stream(tty0);
+    if(cmdline_equals("mirror", "ttyS0") && serial_stream) {
+        tty_set_mirror(tty0, serial_stream);
+    }
 
-    // Launch the init process (PID 1). It runs in userland, never exits and is
-    // responsible for keeping a shell running. process_run does not return; if
-    // init ever exits, process_terminate raises a kernel panic.
+    *out_stream = tty_get_out_stream(tty0);
+    *in_stream = tty_get_in_stream(tty0);
+    *err_stream = tty_get_err_stream(tty0);
+}
 
-    const char* init_path = "A:/init.elf";
-    const char* init_argv[] = { init_path };
+static video_device_t* init_framebuffer_console() {
+    // Borrow the font of the VGA character generator before leaving text mode
+    uint8_t* bitmap = (uint8_t*) kmalloc(VGA_TM_FONT_GLYPHS * VGA_TM_FONT_HEIGHT);
 
-    process_t* init = process_create("init", init_path, 1, init_argv, out_stream, in_stream, err_stream);
+    if(!bitmap) {
+        KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_CODE, KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, NULL);
+    }
 
-    if(!init) {
-        KPANIC(KPANIC_INIT_START_FAILED_CODE, KPANIC_INIT_START_FAILED_MESSAGE, NULL);
+    if(vga_tm_read_font(bitmap) != 0) {
+        kfree(bitmap);
+        return NULL;
     }
 
-    process_run(init);
+    font_set_default(font_create(8, VGA_TM_FONT_HEIGHT, bitmap));
+    kfree(bitmap);
+
+    if(bga_init(1024, 768) != 0) {
+        kmessage(KMESSAGE_LEVEL_WARN, "bga: No framebuffer available, using text mode console");
+        return NULL;
+    }
+
+    return (video_device_t*) device_find_by_name("Bochs Graphics Adapter");
 }
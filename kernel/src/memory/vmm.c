@@ -280,7 +280,7 @@ page_directory_t* vmm_clone_address_space(page_directory_t *src_page_directory)
 
                         tmp_virtual_address = vmm_map_page(NULL, (void*) dst_physical_address, false, true);
 
-                        memcpy((void*) tmp_virtual_address, (void*) src_virtual_address, PAGE_SIZE);
+                        copy_page((void*) tmp_virtual_address, (void*) src_virtual_address);
 
                         vmm_unmap_page((void*) tmp_virtual_address);
 
@@ -0,0 +1,64 @@
+#include <system/cmdline.h>
+#include <util/string.h>
+
+static char cmdline_buffer[CMDLINE_MAX_LENGTH] = "";
+
+void cmdline_init(const char* cmdline) {
+    if(cmdline == NULL) {
+        cmdline_buffer[0] = '\0';
+        return;
+    }
+
+    strncpy(cmdline_buffer, cmdline, CMDLINE_MAX_LENGTH - 1);
+    cmdline_buffer[CMDLINE_MAX_LENGTH - 1] = '\0';
+}
+
+int32_t cmdline_get(const char* key, char* buffer, size_t size) {
+    size_t key_length = strlen(key);
+    const char* option = cmdline_buffer;
+
+    while(*option) {
+        // Skip separators
+        if(*option == ' ') {
+            option++;
+            continue;
+        }
+
+        size_t option_length = 0;
+
+        while(option[option_length] && option[option_length] != ' ') {
+            option_length++;
+        }
+
+        if(option_length >= key_length && strncmp(option, key, key_length) == 0 &&
+           (option_length == key_length || option[key_length] == '=')) {
+            const char* value = option_length > key_length ? option + key_length + 1 : option + option_length;
+            size_t value_length = option_length - (value - option);
+
+            if(size > 0) {
+                if(value_length >= size) {
+                    value_length = size - 1;
+                }
+
+                memcpy(buffer, value, value_length);
+                buffer[value_length] = '\0';
+            }
+
+            return 0;
+        }
+
+        option += option_length;
+    }
+
+    return -1;
+}
+
+bool cmdline_equals(const char* key, const char* value) {
+    char buffer[CMDLINE_MAX_LENGTH];
+
+    if(cmdline_get(key, buffer, sizeof(buffer)) != 0) {
+        return false;
+    }
+
+    return strcmp(buffer, value) == 0;
+}
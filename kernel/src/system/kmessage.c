@@ -3,6 +3,9 @@
 #include <memory/kheap.h>
 
 static linked_list_t* kmessage_messages = NULL;
+static stream_t* kmessage_mirror = NULL;
+
+static void kmessage_write_mirror(const kmessage_message_t* message);
 
 void kmessage_init() {
     kmessage_messages = linked_list_create();
@@ -23,7 +26,7 @@ void kmessage(const char* level, const char* message) {
         KPANIC(KPANIC_KHEAP_OUT_OF_MEMORY_MESSAGE, KPANIC_KHEAP_OUT_OF_MEMORY_CODE, NULL);
     }
 
-    kmessage_message->level = KMESSAGE_LEVEL_INFO;
+    kmessage_message->level = level;
     kmessage_message->message = message;
 
     linked_list_node_t* node = linked_list_create_node(kmessage_message);
@@ -33,4 +36,24 @@ void kmessage(const char* level, const char* message) {
     }
 
     linked_list_append(kmessage_messages, node);
+
+    if(kmessage_mirror) {
+        kmessage_write_mirror(kmessage_message);
+    }
+}
+
+void kmessage_set_mirror(stream_t* stream) {
+    kmessage_mirror = stream;
+
+    if(!kmessage_mirror) {
+        return;
+    }
+
+    linked_list_foreach(kmessage_messages, node) {
+        kmessage_write_mirror((kmessage_message_t*) node->data);
+    }
+}
+
+static void kmessage_write_mirror(const kmessage_message_t* message) {
+    stream_printf(kmessage_mirror, "[%s] %s\n", message->level, message->message);
 }
@@ -4,6 +4,7 @@
 #include <io/file.h>
 #include <io/dir.h>
 #include <io/tty.h>
+#include <io/serial.h>
 #include <device/device.h>
 #include <device/volume.h>
 #include <fs/mount.h>
@@ -14,6 +15,7 @@
 #include <util/linked_list.h>
 #include <util/uuid.h>
 #include <arch/i386/acpi.h>
+#include <arch/i386/cpu.h>
 #include <system/process.h>
 #include <kernel.h>
 #include <memory/pmm.h>
@@ -37,9 +39,28 @@ struct terminfo {
     uint32_t cols;
 };
 
+struct cacheinfo {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t blocks;
+    uint32_t dirty;
+    uint32_t block_size;
+    uint32_t budget;
+};
+
+struct cpuinfo {
+    char vendor[16];
+    char brand[48];
+    uint32_t family;
+    uint32_t model;
+    uint32_t stepping;
+    uint32_t features;
+};
+
 struct dirent {
     char name[256];
     uint32_t inode;
+    uint8_t type;
 };
 
 struct volinfo {
@@ -143,6 +164,26 @@ static int32_t syscall_open(isr_cpu_state_t *state);
  */
 static int32_t syscall_close(isr_cpu_state_t *state);
 
+/**
+ * Seek syscall handler.
+ * 
+ * Syscall expects the following parameters:
+ * 
+ * - eax: Syscall number
+ * 
+ * - ebx: File descriptor
+ * 
+ * - ecx: Offset
+ * 
+ * - edx: Whence
+ * 
+ * Syscall returns the new file offset or -1 on error.
+ * 
+ * @param state The CPU state.
+ * @return The new file offset or -1 on error.
+ */
+static int32_t syscall_seek(isr_cpu_state_t *state);
+
 /**
  * Get sysinfo syscall handler.
  * 
@@ -191,6 +232,22 @@ static int32_t syscall_get_meminfo(isr_cpu_state_t *state);
  */
 static int32_t syscall_get_terminfo(isr_cpu_state_t *state);
 
+/**
+ * Set terminal mode syscall handler.
+ *
+ * Syscall expects the following parameters:
+ *
+ * - eax: Syscall number
+ *
+ * - ebx: Line discipline mode (canonical and echo flags)
+ *
+ * Syscall returns 0 on success or -1 if stdin is not a terminal.
+ *
+ * @param state The CPU state.
+ * @return 0 on success or -1 on error.
+ */
+static int32_t syscall_set_termmode(isr_cpu_state_t *state);
+
 /**
  * Allocate/increase heap syscall handler.
  * 
@@ -428,6 +485,21 @@ static int32_t syscall_memmap(isr_cpu_state_t *state);
  */
 static int32_t syscall_get_kheapinfo(isr_cpu_state_t *state);
 
+/**
+ * Get block cache info syscall handler.
+ *
+ * Syscall expects the following parameters:
+ *
+ * - eax: Syscall number
+ *
+ * - ebx: Pointer to a cacheinfo struct to fill
+ *
+ * Syscall returns 0 on success or -1 on error.
+ *
+ * @param state The CPU state.
+ */
+static int32_t syscall_get_cacheinfo(isr_cpu_state_t *state);
+
 /**
  * Spawn syscall handler.
  *
@@ -450,6 +522,56 @@ static int32_t syscall_get_kheapinfo(isr_cpu_state_t *state);
  */
 static int32_t syscall_spawn(isr_cpu_state_t *state);
 
+/**
+ * Get CPU information syscall handler.
+ *
+ * Syscall expects the following parameters:
+ *
+ * - eax: Syscall number
+ *
+ * - ebx: Pointer to a cpuinfo struct to fill
+ *
+ * Syscall returns 0 on success or -1 on error.
+ *
+ * @param state The CPU state.
+ */
+static int32_t syscall_get_cpuinfo(isr_cpu_state_t *state);
+
+/**
+ * Sync syscall handler.
+ *
+ * Syscall expects the following parameters:
+ *
+ * - eax: Syscall number
+ *
+ * Writes back all pending changes of all mounted file systems. Syscall returns
+ * 0 on success or -1 if any file system failed to sync.
+ *
+ * @param state The CPU state.
+ */
+static int32_t syscall_sync(isr_cpu_state_t *state);
+
+/**
+ * Get directory entries syscall handler.
+ *
+ * Syscall expects the following parameters:
+ *
+ * - eax: Syscall number
+ *
+ * - ebx: Directory descriptor
+ *
+ * - ecx: Pointer to a user buffer to fill with dirent records
+ *
+ * - edx: Size of the buffer
+ *
+ * Fills the buffer with as many of the next entries as fit. Syscall returns the number of
+ * bytes filled, 0 when there are no more entries or -1 on error or if the buffer is too
+ * small for the next entry.
+ *
+ * @param state The CPU state.
+ */
+static int32_t syscall_getdents(isr_cpu_state_t *state);
+
 void syscall_init() {
     isr_register_listener(SYSCALL_INTERRUPT, syscall_handler);
 }
@@ -474,6 +596,10 @@ static void syscall_handler(isr_cpu_state_t *state) {
             state->eax = syscall_close(state);
             break;
         }
+        case SYSCALL_SEEK: {
+            state->eax = syscall_seek(state);
+            break;
+        }
         case SYSCALL_GET_OSINFO: {
             state->eax = syscall_get_osinfo(state);
             break;
@@ -486,6 +612,10 @@ static void syscall_handler(isr_cpu_state_t *state) {
             state->eax = syscall_get_terminfo(state);
             break;
         }
+        case SYSCALL_SET_TERMMODE: {
+            state->eax = syscall_set_termmode(state);
+            break;
+        }
         case SYSCALL_ALLOC_HEAP: {
             state->eax = syscall_alloc_heap(state);
             break;
@@ -546,10 +676,26 @@ static void syscall_handler(isr_cpu_state_t *state) {
             state->eax = syscall_get_kheapinfo(state);
             break;
         }
+        case SYSCALL_GET_CACHEINFO: {
+            state->eax = syscall_get_cacheinfo(state);
+            break;
+        }
         case SYSCALL_SPAWN: {
             state->eax = syscall_spawn(state);
             break;
         }
+        case SYSCALL_GET_CPUINFO: {
+            state->eax = syscall_get_cpuinfo(state);
+            break;
+        }
+        case SYSCALL_SYNC: {
+            state->eax = syscall_sync(state);
+            break;
+        }
+        case SYSCALL_GETDENTS: {
+            state->eax = syscall_getdents(state);
+            break;
+        }
         default: {
             state->eax = -1;
             break;
@@ -570,25 +716,14 @@ static int32_t syscall_read(isr_cpu_state_t *state) {
 
     // Read from stdin
     if(current_process && current_process->in && fd == 0) {
-        char ch;
-        for(size_t i = 0; i < size; i++) {
-            /*
-             * It is important to read character wise using getchar, because gets or
-             * similar functions will read until it encounters a newline character
-             * and hence will block the whole system because interrupts are disabled
-             * during syscalls. It will result in a deadlock because interrupts are
-             * required to handle keyboard input. Because getchar is implemented using
-             * raw instead of canonical mode, it will not block on missing input.
-             */
-
-            if((ch = stream_getchar(current_process->in)) <= 0) {
-                return i;
-            }
-
-            buffer[i] = ch;
-        }
-
-        return size;
+        /*
+         * It is important to read only the available input in raw mode, because gets
+         * or similar functions will read until it encounters a newline character
+         * and hence will block the whole system because interrupts are disabled
+         * during syscalls. It will result in a deadlock because interrupts are
+         * required to handle keyboard input.
+         */
+        return stream_read(current_process->in, (char*) buffer, size);
     }
 
     // Read from file
@@ -610,28 +745,14 @@ static int32_t syscall_write(isr_cpu_state_t *state) {
 
     process_t* current_process = process_get_current();
 
-    // Write to stdout
+    // Write to stdout, the user buffer is passed through without copying
     if(current_process && current_process->out && fd == 1) {
-        char* message = kmalloc(size + 1);
-        memcpy(message, buffer, size);
-        message[size] = '\0';
-
-        stream_puts(current_process->out, message);
-
-        kfree(message);
-        return size;
+        return stream_write(current_process->out, (const char*) buffer, size);
     }
 
     // Write to stderr
     if(current_process && current_process->err && fd == 2) {
-        char* message = kmalloc(size + 1);
-        memcpy(message, buffer, size);
-        message[size] = '\0';
-
-        stream_puts(current_process->err, message);
-
-        kfree(message);
-        return size;
+        return stream_write(current_process->err, (const char*) buffer, size);
     }
 
     // Write to file
@@ -650,11 +771,6 @@ static int32_t syscall_open(isr_cpu_state_t *state) {
     process_t* current_process = process_get_current();
 
     if(current_process) {
-        // Creating files is not supported yet
-        if(flags & FILE_CREAT) {
-            return -1;
-        }
-
         int32_t fd = -1;
 
         // Find first free file descriptor, skip over stdin/stdout/stderr
@@ -705,6 +821,28 @@ static int32_t syscall_close(isr_cpu_state_t *state) {
     return -1;
 }
 
+static int32_t syscall_seek(isr_cpu_state_t *state) {
+    int32_t fd = state->ebx;
+    int32_t offset = state->ecx;
+    int32_t whence = state->edx;
+
+    if(fd < 0 || fd >= PROCESS_MAX_FILE_DESCRIPTORS) {
+        return -1;
+    }
+
+    process_t* current_process = process_get_current();
+
+    if(current_process && current_process->files[fd]) {
+        if(file_seek(current_process->files[fd], offset, whence) < 0) {
+            return -1;
+        }
+
+        return current_process->files[fd]->offset;
+    }
+
+    return -1;
+}
+
 static int32_t syscall_get_osinfo(isr_cpu_state_t *state) {
     struct osinfo* info = (struct osinfo*) state->ebx;
 
@@ -741,19 +879,40 @@ static int32_t syscall_get_terminfo(isr_cpu_state_t *state) {
         return -1;
     }
 
-    // The process' output stream is backed by a TTY, which knows its dimensions.
-    tty_t* tty = (tty_t*) current_process->out->data;
+    // A TTY knows its dimensions, the size of a serial terminal is assumed.
+    if(serial_is_stream(current_process->out)) {
+        info->rows = SERIAL_TERMINAL_ROWS;
+        info->cols = SERIAL_TERMINAL_COLUMNS;
+
+        return 0;
+    }
 
-    if(!tty) {
+    if(!tty_is_stream(current_process->out)) {
         return -1;
     }
 
+    tty_t* tty = (tty_t*) current_process->out->data;
+
     info->rows = tty->rows;
     info->cols = tty->columns;
 
     return 0;
 }
 
+static int32_t syscall_set_termmode(isr_cpu_state_t *state) {
+    uint32_t mode = state->ebx;
+
+    process_t* current_process = process_get_current();
+
+    if(!current_process || !current_process->in || !tty_is_stream(current_process->in)) {
+        return -1;
+    }
+
+    tty_set_mode((tty_t*) current_process->in->data, mode & (TTY_MODE_CANONICAL | TTY_MODE_ECHO));
+
+    return 0;
+}
+
 static void* syscall_alloc_heap(isr_cpu_state_t *state) {
     uint32_t n_pages = state->ebx;
 
@@ -819,19 +978,16 @@ static int32_t syscall_readdir(isr_cpu_state_t *state) {
         return -1;
     }
 
-    // dir_read returns a kmalloc'd entry; copy its fields into the caller's
-    // buffer and free it instead of handing a kernel pointer to userland.
-    const dir_dirent_t* dirent = dir_read(dd);
+    dir_dirent_t dirent;
 
-    if(!dirent) {
+    if(dir_read(dd, &dirent) != 0) {
         return -1;
     }
 
-    strncpy(user_entry->name, dirent->name, sizeof(user_entry->name));
+    strncpy(user_entry->name, dirent.name, sizeof(user_entry->name));
     user_entry->name[sizeof(user_entry->name) - 1] = '\0';
-    user_entry->inode = dirent->inode;
-
-    kfree((void*) dirent);
+    user_entry->inode = dirent.inode;
+    user_entry->type = dirent.type;
 
     return 0;
 }
@@ -872,6 +1028,9 @@ static int32_t syscall_lsvol(isr_cpu_state_t *state) {
 static int32_t syscall_poweroff(isr_cpu_state_t *state) {
     (void) state;
 
+    // Write back cached changes before the power is cut
+    mnt_sync();
+
     // On success the machine powers off here and never returns; a return value
     // means the power off failed and is reported back to userland.
     return acpi_poweroff();
@@ -1060,6 +1219,26 @@ static int32_t syscall_get_kheapinfo(isr_cpu_state_t *state) {
     return 0;
 }
 
+static int32_t syscall_get_cacheinfo(isr_cpu_state_t *state) {
+    struct cacheinfo* info = (struct cacheinfo*) state->ebx;
+
+    if(!info) {
+        return -1;
+    }
+
+    volume_cache_stats_t stats;
+    volume_cache_get_stats(&stats);
+
+    info->hits = stats.hits;
+    info->misses = stats.misses;
+    info->blocks = stats.blocks;
+    info->dirty = stats.dirty;
+    info->block_size = VOLUME_CACHE_BLOCK_SIZE;
+    info->budget = stats.budget;
+
+    return 0;
+}
+
 static int32_t syscall_spawn(isr_cpu_state_t *state) {
     const char* user_path = (const char*) state->ebx;
     char** user_argv = (char**) state->ecx;
@@ -1145,3 +1324,41 @@ static int32_t syscall_spawn(isr_cpu_state_t *state) {
     // process_run does not return; the parent is resumed via process_terminate.
     return 0;
 }
+
+static int32_t syscall_get_cpuinfo(isr_cpu_state_t *state) {
+    struct cpuinfo* info = (struct cpuinfo*) state->ebx;
+
+    if(!info) {
+        return -1;
+    }
+
+    const cpu_info_t* cpu = cpu_get_info();
+
+    strncpy(info->vendor, cpu->vendor, 16);
+    info->vendor[15] = '\0';
+
+    strncpy(info->brand, cpu->brand, 48);
+    info->brand[47] = '\0';
+
+    info->family = cpu->family;
+    info->model = cpu->model;
+    info->stepping = cpu->stepping;
+    info->features = cpu->features;
+
+    return 0;
+}
+
+static int32_t syscall_sync(isr_cpu_state_t *state) {
+    (void) state;
+
+    return mnt_sync();
+}
+
+static int32_t syscall_getdents(isr_cpu_state_t *state) {
+    int32_t dd = state->ebx;
+    void* buffer = (void*) state->ecx;
+    size_t size = state->edx;
+
+    // The records are laid out like the user dirent_record struct, so they are filled in place
+    return dir_getdents(dd, buffer, size);
+}
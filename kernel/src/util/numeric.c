@@ -39,6 +39,27 @@ char *itoa(int32_t n, char *buf, uint32_t base) {
     return strrev(buf);
 }
 
+int32_t atoi(const char *str) {
+    int32_t value = 0;
+    bool is_negative = false;
+
+    while(*str == ' ' || *str == '\t') {
+        str++;
+    }
+
+    if(*str == '-' || *str == '+') {
+        is_negative = *str == '-';
+        str++;
+    }
+
+    while(*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str - '0');
+        str++;
+    }
+
+    return is_negative ? -value : value;
+}
+
 char *gcvt(double n, int precision, char *buf) {
     char *ptr = buf;
 
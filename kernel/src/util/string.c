@@ -1,7 +1,41 @@
 #include <util/string.h>
-#include <stdarg.h>
+#include <arch/i386/paging.h>
+#include <arch/i386/cpu.h>
+#include <util/numeric.h>
+#include <format.h>
+
+static void *memcpy_dword(void *dest, const void *src, size_t n);
+static void *memcpy_erms(void *dest, const void *src, size_t n);
+static void *memset_dword(void *dest, uint8_t ch, size_t n);
+static void *memset_erms(void *dest, uint8_t ch, size_t n);
+static void *copy_page_dword(void *dest, const void *src);
+static void *copy_page_movnti(void *dest, const void *src);
+static void *zero_page_dword(void *dest);
+static void *zero_page_erms(void *dest);
+
+/*
+ * Variants of the hot memory primitives, selected by string_init for the
+ * running CPU. The generic dword variants are used until then.
+ */
+
+static void *(*memcpy_variant)(void*, const void*, size_t) = memcpy_dword;
+static void *(*memset_variant)(void*, uint8_t, size_t) = memset_dword;
+static void *(*copy_page_variant)(void*, const void*) = copy_page_dword;
+static void *(*zero_page_variant)(void*) = zero_page_dword;
+
+void string_init(void) {
+    // Enhanced REP MOVSB/STOSB makes byte string operations the fastest option
+    if(cpu_has_feature(CPU_FEATURE_ERMS)) {
+        memcpy_variant = memcpy_erms;
+        memset_variant = memset_erms;
+        zero_page_variant = zero_page_erms;
+    }
 
-static int vstrfmt(char * str, const char *format, va_list args);
+    // Copied frames are usually not touched again soon, so bypass the cache
+    if(cpu_has_feature(CPU_FEATURE_SSE2)) {
+        copy_page_variant = copy_page_movnti;
+    }
+}
 
 int memcmp(const void *s1, const void *s2, size_t n) {
 
@@ -24,33 +58,189 @@ int memcmp(const void *s1, const void *s2, size_t n) {
 }
 
 void *memcpy(void *dest, const void *src, size_t n) {
-    char *d = dest;
-    const char *s = src;
-    while(n--) {
-        *d++ = *s++;
+    return memcpy_variant(dest, src, n);
+}
+
+void *memset(void *dest, uint8_t ch, size_t n) {
+    return memset_variant(dest, ch, n);
+}
+
+void *copy_page(void *dest, const void *src) {
+    return copy_page_variant(dest, src);
+}
+
+void *zero_page(void *dest) {
+    return zero_page_variant(dest);
+}
+
+static void *memcpy_dword(void *dest, const void *src, size_t n) {
+    void *d = dest;
+    const void *s = src;
+
+    // Copy single bytes until the destination is dword aligned
+    size_t head = (-(uintptr_t) d) & (sizeof(uint32_t) - 1);
+
+    if(head > n) {
+        head = n;
     }
+
+    n -= head;
+
+    size_t dwords = n / sizeof(uint32_t);
+    size_t tail = n % sizeof(uint32_t);
+
+    __asm__ volatile("rep movsb" : "+D" (d), "+S" (s), "+c" (head) : : "memory");
+    __asm__ volatile("rep movsl" : "+D" (d), "+S" (s), "+c" (dwords) : : "memory");
+    __asm__ volatile("rep movsb" : "+D" (d), "+S" (s), "+c" (tail) : : "memory");
+
     return dest;
 }
 
-void *memset(void *dest, uint8_t ch, size_t n) {
-    uint8_t *ptr = (uint8_t *) dest;
-    uint8_t *end = ptr + n;
+static void *memcpy_erms(void *dest, const void *src, size_t n) {
+    void *d = dest;
+    const void *s = src;
+
+    __asm__ volatile("rep movsb" : "+D" (d), "+S" (s), "+c" (n) : : "memory");
 
-    while(ptr != end) {
-        *ptr++ = ch;
+    return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t n) {
+    // A forward copy is safe unless the destination overlaps the end of the source
+    if((uintptr_t) dest <= (uintptr_t) src || (uintptr_t) dest >= (uintptr_t) src + n) {
+        return memcpy(dest, src, n);
     }
 
+    /*
+     * Copy backwards with the direction flag set. The odd tail bytes at the end of the
+     * region are moved first, afterwards the pointers are rewound to the last full dword.
+     */
+    void *d = (uint8_t*) dest + n - 1;
+    const void *s = (const uint8_t*) src + n - 1;
+    size_t tail = n % sizeof(uint32_t);
+    size_t dwords = n / sizeof(uint32_t);
+
+    __asm__ volatile(
+        "std\n"
+        "rep movsb\n"
+        "sub $3, %%edi\n"
+        "sub $3, %%esi\n"
+        "mov %3, %%ecx\n"
+        "rep movsl\n"
+        "cld\n"
+        : "+D" (d), "+S" (s), "+c" (tail)
+        : "g" (dwords)
+        : "memory");
+
+    return dest;
+}
+
+static void *memset_dword(void *dest, uint8_t ch, size_t n) {
+    void *d = dest;
+    uint32_t pattern = (uint32_t) ch * 0x01010101u;
+
+    // Store single bytes until the destination is dword aligned
+    size_t head = (-(uintptr_t) d) & (sizeof(uint32_t) - 1);
+
+    if(head > n) {
+        head = n;
+    }
+
+    n -= head;
+
+    size_t dwords = n / sizeof(uint32_t);
+    size_t tail = n % sizeof(uint32_t);
+
+    __asm__ volatile("rep stosb" : "+D" (d), "+c" (head) : "a" (pattern) : "memory");
+    __asm__ volatile("rep stosl" : "+D" (d), "+c" (dwords) : "a" (pattern) : "memory");
+    __asm__ volatile("rep stosb" : "+D" (d), "+c" (tail) : "a" (pattern) : "memory");
+
+    return dest;
+}
+
+static void *memset_erms(void *dest, uint8_t ch, size_t n) {
+    void *d = dest;
+
+    __asm__ volatile("rep stosb" : "+D" (d), "+c" (n) : "a" (ch) : "memory");
+
     return dest;
 }
 
 void *memsetw(void *dest, uint16_t value, size_t n) {
-    uint16_t *ptr = (uint16_t *) dest;
-    uint16_t *end = ptr + n;
+    void *d = dest;
+    uint32_t pattern = value | ((uint32_t) value << 16);
 
-    while(ptr != end) {
-        *ptr++ = value;
+    // A single word aligns a word aligned destination to a dword boundary
+    size_t head = ((uintptr_t) d & 0x02) && n > 0 ? 1 : 0;
+
+    n -= head;
+
+    size_t dwords = n / 2;
+    size_t tail = n % 2;
+
+    __asm__ volatile("rep stosw" : "+D" (d), "+c" (head) : "a" (pattern) : "memory");
+    __asm__ volatile("rep stosl" : "+D" (d), "+c" (dwords) : "a" (pattern) : "memory");
+    __asm__ volatile("rep stosw" : "+D" (d), "+c" (tail) : "a" (pattern) : "memory");
+
+    return dest;
+}
+
+void *memsetl(void *dest, uint32_t value, size_t n) {
+    void *d = dest;
+
+    __asm__ volatile("rep stosl" : "+D" (d), "+c" (n) : "a" (value) : "memory");
+
+    return dest;
+}
+
+static void *copy_page_dword(void *dest, const void *src) {
+    void *d = dest;
+    const void *s = src;
+    size_t dwords = PAGE_SIZE / sizeof(uint32_t);
+
+    __asm__ volatile("rep movsl" : "+D" (d), "+S" (s), "+c" (dwords) : : "memory");
+
+    return dest;
+}
+
+static void *copy_page_movnti(void *dest, const void *src) {
+    uint32_t *d = dest;
+    const uint32_t *s = src;
+
+    // Non-temporal stores write the frame without polluting the cache
+    for(size_t index = 0; index < PAGE_SIZE / sizeof(uint32_t); index += 4) {
+        uint32_t a = s[index], b = s[index + 1], c = s[index + 2], e = s[index + 3];
+
+        __asm__ volatile(
+            "movnti %1, 0(%0)\n"
+            "movnti %2, 4(%0)\n"
+            "movnti %3, 8(%0)\n"
+            "movnti %4, 12(%0)\n"
+            :
+            : "r" (d + index), "r" (a), "r" (b), "r" (c), "r" (e)
+            : "memory");
     }
 
+    __asm__ volatile("sfence" : : : "memory");
+
+    return dest;
+}
+
+static void *zero_page_dword(void *dest) {
+    void *d = dest;
+    size_t dwords = PAGE_SIZE / sizeof(uint32_t);
+
+    __asm__ volatile("rep stosl" : "+D" (d), "+c" (dwords) : "a" (0) : "memory");
+
+    return dest;
+}
+
+static void *zero_page_erms(void *dest) {
+    void *d = dest;
+    size_t n = PAGE_SIZE;
+
+    __asm__ volatile("rep stosb" : "+D" (d), "+c" (n) : "a" (0) : "memory");
+
     return dest;
 }
 
@@ -180,125 +370,19 @@ char *strsep(char **stringp, const char *delim) {
 int strfmt(char * str, const char * format, ... ) {
     va_list args;
     va_start(args, format);
-    int ret = vstrfmt(str, format, args);
+    int ret = vstrnfmt(str, (size_t) -1, format, args);
     va_end(args);
     return ret;
 }
 
-static int vstrfmt(char* str, const char *format, va_list args) {
-    int count = 0;
-
-    while(*format != '\0') {
-        if(*format == '%') {
-            format++;
-
-            switch(*format) {
-                case '%': {
-                    str[count] = '%';
-                    count++;
-                    break;
-                }
-                case 'c': {
-                    char ch = va_arg(args, int);
-                    str[count] = ch;
-                    count++;
-                    break;
-                }
-                case 's': {
-                    const char *placement_str = va_arg(args, const char*);
-
-                    while(*placement_str != '\0') {
-                        str[count] = *placement_str;
-                        placement_str++;
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'd': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    itoa(num, num_str, 10);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        str[count] = num_str[i];
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'x': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    str[count++] = '0';
-                    str[count++] = 'x';
-
-                    itoa(num, num_str, 16);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        str[count] = num_str[i];
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'p': {
-                    void *ptr = va_arg(args, void*);
-                    char ptr_str[32];
-
-                    itoa((uintptr_t) ptr, ptr_str, 16);
-
-                    for(int i = 0; ptr_str[i] != '\0'; i++) {
-                        str[count] = ptr_str[i];
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'b': {
-                    int num = va_arg(args, int);
-                    char num_str[32];
-
-                    str[count++] = '0';
-                    str[count++] = 'b';
-
-                    itoa(num, num_str, 2);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        str[count] = num_str[i];
-                        count++;
-                    }
-
-                    break;
-                }
-                case 'f': {
-                    double num = va_arg(args, double);
-                    char num_str[32];
-
-                    gcvt(num, 2, num_str);
-
-                    for(int i = 0; num_str[i] != '\0'; i++) {
-                        str[count] = num_str[i];
-                        count++;
-                    }
-
-                    break;
-                }
-                default: {
-                    break;
-                }
-            }
-        } else {
-            str[count] = *format;
-            count++;
-        }
-
-        format++;
-    }
-
-    str[count] = '\0';
+int strnfmt(char* str, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int ret = vstrnfmt(str, size, format, args);
+    va_end(args);
+    return ret;
+}
 
-    return count;
+int vstrnfmt(char* str, size_t size, const char* format, va_list args) {
+    return __vformat(str, size, NULL, NULL, format, args);
 }
@@ -7,30 +7,153 @@
 
 #define EOF (-1)
 
+#define BUFSIZ 1024
+
+#define PRINTF_CHUNK_SIZE 256
+
+#define _IOFBF 0
+#define _IOLBF 1
+#define _IONBF 2
+
+#define SEEK_SET 0
+#define SEEK_CUR 1
+#define SEEK_END 2
+
+#define __FILE_STATE_SETUP   0b000000001
+#define __FILE_STATE_READING 0b000000010
+#define __FILE_STATE_WRITING 0b000000100
+#define __FILE_STATE_EOF     0b000001000
+#define __FILE_STATE_ERROR   0b000010000
+#define __FILE_STATE_TTY     0b000100000
+#define __FILE_STATE_STD     0b001000000
+#define __FILE_STATE_OWNBUF  0b010000000
+#define __FILE_STATE_MODESET 0b100000000
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * A buffered stream. While writing, position is the number of pending bytes in
+ * the buffer. While reading, the buffer holds length bytes of which the bytes
+ * before position were already consumed.
+ */
 struct _FILE {
     int32_t fd;
     uint32_t flags;
+    uint32_t state;
+    int32_t mode;
+    char* buffer;
+    size_t buffer_size;
+    size_t position;
+    size_t length;
+    struct _FILE* next;
 };
 
 typedef struct _FILE FILE;
 
+extern FILE* stdin;
+extern FILE* stdout;
+extern FILE* stderr;
+
+#define stdin stdin
+#define stdout stdout
+#define stderr stderr
+
+/**
+ * Prepares a stream for its first I/O operation: determines the buffering mode
+ * and allocates the buffer. Used internally by the stdio implementation.
+ * 
+ * @param stream The stream to prepare.
+ * @return 0 on success or EOF on error.
+ */
+int __stdio_setup(FILE* stream);
+
+/**
+ * Reads from the underlying file descriptor of a stream, waiting for input on
+ * terminals. Used internally by the stdio implementation.
+ * 
+ * @param stream The stream to read from.
+ * @param buffer The buffer to read into.
+ * @param size The maximum number of bytes to read.
+ * @return The number of bytes read, 0 on end of file or EOF on error.
+ */
+int32_t __stdio_read(FILE* stream, char* buffer, size_t size);
+
+/**
+ * Writes all bytes to the underlying file descriptor of a stream. Used
+ * internally by the stdio implementation.
+ * 
+ * @param stream The stream to write to.
+ * @param buffer The bytes to write.
+ * @param size The number of bytes to write.
+ * @return 0 on success or EOF on error.
+ */
+int __stdio_write(FILE* stream, const char* buffer, size_t size);
+
+/**
+ * Links a stream into the list of open streams flushed on exit. Used
+ * internally by the stdio implementation.
+ * 
+ * @param stream The stream to link.
+ */
+void __stdio_link(FILE* stream);
+
+/**
+ * Unlinks a stream from the list of open streams. Used internally by the
+ * stdio implementation.
+ * 
+ * @param stream The stream to unlink.
+ */
+void __stdio_unlink(FILE* stream);
+
+/**
+ * Flushes all open streams. Used internally by the stdio implementation.
+ * 
+ * @return 0 on success or EOF if any stream could not be flushed.
+ */
+int __stdio_flush_all(void);
+
 /**
- * Naive sprintf implementation that writes to a string buffer. This function does not
- * support all the features of the standard sprintf function.
+ * Writes formatted output to a string buffer. Supports the flags '-', '0', '+' and
+ * ' ', field width and precision (also as '*'), the length modifiers hh, h, l, ll
+ * and z and the conversions %c, %s, %d, %i, %u, %o, %x, %X, %b, %p and %f.
+ * Hexadecimal and binary numbers are prefixed with 0x/0b, floating point numbers
+ * are printed with two decimal places by default.
  * 
  * @param str The string buffer to write to.
  * @param format The format string.
  * @param ... The arguments to format.
- * @return The number of characters written or EOF on error.
+ * @return The number of characters written.
  */
 int sprintf(char* str, const char * format, ... );
 
 /**
- * Writes a string to the standard output stream.
+ * Writes formatted output to a string buffer of limited size. At most size - 1
+ * characters are written, followed by a NULL terminator.
+ * 
+ * @param str The string buffer to write to.
+ * @param size The size of the string buffer.
+ * @param format The format string.
+ * @param ... The arguments to format.
+ * @return The length of the complete output, which may exceed the buffer.
+ */
+int snprintf(char* str, size_t size, const char* format, ...);
+
+/**
+ * Writes formatted output to a string buffer of limited size.
+ * 
+ * @param str The string buffer to write to.
+ * @param size The size of the string buffer.
+ * @param format The format string.
+ * @param args The arguments to format.
+ * @return The length of the complete output, which may exceed the buffer.
+ */
+int vsnprintf(char* str, size_t size, const char* format, va_list args);
+
+/**
+ * Writes a string to the standard output stream. In contrast to the standard
+ * puts, no newline is appended.
  * 
  * @param str The string to write.
  * @return The number of characters written or EOF on error.
@@ -46,17 +169,48 @@ int puts(const char* str);
 int putchar(int ch);
 
 /**
- * Writes a formatted string to the standard output stream. This function does not
- * support all the features of the standard printf function.
+ * Writes formatted output to the standard output stream. The output is formatted
+ * in chunks, each written to the stream at once. See sprintf for the supported
+ * conversions.
  *
  * @param format The format string.
  * @param ... The arguments to format.
- * @return The number of characters written or EOF on error.
+ * @return The number of characters written.
  */
 int printf(const char *format, ... );
 
 /**
- * Reads a character from the standard input stream.
+ * Writes formatted output to the standard output stream.
+ *
+ * @param format The format string.
+ * @param args The arguments to format.
+ * @return The number of characters written.
+ */
+int vprintf(const char* format, va_list args);
+
+/**
+ * Writes formatted output to a stream.
+ *
+ * @param stream The stream to write to.
+ * @param format The format string.
+ * @param ... The arguments to format.
+ * @return The number of characters written.
+ */
+int fprintf(FILE* stream, const char* format, ...);
+
+/**
+ * Writes formatted output to a stream.
+ *
+ * @param stream The stream to write to.
+ * @param format The format string.
+ * @param args The arguments to format.
+ * @return The number of characters written.
+ */
+int vfprintf(FILE* stream, const char* format, va_list args);
+
+/**
+ * Reads a character from the standard input stream. Waits for input if the
+ * standard input is a terminal.
  * 
  * @return The read character or EOF on error.
  */
@@ -88,16 +242,110 @@ FILE* fopen(const char * filename, const char* mode);
 int fclose(FILE* stream);
 
 /**
- * Reads data from a file.
+ * Reads data from a file. Small reads are served from the stream's buffer.
  * 
  * @param buffer The buffer to read into.
- * @param size The size of the buffer.
- * @param count The number of bytes to read.
+ * @param size The size of each element.
+ * @param count The number of elements to read.
  * @param stream The file to read from.
- * @return The number of bytes read or EOF on error.
+ * @return The number of elements read.
  */
 size_t fread(void* buffer, size_t size, size_t count, FILE* stream);
 
+/**
+ * Writes data to a file. Small writes are collected in the stream's buffer.
+ * 
+ * @param buffer The data to write.
+ * @param size The size of each element.
+ * @param count The number of elements to write.
+ * @param stream The file to write to.
+ * @return The number of elements written.
+ */
+size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream);
+
+/**
+ * Writes pending buffered output of a stream to its file. Passing NULL flushes
+ * all open streams.
+ * 
+ * @param stream The stream to flush or NULL.
+ * @return 0 on success or EOF on error.
+ */
+int fflush(FILE* stream);
+
+/**
+ * Sets the buffer and buffering mode of a stream. Must be called before any
+ * other operation is performed on the stream.
+ * 
+ * @param stream The stream to configure.
+ * @param buffer The buffer to use or NULL to allocate one.
+ * @param mode The buffering mode (_IOFBF, _IOLBF or _IONBF).
+ * @param size The size of the buffer.
+ * @return 0 on success or a non-zero value on error.
+ */
+int setvbuf(FILE* stream, char* buffer, int mode, size_t size);
+
+/**
+ * Writes a character to a stream.
+ * 
+ * @param ch The character to write.
+ * @param stream The stream to write to.
+ * @return The written character or EOF on error.
+ */
+int fputc(int ch, FILE* stream);
+
+/**
+ * Reads a character from a stream.
+ * 
+ * @param stream The stream to read from.
+ * @return The read character or EOF on end of file or error.
+ */
+int fgetc(FILE* stream);
+
+/**
+ * Reads a line from a stream. Reading stops after a newline, which is stored,
+ * or after size - 1 characters.
+ * 
+ * @param str The string buffer to read into.
+ * @param size The size of the string buffer.
+ * @param stream The stream to read from.
+ * @return The string or NULL if no characters could be read.
+ */
+char* fgets(char* str, int size, FILE* stream);
+
+/**
+ * Moves the position of a stream. Pending output is written and buffered
+ * input is discarded first.
+ * 
+ * @param stream The stream to reposition.
+ * @param offset The offset relative to whence.
+ * @param whence The position to seek from (SEEK_SET, SEEK_CUR or SEEK_END).
+ * @return 0 on success or -1 on error.
+ */
+int fseek(FILE* stream, long offset, int whence);
+
+/**
+ * Checks the end of file indicator of a stream.
+ * 
+ * @param stream The stream to check.
+ * @return Non-zero if the end of file was reached, 0 otherwise.
+ */
+int feof(FILE* stream);
+
+/**
+ * Checks the error indicator of a stream.
+ * 
+ * @param stream The stream to check.
+ * @return Non-zero if an error occurred, 0 otherwise.
+ */
+int ferror(FILE* stream);
+
+/**
+ * Resets the end of file and error indicators of a stream.
+ * 
+ * @param stream The stream to reset.
+ */
+void clearerr(FILE* stream);
+
 #ifdef __cplusplus
 }
 #endif
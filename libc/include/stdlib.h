@@ -77,6 +77,13 @@ void* realloc(void* ptr, size_t size);
  */
 void free(void* ptr);
 
+/**
+ * Flushes all open streams and terminates the calling process.
+ * 
+ * @param status The exit status of the process.
+ */
+void exit(int status) __attribute__((noreturn));
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+void clearerr(FILE* stream) {
+    if(stream == NULL) {
+        return;
+    }
+
+    stream->state &= ~(__FILE_STATE_EOF | __FILE_STATE_ERROR);
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <fsio.h>
 
 int fclose(FILE* stream) {
@@ -6,11 +7,24 @@ int fclose(FILE* stream) {
         return EOF;
     }
 
-    int32_t result = fsio_close(stream->fd);
+    int result = fflush(stream);
 
-    if(result < 0) {
-        return EOF;
+    if(fsio_close(stream->fd) < 0) {
+        result = EOF;
+    }
+
+    // The standard streams are statically allocated
+    if(stream->state & __FILE_STATE_STD) {
+        return result;
     }
 
-    return 0;
+    __stdio_unlink(stream);
+
+    if(stream->state & __FILE_STATE_OWNBUF) {
+        free(stream->buffer);
+    }
+
+    free(stream);
+
+    return result;
 }
@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+int feof(FILE* stream) {
+    if(stream == NULL) {
+        return 0;
+    }
+
+    return (stream->state & __FILE_STATE_EOF) != 0;
+}
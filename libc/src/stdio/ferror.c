@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+int ferror(FILE* stream) {
+    if(stream == NULL) {
+        return 0;
+    }
+
+    return (stream->state & __FILE_STATE_ERROR) != 0;
+}
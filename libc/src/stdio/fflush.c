@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <fsio.h>
+
+int fflush(FILE* stream) {
+    if(stream == NULL) {
+        return __stdio_flush_all();
+    }
+
+    if(stream->state & __FILE_STATE_WRITING) {
+        size_t pending = stream->position;
+
+        stream->position = 0;
+        stream->state &= ~__FILE_STATE_WRITING;
+
+        if(pending > 0 && __stdio_write(stream, stream->buffer, pending) == EOF) {
+            return EOF;
+        }
+
+        return 0;
+    }
+
+    /*
+     * Buffered input of a regular file is dropped and the file offset is moved back
+     * to the first unread byte. Terminal input is kept, it can't be read again.
+     */
+    if((stream->state & __FILE_STATE_READING) && !(stream->state & __FILE_STATE_TTY)) {
+        size_t unread = stream->length - stream->position;
+
+        stream->position = 0;
+        stream->length = 0;
+        stream->state &= ~__FILE_STATE_READING;
+
+        if(unread > 0 && fsio_seek(stream->fd, -((int32_t) unread), FSIO_SEEK_CUR) < 0) {
+            stream->state |= __FILE_STATE_ERROR;
+            return EOF;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include <stdio.h>
+
+int fgetc(FILE* stream) {
+    if(stream == NULL) {
+        return EOF;
+    }
+
+    // Fast path: the next character is already buffered
+    if((stream->state & __FILE_STATE_READING) && stream->position < stream->length) {
+        return (unsigned char) stream->buffer[stream->position++];
+    }
+
+    unsigned char byte;
+
+    if(fread(&byte, 1, 1, stream) != 1) {
+        return EOF;
+    }
+
+    return byte;
+}
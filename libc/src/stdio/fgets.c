@@ -0,0 +1,31 @@
+#include <stdio.h>
+
+char* fgets(char* str, int size, FILE* stream) {
+    if(str == NULL || stream == NULL || size <= 0) {
+        return NULL;
+    }
+
+    int index = 0;
+
+    while(index < size - 1) {
+        int ch = fgetc(stream);
+
+        if(ch == EOF) {
+            break;
+        }
+
+        str[index++] = ch;
+
+        if(ch == '\n') {
+            break;
+        }
+    }
+
+    if(index == 0 && size > 1) {
+        return NULL;
+    }
+
+    str[index] = '\0';
+
+    return str;
+}
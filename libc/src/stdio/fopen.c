@@ -31,11 +31,21 @@ FILE* fopen(const char* filename, const char* mode) {
     FILE* file = malloc(sizeof(FILE));
 
     if(file == NULL) {
+        fsio_close(fd);
         return NULL;
     }
 
+    // The buffer is allocated lazily on the first read or write
     file->fd = fd;
     file->flags = flags;
+    file->state = 0;
+    file->mode = _IOFBF;
+    file->buffer = NULL;
+    file->buffer_size = 0;
+    file->position = 0;
+    file->length = 0;
+
+    __stdio_link(file);
 
     return file;
 }
@@ -0,0 +1,11 @@
+#include <stdio.h>
+
+int fputc(int ch, FILE* stream) {
+    unsigned char byte = (unsigned char) ch;
+
+    if(fwrite(&byte, 1, 1, stream) != 1) {
+        return EOF;
+    }
+
+    return byte;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <fsio.h>
 
 size_t fread(void* buffer, size_t size, size_t count, FILE* stream) {
@@ -6,18 +7,62 @@ size_t fread(void* buffer, size_t size, size_t count, FILE* stream) {
         return 0;
     }
 
+    if(!(stream->flags & FSIO_RDONLY) || __stdio_setup(stream) == EOF) {
+        stream->state |= __FILE_STATE_ERROR;
+        return 0;
+    }
+
+    // Pending output has to be written before switching to reading
+    if((stream->state & __FILE_STATE_WRITING) && fflush(stream) == EOF) {
+        return 0;
+    }
+
+    stream->state |= __FILE_STATE_READING;
+
+    char* data = buffer;
     size_t total_bytes = size * count;
     size_t bytes_read = 0;
 
     while(bytes_read < total_bytes) {
+        size_t available = stream->length - stream->position;
+
+        // Serve the request from the buffered input first
+        if(available > 0) {
+            size_t bytes_to_copy = total_bytes - bytes_read;
+
+            if(bytes_to_copy > available) {
+                bytes_to_copy = available;
+            }
+
+            memcpy(data + bytes_read, stream->buffer + stream->position, bytes_to_copy);
+            stream->position += bytes_to_copy;
+            bytes_read += bytes_to_copy;
+
+            continue;
+        }
+
         size_t bytes_to_read = total_bytes - bytes_read;
-        int32_t result = fsio_read(stream->fd, (char *) buffer + bytes_read, bytes_to_read);
+        int32_t result;
+
+        // Large reads bypass the buffer, small reads refill it
+        if(stream->mode == _IONBF || bytes_to_read >= stream->buffer_size) {
+            result = __stdio_read(stream, data + bytes_read, bytes_to_read);
+
+            if(result > 0) {
+                bytes_read += result;
+            }
+        } else {
+            result = __stdio_read(stream, stream->buffer, stream->buffer_size);
+
+            if(result > 0) {
+                stream->position = 0;
+                stream->length = result;
+            }
+        }
 
         if(result <= 0) {
             break;
         }
-
-        bytes_read += result;
     }
 
     return bytes_read / size;
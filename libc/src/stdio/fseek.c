@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <fsio.h>
+
+int fseek(FILE* stream, long offset, int whence) {
+    if(stream == NULL) {
+        return -1;
+    }
+
+    int32_t fsio_whence;
+
+    switch(whence) {
+        case SEEK_SET: {
+            fsio_whence = FSIO_SEEK_BEGIN;
+            break;
+        }
+        case SEEK_CUR: {
+            fsio_whence = FSIO_SEEK_CUR;
+            break;
+        }
+        case SEEK_END: {
+            fsio_whence = FSIO_SEEK_END;
+            break;
+        }
+        default: {
+            return -1;
+        }
+    }
+
+    // Writes pending output and moves the file offset back to the logical position
+    if(fflush(stream) == EOF) {
+        return -1;
+    }
+
+    if(fsio_seek(stream->fd, offset, fsio_whence) < 0) {
+        return -1;
+    }
+
+    stream->state &= ~__FILE_STATE_EOF;
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+#include <fsio.h>
+
+size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) {
+    if(buffer == NULL || stream == NULL || size == 0 || count == 0) {
+        return 0;
+    }
+
+    if(!(stream->flags & FSIO_WRONLY) || __stdio_setup(stream) == EOF) {
+        stream->state |= __FILE_STATE_ERROR;
+        return 0;
+    }
+
+    // Switching from reading to writing requires the read buffer to be dropped
+    if((stream->state & __FILE_STATE_READING) && fflush(stream) == EOF) {
+        return 0;
+    }
+
+    const char* data = buffer;
+    size_t total_bytes = size * count;
+
+    if(stream->mode == _IONBF) {
+        return __stdio_write(stream, data, total_bytes) == EOF ? 0 : count;
+    }
+
+    stream->state |= __FILE_STATE_WRITING;
+
+    // Writes that don't fit into the buffer bypass it once pending output was written
+    if(total_bytes >= stream->buffer_size) {
+        if(fflush(stream) == EOF || __stdio_write(stream, data, total_bytes) == EOF) {
+            return 0;
+        }
+
+        return count;
+    }
+
+    size_t space = stream->buffer_size - stream->position;
+
+    if(total_bytes > space) {
+        memcpy(stream->buffer + stream->position, data, space);
+        stream->position += space;
+
+        if(fflush(stream) == EOF) {
+            return 0;
+        }
+
+        stream->state |= __FILE_STATE_WRITING;
+
+        memcpy(stream->buffer, data + space, total_bytes - space);
+        stream->position = total_bytes - space;
+    } else {
+        memcpy(stream->buffer + stream->position, data, total_bytes);
+        stream->position += total_bytes;
+    }
+
+    // Line buffered streams are flushed as soon as a line is complete
+    if(stream->mode == _IOLBF) {
+        for(size_t index = 0; index < total_bytes; index++) {
+            if(data[index] == '\n') {
+                if(fflush(stream) == EOF) {
+                    return 0;
+                }
+
+                break;
+            }
+        }
+    }
+
+    return count;
+}
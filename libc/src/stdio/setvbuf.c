@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int setvbuf(FILE* stream, char* buffer, int mode, size_t size) {
+    if(stream == NULL || (mode != _IOFBF && mode != _IOLBF && mode != _IONBF)) {
+        return -1;
+    }
+
+    // The buffer can only be replaced before the first I/O operation
+    if(stream->state & (__FILE_STATE_READING | __FILE_STATE_WRITING)) {
+        return -1;
+    }
+
+    char* allocated = NULL;
+
+    if(mode != _IONBF && buffer == NULL) {
+        if(size == 0) {
+            size = BUFSIZ;
+        }
+
+        allocated = malloc(size);
+
+        if(allocated == NULL) {
+            return -1;
+        }
+
+        buffer = allocated;
+    }
+
+    if(stream->state & __FILE_STATE_OWNBUF) {
+        free(stream->buffer);
+        stream->state &= ~__FILE_STATE_OWNBUF;
+    }
+
+    if(mode == _IONBF) {
+        stream->buffer = NULL;
+        stream->buffer_size = 0;
+    } else {
+        stream->buffer = buffer;
+        stream->buffer_size = size;
+    }
+
+    if(allocated != NULL) {
+        stream->state |= __FILE_STATE_OWNBUF;
+    }
+
+    stream->mode = mode;
+    stream->position = 0;
+    stream->length = 0;
+
+    // An explicit mode takes precedence over the terminal detection of the standard streams
+    stream->state |= __FILE_STATE_MODESET;
+
+    return 0;
+}
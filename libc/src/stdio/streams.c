@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fsio.h>
+#include <sysinfo.h>
+
+static char stdin_buffer[BUFSIZ];
+static char stdout_buffer[BUFSIZ];
+
+/*
+ * The standard streams are linked into the list of open streams from the start.
+ * Their buffering mode is determined on first use, see __stdio_setup.
+ */
+
+static FILE stderr_file = {
+    .fd = FSIO_STDERR,
+    .flags = FSIO_WRONLY,
+    .state = __FILE_STATE_STD,
+    .mode = _IONBF,
+    .buffer = NULL,
+    .buffer_size = 0,
+    .position = 0,
+    .length = 0,
+    .next = NULL
+};
+
+static FILE stdout_file = {
+    .fd = FSIO_STDOUT,
+    .flags = FSIO_WRONLY,
+    .state = __FILE_STATE_STD,
+    .mode = _IOFBF,
+    .buffer = stdout_buffer,
+    .buffer_size = BUFSIZ,
+    .position = 0,
+    .length = 0,
+    .next = &stderr_file
+};
+
+static FILE stdin_file = {
+    .fd = FSIO_STDIN,
+    .flags = FSIO_RDONLY,
+    .state = __FILE_STATE_STD,
+    .mode = _IOFBF,
+    .buffer = stdin_buffer,
+    .buffer_size = BUFSIZ,
+    .position = 0,
+    .length = 0,
+    .next = &stdout_file
+};
+
+FILE* stdin = &stdin_file;
+FILE* stdout = &stdout_file;
+FILE* stderr = &stderr_file;
+
+static FILE* open_streams = &stdin_file;
+
+int __stdio_setup(FILE* stream) {
+    if(stream->state & __FILE_STATE_SETUP) {
+        return 0;
+    }
+
+    /*
+     * The standard streams are line buffered when attached to a terminal and fully
+     * buffered otherwise. The terminal info syscall only succeeds for a terminal.
+     */
+    if(stream->state & __FILE_STATE_STD) {
+        terminfo_t info;
+
+        if(sysinfo_get_terminfo(&info) == 0) {
+            stream->state |= __FILE_STATE_TTY;
+
+            if(stream->mode == _IOFBF && !(stream->state & __FILE_STATE_MODESET)) {
+                stream->mode = _IOLBF;
+            }
+        }
+    }
+
+    if(stream->mode != _IONBF && stream->buffer == NULL) {
+        stream->buffer = malloc(BUFSIZ);
+
+        if(stream->buffer == NULL) {
+            stream->state |= __FILE_STATE_ERROR;
+            return EOF;
+        }
+
+        stream->buffer_size = BUFSIZ;
+        stream->state |= __FILE_STATE_OWNBUF;
+    }
+
+    stream->state |= __FILE_STATE_SETUP;
+
+    return 0;
+}
+
+int32_t __stdio_read(FILE* stream, char* buffer, size_t size) {
+    // Make pending prompts visible before waiting for interactive input
+    if(stream->mode != _IOFBF || (stream->state & __FILE_STATE_TTY)) {
+        fflush(stdout);
+    }
+
+    int32_t result;
+
+    do {
+        result = fsio_read(stream->fd, buffer, size);
+
+        if(result < 0) {
+            stream->state |= __FILE_STATE_ERROR;
+            return EOF;
+        }
+
+        // An empty read from a terminal only means that no input is available yet
+    } while(result == 0 && (stream->state & __FILE_STATE_TTY));
+
+    if(result == 0) {
+        stream->state |= __FILE_STATE_EOF;
+    }
+
+    return result;
+}
+
+int __stdio_write(FILE* stream, const char* buffer, size_t size) {
+    while(size > 0) {
+        int32_t result = fsio_write(stream->fd, buffer, size);
+
+        if(result <= 0) {
+            stream->state |= __FILE_STATE_ERROR;
+            return EOF;
+        }
+
+        buffer += result;
+        size -= result;
+    }
+
+    return 0;
+}
+
+void __stdio_link(FILE* stream) {
+    stream->next = open_streams;
+    open_streams = stream;
+}
+
+void __stdio_unlink(FILE* stream) {
+    FILE** current = &open_streams;
+
+    while(*current != NULL) {
+        if(*current == stream) {
+            *current = stream->next;
+            stream->next = NULL;
+            return;
+        }
+
+        current = &(*current)->next;
+    }
+}
+
+int __stdio_flush_all(void) {
+    int result = 0;
+
+    for(FILE* stream = open_streams; stream != NULL; stream = stream->next) {
+        if((stream->state & __FILE_STATE_WRITING) && fflush(stream) == EOF) {
+            result = EOF;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <format.h>
+
+static void vfprintf_flush(const char* chunk, size_t length, void* context);
+
+int vfprintf(FILE* stream, const char* format, va_list args) {
+    char chunk[PRINTF_CHUNK_SIZE];
+
+    return __vformat(chunk, PRINTF_CHUNK_SIZE, vfprintf_flush, stream, format, args);
+}
+
+static void vfprintf_flush(const char* chunk, size_t length, void* context) {
+    fwrite(chunk, 1, length, (FILE*) context);
+}
@@ -0,0 +1,6 @@
+#include <stdio.h>
+#include <format.h>
+
+int vsnprintf(char* str, size_t size, const char* format, va_list args) {
+    return __vformat(str, size, NULL, NULL, format, args);
+}
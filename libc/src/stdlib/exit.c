@@ -0,0 +1,12 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <proc.h>
+
+void exit(int status) {
+    // Buffered output would be lost otherwise
+    __stdio_flush_all();
+
+    _exit(status);
+
+    while(1);
+}
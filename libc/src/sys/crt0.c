@@ -1,11 +1,12 @@
-#include <proc.h>
+#include <stdlib.h>
 
 extern int main(int argc, char** argv, char** envp);
 
 /*
  * Program entry point. The kernel prepares the initial user stack so that argc sits at the very
  * top, directly followed by the argv pointer array (argv[0] .. argv[argc - 1], NULL). This stub
- * reads them off the stack, calls main, and exits with its return value.
+ * reads them off the stack, calls main, and exits with its return value. Exiting through exit
+ * flushes the buffered stdio streams.
  *
  * It has to be a naked function so the compiler emits no prologue that would shift esp before we
  * can read the layout the kernel set up.
@@ -19,6 +20,6 @@ __attribute__((naked, noreturn)) void _start(void) {
         "push %eax\n"           // argc
         "call main\n"
         "push %eax\n"           // exit status = main's return value
-        "call _exit\n"
+        "call exit\n"
     );
 }
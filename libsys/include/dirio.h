@@ -4,13 +4,33 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#define DIRIO_TYPE_UNKNOWN      0x00
+#define DIRIO_TYPE_FILE         0x01
+#define DIRIO_TYPE_DIRECTORY    0x02
+#define DIRIO_TYPE_SYMLINK      0x03
+
 typedef struct dirent dirent_t;
+typedef struct dirent_record dirent_record_t;
 
 struct dirent {
     char name[256];
     uint32_t inode;
+    uint8_t type;
 };
 
+/**
+ * Variable length directory entry as filled in by dirio_getdents. The records follow each
+ * other in the buffer, each one starting rec_len bytes after the previous one.
+ */
+struct dirent_record {
+    uint32_t inode;
+    uint32_t next;
+    uint16_t rec_len;
+    uint8_t name_len;
+    uint8_t type;
+    char name[];
+} __attribute__((packed));
+
 /**
  * Opens a directory for reading.
  *
@@ -28,6 +48,17 @@ int32_t dirio_open(const char* path);
  */
 int32_t dirio_read(int32_t dd, dirent_t* entry);
 
+/**
+ * Reads as many of the next entries from a directory as fit into a buffer.
+ *
+ * @param dd The directory descriptor to read from.
+ * @param buffer The buffer to fill with dirent_record_t records.
+ * @param size The size of the buffer.
+ * @return The number of bytes filled, 0 when there are no more entries or -1 on error or if the
+ *         buffer is too small for the next entry.
+ */
+int32_t dirio_getdents(int32_t dd, void* buffer, size_t size);
+
 /**
  * Closes a directory descriptor.
  *
@@ -15,6 +15,10 @@
 #define FSIO_TRUNC     0b00001000
 #define FSIO_APPEND    0x00010000
 
+#define FSIO_SEEK_CUR   0
+#define FSIO_SEEK_BEGIN 1
+#define FSIO_SEEK_END   2
+
 /**
  * Reads from a file descriptor.
  * 
@@ -53,4 +57,21 @@ int32_t fsio_open(const char* path, int32_t flags, int32_t mode);
  */
 int32_t fsio_close(int32_t fd);
 
+/**
+ * Moves the offset of a file descriptor.
+ * 
+ * @param fd The file descriptor to seek in.
+ * @param offset The offset relative to whence.
+ * @param whence The position to seek from (FSIO_SEEK_*).
+ * @return The new offset or -1 on error.
+ */
+int32_t fsio_seek(int32_t fd, int32_t offset, int32_t whence);
+
+/**
+ * Writes back all pending changes of all mounted file systems.
+ * 
+ * @return 0 on success or -1 on error.
+ */
+int32_t fsio_sync(void);
+
 #endif // _LIBSYS_FSIO_H
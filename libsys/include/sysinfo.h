@@ -13,6 +13,32 @@ struct osinfo {
     char platform[16];
 };
 
+#define CPUINFO_FEATURE_FPU (1 << 0)
+#define CPUINFO_FEATURE_PSE (1 << 1)
+#define CPUINFO_FEATURE_TSC (1 << 2)
+#define CPUINFO_FEATURE_PAE (1 << 3)
+#define CPUINFO_FEATURE_APIC (1 << 4)
+#define CPUINFO_FEATURE_SEP (1 << 5)
+#define CPUINFO_FEATURE_PGE (1 << 6)
+#define CPUINFO_FEATURE_CMOV (1 << 7)
+#define CPUINFO_FEATURE_MMX (1 << 8)
+#define CPUINFO_FEATURE_FXSR (1 << 9)
+#define CPUINFO_FEATURE_SSE (1 << 10)
+#define CPUINFO_FEATURE_SSE2 (1 << 11)
+#define CPUINFO_FEATURE_SSE3 (1 << 12)
+#define CPUINFO_FEATURE_ERMS (1 << 13)
+
+typedef struct cpuinfo cpuinfo_t;
+
+struct cpuinfo {
+    char vendor[16];
+    char brand[48];
+    uint32_t family;
+    uint32_t model;
+    uint32_t stepping;
+    uint32_t features;
+};
+
 typedef struct meminfo meminfo_t;
 
 struct meminfo {
@@ -20,6 +46,21 @@ struct meminfo {
     size_t free;
 };
 
+#define TERMINFO_MODE_RAW 0x00
+#define TERMINFO_MODE_CANONICAL 0x01
+#define TERMINFO_MODE_ECHO 0x02
+
+typedef struct cacheinfo cacheinfo_t;
+
+struct cacheinfo {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t blocks;
+    uint32_t dirty;
+    uint32_t block_size;
+    uint32_t budget;
+};
+
 typedef struct terminfo terminfo_t;
 
 struct terminfo {
@@ -51,6 +92,14 @@ int32_t sysinfo_get_meminfo(meminfo_t* info);
  */
 int32_t sysinfo_get_kheapinfo(meminfo_t* info);
 
+/**
+ * Gets block cache information.
+ *
+ * @param info The hit and miss counters and the usage of the volume block cache.
+ * @return 0 on success, -1 on error.
+ */
+int32_t sysinfo_get_cacheinfo(cacheinfo_t* info);
+
 /**
  * Gets terminal information (dimensions of the controlling terminal).
  *
@@ -59,6 +108,23 @@ int32_t sysinfo_get_kheapinfo(meminfo_t* info);
  */
 int32_t sysinfo_get_terminfo(terminfo_t* info);
 
+/**
+ * Sets the line discipline mode of the controlling terminal. In canonical mode reads
+ * return whole lines edited by the kernel, in raw mode every key is returned as typed.
+ *
+ * @param mode The mode (TERMINFO_MODE_* mask).
+ * @return 0 on success, -1 on error.
+ */
+int32_t sysinfo_set_termmode(uint32_t mode);
+
+/**
+ * Gets CPU information (identification and CPUINFO_FEATURE_* mask).
+ *
+ * @param info The CPU information.
+ * @return 0 on success, -1 on error.
+ */
+int32_t sysinfo_get_cpuinfo(cpuinfo_t* info);
+
 /**
  * Gets the system uptime in seconds.
  *
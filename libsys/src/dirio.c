@@ -48,3 +48,21 @@ int32_t dirio_close(int32_t dd) {
 
     return return_value;
 }
+
+int32_t dirio_getdents(int32_t dd, void* buffer, size_t size) {
+    int32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov %1, %%ebx\n"
+        "mov %2, %%ecx\n"
+        "mov %3, %%edx\n"
+        "mov $0x1C, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        : "g"(dd), "g"(buffer), "g"(size)
+        : "%eax", "%ebx", "%ecx", "%edx"
+    );
+
+    return return_value;
+}
@@ -69,3 +69,36 @@ int32_t fsio_close(int32_t fd) {
 
     return return_value;
 }
+
+int32_t fsio_seek(int32_t fd, int32_t offset, int32_t whence) {
+    int32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov %1, %%ebx\n"
+        "mov %2, %%ecx\n"
+        "mov %3, %%edx\n"
+        "mov $0x07, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        : "g"(fd), "g"(offset), "g"(whence)
+        : "%eax", "%ebx", "%ecx", "%edx"
+    );
+
+    return return_value;
+}
+
+int32_t fsio_sync(void) {
+    int32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov $0x1B, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        :
+        : "%eax"
+    );
+
+    return return_value;
+}
@@ -60,6 +60,26 @@ int32_t sysinfo_get_kheapinfo(meminfo_t* info) {
     return return_value;
 }
 
+int32_t sysinfo_get_cacheinfo(cacheinfo_t* info) {
+    uint32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov %1, %%ebx\n"
+        "mov $0x09, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        : "r"(info)
+        : "%eax", "%ebx"
+    );
+
+    if(return_value < 0) {
+        return -1;
+    }
+
+    return return_value;
+}
+
 uint32_t sysinfo_get_uptime(void) {
     uint32_t return_value = 0;
 
@@ -94,3 +114,43 @@ int32_t sysinfo_get_terminfo(terminfo_t* info) {
 
     return return_value;
 }
+
+int32_t sysinfo_set_termmode(uint32_t mode) {
+    uint32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov %1, %%ebx\n"
+        "mov $0x08, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        : "r"(mode)
+        : "%eax", "%ebx"
+    );
+
+    if(return_value < 0) {
+        return -1;
+    }
+
+    return return_value;
+}
+
+int32_t sysinfo_get_cpuinfo(cpuinfo_t* info) {
+    uint32_t return_value = 0;
+
+    __asm__ volatile(
+        "mov %1, %%ebx\n"
+        "mov $0x1A, %%eax\n"
+        "int $0x80\n"
+        "mov %%eax, %0\n"
+        : "=r"(return_value)
+        : "r"(info)
+        : "%eax", "%ebx"
+    );
+
+    if(return_value < 0) {
+        return -1;
+    }
+
+    return return_value;
+}
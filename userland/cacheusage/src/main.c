@@ -0,0 +1,22 @@
+#include <sysinfo.h>
+#include <stdio.h>
+
+int main(void) {
+    cacheinfo_t cacheinfo;
+
+    if (sysinfo_get_cacheinfo(&cacheinfo) < 0) {
+        puts("cacheusage: failed to get block cache information\n");
+        return 1;
+    }
+
+    uint32_t lookups = cacheinfo.hits + cacheinfo.misses;
+    double hit_percentage = lookups > 0 ? ((double) cacheinfo.hits / lookups) * 100 : 0;
+
+    double used_kb = (double) cacheinfo.blocks * cacheinfo.block_size / 1024;
+    double budget_kb = (double) cacheinfo.budget / 1024;
+
+    printf("%d hits, %d misses (%f%% hit rate)\n", cacheinfo.hits, cacheinfo.misses, hit_percentage);
+    printf("%f KB / %f KB used by %d blocks (%d dirty)\n", used_kb, budget_kb, cacheinfo.blocks, cacheinfo.dirty);
+
+    return 0;
+}
@@ -14,11 +14,24 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    dirent_t entry;
+    // Entries are fetched in batches, a buffer of this size holds a few dozen of them
+    uint32_t buffer[128];
+    int32_t length;
 
-    while (dirio_read(dd, &entry) == 0) {
-        puts(entry.name);
-        putchar('\n');
+    while ((length = dirio_getdents(dd, buffer, sizeof(buffer))) > 0) {
+        for (int32_t offset = 0; offset < length;) {
+            dirent_record_t* entry = (dirent_record_t*) ((uint8_t*) buffer + offset);
+
+            puts(entry->name);
+
+            if (entry->type == DIRIO_TYPE_DIRECTORY) {
+                putchar('/');
+            }
+
+            putchar('\n');
+
+            offset += entry->rec_len;
+        }
     }
 
     dirio_close(dd);
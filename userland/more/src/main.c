@@ -58,6 +58,8 @@ int main(int argc, char** argv) {
                 // Wait for a key: 'q' quits, 'n' or Enter shows the next page.
                 int c;
 
+                sysinfo_set_termmode(TERMINFO_MODE_RAW);
+
                 do {
                     c = getchar();
 
@@ -66,6 +68,8 @@ int main(int argc, char** argv) {
                     }
                 } while (!quit && c != 'n' && c != '\n');
 
+                sysinfo_set_termmode(TERMINFO_MODE_CANONICAL | TERMINFO_MODE_ECHO);
+
                 // Erase the prompt character.
                 putchar('\b');
                 putchar(' ');
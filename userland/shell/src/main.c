@@ -2,6 +2,7 @@
 #include <string.h>
 #include <fsio.h>
 #include <proc.h>
+#include <sysinfo.h>
 
 #define SHELL_LINE_MAX 256
 #define SHELL_MAX_ARGS 32
@@ -263,6 +264,8 @@ static void shell_redraw(const char* prompt, const char* buffer, size_t length,
  * Reads a line of input with echo, in-line editing and history recall. Handles
  * Enter, Backspace, up/down (history) and left/right (cursor movement, with
  * mid-line insertion and deletion). Assumes the input stays on a single row.
+ * The terminal is switched to raw mode while editing, since the kernel's line
+ * discipline has no history, and back to canonical mode for the commands run.
  */
 static void shell_read_line(const char* prompt, char* buffer, size_t size) {
     size_t length = 0;
@@ -272,6 +275,8 @@ static void shell_read_line(const char* prompt, char* buffer, size_t size) {
     buffer[0] = '\0';
     printf("%s", prompt);
 
+    sysinfo_set_termmode(TERMINFO_MODE_RAW);
+
     for(;;) {
         int ch = getchar();
 
@@ -372,6 +377,8 @@ static void shell_read_line(const char* prompt, char* buffer, size_t size) {
 
     buffer[length] = '\0';
 
+    sysinfo_set_termmode(TERMINFO_MODE_CANONICAL | TERMINFO_MODE_ECHO);
+
     shell_history_add(buffer);
 }
 
@@ -0,0 +1,11 @@
+#include <fsio.h>
+#include <stdio.h>
+
+int main(void) {
+    if (fsio_sync() < 0) {
+        puts("sync: failed to sync file systems\n");
+        return 1;
+    }
+
+    return 0;
+}